@@ -0,0 +1,91 @@
+#ifndef CANCELLATION_TOKEN_H
+#define CANCELLATION_TOKEN_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace idverify {
+
+/**
+ * Outcome of a cancellable call
+ */
+enum class ProcessStatus : int {
+    OK = 0,
+    CANCELLED = 1,           // cancel() was called while the call ran
+    DEADLINE_EXCEEDED = 2    // The per-call deadline passed
+};
+
+/**
+ * CancellationToken - Cooperative cancellation with an optional deadline
+ *
+ * Long stages poll the token between tiles, strips or contours and return
+ * early with a partial result. cancel() may be called from any thread (UI
+ * leaving the screen, newer frame arrived); the deadline is armed by the
+ * thread that runs the work. Polling costs one relaxed load and, with a
+ * deadline set, one steady_clock read.
+ */
+class CancellationToken {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    CancellationToken() : cancelled_(false), deadlineNs_(NO_DEADLINE) {}
+
+    /**
+     * Request cancellation (thread-safe)
+     */
+    void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+
+    /**
+     * Stop after a fixed time from now
+     * @param ms Milliseconds from now (<= 0 clears the deadline)
+     */
+    void setDeadlineAfterMs(float ms) {
+        if (ms <= 0.0f) {
+            deadlineNs_.store(NO_DEADLINE, std::memory_order_relaxed);
+            return;
+        }
+        auto deadline = Clock::now() + std::chrono::microseconds(static_cast<int64_t>(ms * 1000.0f));
+        deadlineNs_.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                deadline.time_since_epoch()).count(), std::memory_order_relaxed);
+    }
+
+    /**
+     * Clear cancellation and deadline before reusing the token for a new call
+     */
+    void reset() {
+        cancelled_.store(false, std::memory_order_relaxed);
+        deadlineNs_.store(NO_DEADLINE, std::memory_order_relaxed);
+    }
+
+    /**
+     * Current status (OK while the work may continue)
+     */
+    ProcessStatus status() const {
+        if (cancelled_.load(std::memory_order_relaxed)) return ProcessStatus::CANCELLED;
+        int64_t deadline = deadlineNs_.load(std::memory_order_relaxed);
+        if (deadline != NO_DEADLINE &&
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    Clock::now().time_since_epoch()).count() >= deadline) {
+            return ProcessStatus::DEADLINE_EXCEEDED;
+        }
+        return ProcessStatus::OK;
+    }
+
+    /**
+     * Status of an optional token (nullptr never stops)
+     */
+    static ProcessStatus statusOf(const CancellationToken* token) {
+        return token != nullptr ? token->status() : ProcessStatus::OK;
+    }
+
+private:
+    static constexpr int64_t NO_DEADLINE = INT64_MAX;
+
+    std::atomic<bool> cancelled_;
+    std::atomic<int64_t> deadlineNs_;
+};
+
+} // namespace idverify
+
+#endif // CANCELLATION_TOKEN_H
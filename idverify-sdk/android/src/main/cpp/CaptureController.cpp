@@ -0,0 +1,137 @@
+#include "CaptureController.h"
+#include <android/log.h>
+
+#define TAG "CaptureController"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
+
+namespace idverify {
+
+CaptureController::CaptureController(const CaptureConfig& config)
+    : config_(config) {
+    reset();
+}
+
+void CaptureController::reset() {
+    state_ = CaptureState::SEARCHING;
+    lostCount_ = 0;
+    dwellFrames_ = 0;
+    dwellStartMs_ = 0.0;
+}
+
+CaptureMetrics CaptureController::fromCascade(const CascadeResult& result, float textScore) {
+    CaptureMetrics m;
+    m.detectionRan = result.passed ||
+                     result.stageMs[static_cast<int>(CascadeStage::DETECTION)] > 0.0f;
+    m.cardDetected = result.corners.detected;
+    m.confidence = result.corners.detected ? result.corners.confidence : 0.0f;
+    m.passed = result.passed;
+    m.rejectedAt = result.rejectedAt;
+    m.textScore = result.passed ? textScore : 0.0f;
+    m.motionValid = result.motion.valid;
+    m.motionPx = result.motion.motionPx;
+    m.memoHit = false;
+    return m;
+}
+
+CaptureEvent CaptureController::update(const CaptureMetrics& m, double timestampMs) {
+    CaptureEvent event;
+    event.previous = state_;
+    event.hint = CaptureHint::NONE;
+
+    if (state_ == CaptureState::CAPTURED) {
+        event.state = state_;
+        event.changed = false;
+        return event;
+    }
+
+    const bool holding = (state_ == CaptureState::HOLD_STILL);
+    const bool tracking = (state_ != CaptureState::SEARCHING);
+
+    // Looser thresholds to stay in a state than to enter it
+    const float minConfidence = tracking ? config_.exitConfidence : config_.enterConfidence;
+    const float minScore = holding ? config_.exitROIScore : config_.enterROIScore;
+    const float maxMotion = holding ? config_.exitMotionPx : config_.enterMotionPx;
+
+    const bool cardSeen = m.cardDetected && m.confidence >= minConfidence;
+    const bool good = m.passed && m.textScore >= minScore;
+    const bool still = !m.motionValid || m.motionPx <= maxMotion;
+
+    // Frames rejected before detection say nothing about the card
+    if (m.detectionRan || m.rejectedAt == CascadeStage::PRESENCE) {
+        lostCount_ = cardSeen ? 0 : lostCount_ + 1;
+    }
+
+    switch (state_) {
+        case CaptureState::SEARCHING:
+            if (cardSeen) {
+                state_ = CaptureState::ALIGNING;
+            }
+            break;
+
+        case CaptureState::ALIGNING:
+            if (lostCount_ >= config_.lostFrames) {
+                state_ = CaptureState::SEARCHING;
+            } else if (good && still) {
+                state_ = CaptureState::HOLD_STILL;
+                dwellStartMs_ = timestampMs;
+                dwellFrames_ = m.memoHit ? 0 : 1;
+            }
+            break;
+
+        case CaptureState::HOLD_STILL:
+            if (lostCount_ >= config_.lostFrames) {
+                state_ = CaptureState::SEARCHING;
+            } else if (!good || !still) {
+                state_ = CaptureState::ALIGNING;
+            } else {
+                // A memo hit repeats an earlier frame: it keeps the dwell time running but adds no frame to choose from
+                if (!m.memoHit) dwellFrames_++;
+                if (timestampMs - dwellStartMs_ >= config_.dwellMs &&
+                    dwellFrames_ >= config_.minDwellFrames) {
+                    state_ = CaptureState::CAPTURED;
+                }
+            }
+            break;
+
+        case CaptureState::CAPTURED:
+            break;
+    }
+
+    event.state = state_;
+    event.changed = (state_ != event.previous);
+    if (state_ != CaptureState::CAPTURED) {
+        event.hint = hintFor(m, cardSeen, good, still);
+    }
+
+    if (event.changed) {
+        LOGD("update: %d -> %d (hint %d)", static_cast<int>(event.previous),
+             static_cast<int>(state_), static_cast<int>(event.hint));
+    }
+    return event;
+}
+
+CaptureHint CaptureController::hintFor(const CaptureMetrics& m, bool cardSeen, bool good,
+                                       bool still) const {
+    if (!m.passed) {
+        switch (m.rejectedAt) {
+            case CascadeStage::PRESENCE:
+                return CaptureHint::FIND_CARD;
+            case CascadeStage::QUALITY:
+                return (m.motionValid && m.motionPx > config_.exitMotionPx)
+                       ? CaptureHint::HOLD_STEADY : CaptureHint::FOCUS;
+            case CascadeStage::DETECTION:
+                return m.cardDetected ? CaptureHint::MOVE_CLOSER : CaptureHint::FIND_CARD;
+            case CascadeStage::WARP:
+                return CaptureHint::REDUCE_GLARE;
+            case CascadeStage::ROI:
+                return CaptureHint::FOCUS;
+        }
+    }
+    if (!cardSeen) return CaptureHint::MOVE_CLOSER;
+    if (!still) return CaptureHint::HOLD_STEADY;
+    if (!good) return CaptureHint::FOCUS;
+    return CaptureHint::NONE;
+}
+
+} // namespace idverify
@@ -0,0 +1,118 @@
+#ifndef CAPTURE_CONTROLLER_H
+#define CAPTURE_CONTROLLER_H
+
+#include <cstdint>
+#include "FrameCascade.h"
+
+namespace idverify {
+
+/**
+ * Auto-capture states
+ */
+enum class CaptureState : int {
+    SEARCHING = 0,    // No card in view
+    ALIGNING = 1,     // Card seen, quality or framing not good enough yet
+    HOLD_STILL = 2,   // Good frames; waiting out the dwell time
+    CAPTURED = 3      // Best frame chosen; stays until reset
+};
+
+/**
+ * What the user should do next (UI guidance)
+ */
+enum class CaptureHint : int {
+    NONE = 0,
+    FIND_CARD = 1,       // Nothing card-like in view / exposure off
+    MOVE_CLOSER = 2,     // Card detected but small or uncertain
+    REDUCE_GLARE = 3,    // Glare on text fields
+    HOLD_STEADY = 4,     // Too much motion
+    FOCUS = 5            // Blurred frame or text ROIs too weak
+};
+
+/**
+ * Capture thresholds (enter > exit gives hysteresis)
+ */
+struct CaptureConfig {
+    float enterConfidence = 0.25f;   // Card confidence to leave SEARCHING
+    float exitConfidence = 0.15f;    // Below this the frame counts as "card lost"
+    float enterROIScore = 0.35f;     // Worst text-ROI score to enter HOLD_STILL
+    float exitROIScore = 0.25f;      // Below this HOLD_STILL falls back to ALIGNING
+    float enterMotionPx = 4.0f;      // Max motion to enter HOLD_STILL
+    float exitMotionPx = 8.0f;       // Max motion to stay in HOLD_STILL
+    int lostFrames = 5;              // Consecutive card-lost frames before SEARCHING
+    float dwellMs = 400.0f;          // Time in HOLD_STILL before CAPTURED
+    int minDwellFrames = 3;          // Good frames buffered before CAPTURED (memo hits not counted)
+};
+
+/**
+ * Per-frame input, distilled from the cascade
+ */
+struct CaptureMetrics {
+    bool detectionRan;       // DETECTION stage evaluated this frame
+    bool cardDetected;
+    float confidence;        // Card confidence (valid if cardDetected)
+    bool passed;             // Whole cascade passed (frame is in the ring)
+    CascadeStage rejectedAt; // Valid if !passed
+    float textScore;         // Worst text-ROI score (valid if passed)
+    bool motionValid;
+    float motionPx;
+    bool memoHit;            // Result reused from the frame-hash memo (no new frame buffered)
+};
+
+/**
+ * Result of one controller step
+ */
+struct CaptureEvent {
+    CaptureState state;
+    CaptureState previous;
+    bool changed;            // state != previous
+    CaptureHint hint;
+};
+
+/**
+ * CaptureController - Auto-capture decision with hysteresis and dwell time
+ *
+ * Consumes cascade metrics per frame and moves through
+ * SEARCHING -> ALIGNING -> HOLD_STILL -> CAPTURED. Entering a state uses
+ * stricter thresholds than staying in it, a card must be missing for
+ * several frames before the controller gives up, and HOLD_STILL must last
+ * dwellMs before capture, so single noisy frames neither trigger nor break
+ * a capture. Timestamps are passed in so recorded sequences replay
+ * deterministically.
+ */
+class CaptureController {
+public:
+    explicit CaptureController(const CaptureConfig& config = CaptureConfig());
+
+    /**
+     * Advance with one processed frame
+     * @param metrics Frame metrics
+     * @param timestampMs Monotonic frame time
+     * @return CaptureEvent
+     */
+    CaptureEvent update(const CaptureMetrics& metrics, double timestampMs);
+
+    /**
+     * Metrics of a cascade result
+     * @param result Cascade output
+     * @param textScore Worst text-ROI score of the frame (if it passed)
+     */
+    static CaptureMetrics fromCascade(const CascadeResult& result, float textScore);
+
+    void configure(const CaptureConfig& config) { config_ = config; }
+    const CaptureConfig& config() const { return config_; }
+    CaptureState state() const { return state_; }
+    void reset();
+
+private:
+    CaptureHint hintFor(const CaptureMetrics& m, bool cardSeen, bool good, bool still) const;
+
+    CaptureConfig config_;
+    CaptureState state_;
+    int lostCount_;          // Consecutive frames without a card
+    int dwellFrames_;        // Good buffered frames since entering HOLD_STILL
+    double dwellStartMs_;
+};
+
+} // namespace idverify
+
+#endif // CAPTURE_CONTROLLER_H
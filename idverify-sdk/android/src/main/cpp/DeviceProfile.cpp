@@ -0,0 +1,336 @@
+#include "DeviceProfile.h"
+#include "Metrics.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <android/log.h>
+
+#define TAG "DeviceProfile"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
+
+using namespace cv;
+using namespace std;
+
+namespace idverify {
+
+namespace {
+
+using Clock = chrono::steady_clock;
+
+// Repetitions per measurement (median is kept)
+constexpr int REPEATS = 3;
+
+/**
+ * On-disk profile record (all fields 4 bytes, no padding)
+ */
+struct ProfileRecord {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t cpuCount;
+    int32_t detectionPyramidLevel;
+    int32_t denoise;
+    int32_t warpInterpolation;
+    int32_t threads;
+    float budgetMs;
+    float estimatedFrameMs;
+    uint32_t checksum;    // FNV-1a of the preceding bytes
+};
+static_assert(sizeof(ProfileRecord) == 40, "ProfileRecord must be packed");
+
+uint32_t fnv1a(const void* data, size_t size) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= p[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Median wall time of fn over REPEATS runs (after one warm-up run)
+ */
+template <typename Fn>
+float medianMs(Fn&& fn) {
+    fn();
+    array<float, REPEATS> samples;
+    for (int i = 0; i < REPEATS; ++i) {
+        Clock::time_point start = Clock::now();
+        fn();
+        samples[i] = chrono::duration<float, milli>(Clock::now() - start).count();
+    }
+    sort(samples.begin(), samples.end());
+    return samples[REPEATS / 2];
+}
+
+/**
+ * Largest distance between detected and ground-truth corners
+ */
+float cornerError(const vector<Point>& detected, const vector<Point>& truth) {
+    if (detected.size() != 4 || truth.size() != 4) return 1e9f;
+    vector<Point2f> d = VisionProcessor::orderCorners(detected);
+    vector<Point2f> t = VisionProcessor::orderCorners(truth);
+    float worst = 0.0f;
+    for (int i = 0; i < 4; ++i) {
+        worst = max(worst, static_cast<float>(norm(d[i] - t[i])));
+    }
+    return worst;
+}
+
+}
+
+// ==================== Synthetic Frames ====================
+
+Mat DeviceCalibrator::syntheticFrame(int index, vector<Point>& corners) {
+    RNG rng(0x1D5EED + index);
+    const bool backSide = (index % 2) == 1;
+
+    // Card face: light background, photo block, text lines (MRZ on the back)
+    Mat card(TARGET_HEIGHT, TARGET_WIDTH, CV_8UC3, Scalar(228, 232, 236));
+    if (backSide) {
+        for (int line = 0; line < 3; ++line) {
+            putText(card, "I<TURA12B345678<<<<<<<<<<<<<<<", Point(24, 430 + line * 40),
+                    FONT_HERSHEY_PLAIN, 2.2, Scalar(30, 30, 30), 2, LINE_AA);
+        }
+        for (int line = 0; line < 5; ++line) {
+            putText(card, "ADDRESS LINE DATA 1234", Point(40, 80 + line * 55),
+                    FONT_HERSHEY_SIMPLEX, 1.0, Scalar(50, 50, 60), 2, LINE_AA);
+        }
+    } else {
+        rectangle(card, Rect(32, 120, 230, 300), Scalar(120, 110, 100), FILLED);
+        for (int line = 0; line < 6; ++line) {
+            putText(card, line % 2 == 0 ? "SOYADI / SURNAME" : "YILMAZ AHMET 12345678901",
+                    Point(300, 110 + line * 60), FONT_HERSHEY_SIMPLEX, line % 2 == 0 ? 0.7 : 1.1,
+                    Scalar(40, 40, 50), 2, LINE_AA);
+        }
+    }
+
+    // Textured background (desk), different brightness per frame
+    Mat frame(FRAME_HEIGHT, FRAME_WIDTH, CV_8UC3);
+    rng.fill(frame, RNG::NORMAL, Scalar::all(70 + 25 * index), Scalar::all(18));
+    GaussianBlur(frame, frame, Size(5, 5), 0);
+
+    // Card quad: ~60% of frame width, perspective jitter per frame
+    const float cx = FRAME_WIDTH * 0.5f;
+    const float cy = FRAME_HEIGHT * 0.5f;
+    const float hw = FRAME_WIDTH * 0.30f;
+    const float hh = hw * TARGET_HEIGHT / TARGET_WIDTH;
+    vector<Point2f> dst = {
+        Point2f(cx - hw + rng.uniform(-30.f, 30.f), cy - hh + rng.uniform(-20.f, 20.f)),
+        Point2f(cx + hw + rng.uniform(-30.f, 30.f), cy - hh + rng.uniform(-20.f, 20.f)),
+        Point2f(cx + hw + rng.uniform(-30.f, 30.f), cy + hh + rng.uniform(-20.f, 20.f)),
+        Point2f(cx - hw + rng.uniform(-30.f, 30.f), cy + hh + rng.uniform(-20.f, 20.f))
+    };
+    vector<Point2f> src = {
+        Point2f(0, 0), Point2f(TARGET_WIDTH - 1, 0),
+        Point2f(TARGET_WIDTH - 1, TARGET_HEIGHT - 1), Point2f(0, TARGET_HEIGHT - 1)
+    };
+    Mat H = getPerspectiveTransform(src, dst);
+    warpPerspective(card, frame, H, frame.size(), INTER_LINEAR, BORDER_TRANSPARENT);
+
+    corners.clear();
+    for (const Point2f& p : dst) {
+        corners.push_back(Point(cvRound(p.x), cvRound(p.y)));
+    }
+    return frame;
+}
+
+// ==================== Calibration ====================
+
+DeviceProfile DeviceCalibrator::calibrate(float budgetMs, CalibrationTimings* timings) {
+    // Calibration frames are not session frames: keep this thread out of Metrics and Trace
+    InstrumentationPause pause;
+    DeviceProfile profile;
+    profile.threads = 0;
+    profile.budgetMs = budgetMs;
+    profile.estimatedFrameMs = 0.0f;
+    profile.cpuCount = getNumberOfCPUs();
+    profile.valid = false;
+
+    CalibrationTimings t;
+
+    vector<Mat> frames(SYNTHETIC_FRAMES);
+    vector<vector<Point>> truth(SYNTHETIC_FRAMES);
+    for (int i = 0; i < SYNTHETIC_FRAMES; ++i) {
+        frames[i] = syntheticFrame(i, truth[i]);
+    }
+
+    // Step 1: Thread count on the full default pipeline
+    for (int n : {1, 2, 4, profile.cpuCount}) {
+        if (n > profile.cpuCount ||
+            find(t.threadCounts.begin(), t.threadCounts.end(), n) != t.threadCounts.end()) {
+            continue;
+        }
+        setNumThreads(n);
+        t.threadCounts.push_back(n);
+        t.threadFrameMs.push_back(medianMs([&] { VisionProcessor::processForOCR(frames[0]); }));
+    }
+    // Fewer threads win unless more threads are at least 5% faster
+    size_t bestThread = 0;
+    for (size_t i = 1; i < t.threadCounts.size(); ++i) {
+        if (t.threadFrameMs[i] < t.threadFrameMs[bestThread] * 0.95f) bestThread = i;
+    }
+    profile.threads = t.threadCounts.empty() ? 0 : t.threadCounts[bestThread];
+    setNumThreads(profile.threads);
+    const float fullFrameMs = t.threadCounts.empty() ? 0.0f : t.threadFrameMs[bestThread];
+
+    // Step 2: Detection per pyramid level, with accuracy check
+    for (int level = 0; level < 3; ++level) {
+        t.detectionOk[level] = true;
+        float total = 0.0f;
+        for (int i = 0; i < SYNTHETIC_FRAMES; ++i) {
+            CornerResult r;
+            total += medianMs([&] { r = VisionProcessor::findCardCorners(frames[i], level); });
+            if (!r.detected || cornerError(r.corners, truth[i]) > CORNER_TOLERANCE_PX * (1 << level)) {
+                t.detectionOk[level] = false;
+            }
+        }
+        t.detectionMs[level] = total / SYNTHETIC_FRAMES;
+    }
+
+    if (!t.detectionOk[0]) {
+        LOGE("calibrate: Synthetic cards not detected at full resolution");
+        if (timings != nullptr) *timings = t;
+        return profile;
+    }
+
+    // Step 3: Warp interpolation
+    t.warpCubicMs = medianMs([&] { VisionProcessor::warpToID1(frames[0], truth[0], INTER_CUBIC); });
+    t.warpLinearMs = medianMs([&] { VisionProcessor::warpToID1(frames[0], truth[0], INTER_LINEAR); });
+
+    // Step 4: Denoise tiers (binarization + MRZ band, as in processForOCR)
+    Mat warped = VisionProcessor::warpToID1(frames[1], truth[1], INTER_CUBIC);
+    for (int tier = 0; tier < 3; ++tier) {
+        DenoiseTier d = static_cast<DenoiseTier>(tier);
+        t.denoiseMs[tier] = medianMs([&] {
+            VisionProcessor::binarizeForOCR(warped, d);
+            VisionProcessor::extractMRZRegion(warped, d);
+        });
+    }
+
+    // Step 5: Richest settings whose estimate fits the budget with headroom
+    const float restMs = max(0.0f, fullFrameMs - t.detectionMs[0] - t.warpCubicMs -
+                                       t.denoiseMs[static_cast<int>(DenoiseTier::NLM)]);
+    PipelineSettings s;
+    auto estimate = [&]() {
+        return t.detectionMs[s.detectionPyramidLevel] +
+               (s.warpInterpolation == INTER_CUBIC ? t.warpCubicMs : t.warpLinearMs) +
+               t.denoiseMs[static_cast<int>(s.denoise)] + restMs;
+    };
+    const float target = budgetMs * HEADROOM;
+
+    if (estimate() > target && t.detectionOk[1]) s.detectionPyramidLevel = 1;
+    if (estimate() > target) s.denoise = DenoiseTier::GAUSSIAN;
+    if (estimate() > target && t.detectionOk[2]) s.detectionPyramidLevel = 2;
+    if (estimate() > target) s.denoise = DenoiseTier::NONE;
+    if (estimate() > target) s.warpInterpolation = INTER_LINEAR;
+
+    profile.settings = s;
+    profile.estimatedFrameMs = estimate();
+    profile.valid = true;
+
+    LOGD("calibrate: threads=%d, level=%d, denoise=%d, interp=%d, est=%.1fms (full=%.1fms)",
+         profile.threads, s.detectionPyramidLevel, static_cast<int>(s.denoise),
+         s.warpInterpolation, profile.estimatedFrameMs, fullFrameMs);
+
+    if (timings != nullptr) *timings = t;
+    return profile;
+}
+
+// ==================== Persistence ====================
+
+bool DeviceCalibrator::save(const DeviceProfile& profile, const string& path) {
+    if (!profile.valid) return false;
+
+    ProfileRecord record;
+    record.magic = PROFILE_MAGIC;
+    record.version = PROFILE_VERSION;
+    record.cpuCount = static_cast<uint32_t>(profile.cpuCount);
+    record.detectionPyramidLevel = profile.settings.detectionPyramidLevel;
+    record.denoise = static_cast<int32_t>(profile.settings.denoise);
+    record.warpInterpolation = profile.settings.warpInterpolation;
+    record.threads = profile.threads;
+    record.budgetMs = profile.budgetMs;
+    record.estimatedFrameMs = profile.estimatedFrameMs;
+    record.checksum = fnv1a(&record, offsetof(ProfileRecord, checksum));
+
+    // Write then rename so a crash never leaves a truncated profile
+    const string tmp = path + ".tmp";
+    {
+        ofstream out(tmp, ios::binary | ios::trunc);
+        if (!out) {
+            LOGE("save: Cannot open %s", tmp.c_str());
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        if (!out) {
+            LOGE("save: Write failed");
+            return false;
+        }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        LOGE("save: Rename failed");
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+DeviceProfile DeviceCalibrator::load(const string& path) {
+    DeviceProfile profile;
+    profile.threads = 0;
+    profile.budgetMs = 0.0f;
+    profile.estimatedFrameMs = 0.0f;
+    profile.cpuCount = 0;
+    profile.valid = false;
+
+    ifstream in(path, ios::binary);
+    if (!in) return profile;
+
+    ProfileRecord record;
+    in.read(reinterpret_cast<char*>(&record), sizeof(record));
+    if (!in || in.gcount() != static_cast<streamsize>(sizeof(record))) {
+        LOGE("load: Truncated profile");
+        return profile;
+    }
+
+    if (record.magic != PROFILE_MAGIC || record.version != PROFILE_VERSION ||
+        record.checksum != fnv1a(&record, offsetof(ProfileRecord, checksum))) {
+        LOGE("load: Invalid or outdated profile");
+        return profile;
+    }
+    if (static_cast<int>(record.cpuCount) != getNumberOfCPUs()) {
+        LOGD("load: CPU count changed, recalibration needed");
+        return profile;
+    }
+    if (record.detectionPyramidLevel < 0 || record.detectionPyramidLevel > 2 ||
+        record.denoise < 0 || record.denoise > 2 ||
+        (record.warpInterpolation != INTER_LINEAR && record.warpInterpolation != INTER_CUBIC) ||
+        record.threads < 0 || record.threads > 64) {
+        LOGE("load: Profile fields out of range");
+        return profile;
+    }
+
+    profile.settings.detectionPyramidLevel = record.detectionPyramidLevel;
+    profile.settings.denoise = static_cast<DenoiseTier>(record.denoise);
+    profile.settings.warpInterpolation = record.warpInterpolation;
+    profile.threads = record.threads;
+    profile.budgetMs = record.budgetMs;
+    profile.estimatedFrameMs = record.estimatedFrameMs;
+    profile.cpuCount = static_cast<int>(record.cpuCount);
+    profile.valid = true;
+    return profile;
+}
+
+void DeviceCalibrator::apply(const DeviceProfile& profile) {
+    if (profile.valid && profile.threads > 0) {
+        setNumThreads(profile.threads);
+    }
+}
+
+} // namespace idverify
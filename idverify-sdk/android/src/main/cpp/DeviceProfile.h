@@ -0,0 +1,102 @@
+#ifndef DEVICE_PROFILE_H
+#define DEVICE_PROFILE_H
+
+#include <opencv2/core.hpp>
+#include <array>
+#include <string>
+#include <vector>
+#include "VisionProcessor.h"
+
+namespace idverify {
+
+/**
+ * Pipeline settings chosen for this device by calibration
+ */
+struct DeviceProfile {
+    PipelineSettings settings;    // Level-0 settings for the latency governor
+    int threads;                  // cv::setNumThreads value (0 = OpenCV default)
+    float budgetMs;               // Budget the profile was calibrated for
+    float estimatedFrameMs;       // Predicted processForOCR time with these settings
+    int cpuCount;                 // cv::getNumberOfCPUs() at calibration time
+    bool valid;
+};
+
+/**
+ * Stage timings measured during calibration (median ms over the frame set)
+ */
+struct CalibrationTimings {
+    std::array<float, 3> detectionMs;     // findCardCorners per pyramid level 0-2
+    std::array<bool, 3> detectionOk;      // Level found every card within tolerance
+    float warpCubicMs;
+    float warpLinearMs;
+    std::array<float, 3> denoiseMs;       // binarize + MRZ per DenoiseTier
+    std::vector<int> threadCounts;        // Thread counts tried
+    std::vector<float> threadFrameMs;     // Full processForOCR per thread count
+};
+
+/**
+ * DeviceCalibrator - First-run benchmark producing a persisted pipeline profile
+ *
+ * Renders a small set of synthetic card frames (no camera data is stored),
+ * times each stage variant on them and keeps the richest settings whose
+ * estimated frame cost fits the budget with headroom. The profile is a
+ * fixed-size binary record; it is rejected on version or CPU count change
+ * so a restored backup from another device triggers recalibration.
+ */
+class DeviceCalibrator {
+public:
+    /**
+     * Run the calibration benchmark (several seconds: call once, off the UI thread)
+     * About 20 full-card NLM passes dominate; ~4 s on one desktop x86 core, and
+     * 10-20 s should be expected on low-end ARM devices
+     * The calling thread is kept out of Metrics and Trace (InstrumentationPause)
+     * Leaves cv::setNumThreads at the chosen value; changes the process-wide pool while
+     * running, so it must not overlap a scan session
+     * @param budgetMs Per-frame latency budget
+     * @param timings Optional output of the raw stage timings
+     * @return DeviceProfile (valid=false if the synthetic cards were not detected)
+     */
+    static DeviceProfile calibrate(float budgetMs, CalibrationTimings* timings = nullptr);
+
+    /**
+     * Write a profile file
+     * @return false on I/O error
+     */
+    static bool save(const DeviceProfile& profile, const std::string& path);
+
+    /**
+     * Read a profile file
+     * @return DeviceProfile (valid=false if missing, corrupt or from another device)
+     */
+    static DeviceProfile load(const std::string& path);
+
+    /**
+     * Apply process-wide parts of a profile (OpenCV thread pool)
+     */
+    static void apply(const DeviceProfile& profile);
+
+    /**
+     * Render one synthetic calibration frame
+     * @param index Frame index (0..SYNTHETIC_FRAMES-1)
+     * @param corners Output ground-truth card corners (TL, TR, BR, BL)
+     * @return BGR frame of FRAME_WIDTH x FRAME_HEIGHT
+     */
+    static cv::Mat syntheticFrame(int index, std::vector<cv::Point>& corners);
+
+    static constexpr int SYNTHETIC_FRAMES = 3;
+    static constexpr int FRAME_WIDTH = 1280;
+    static constexpr int FRAME_HEIGHT = 720;
+
+    // Estimated frame cost must stay below budget * HEADROOM
+    static constexpr float HEADROOM = 0.8f;
+
+    // Max corner error (px, full frame) for a pyramid level to be usable
+    static constexpr float CORNER_TOLERANCE_PX = 12.0f;
+
+    static constexpr uint32_t PROFILE_MAGIC = 0x50564449;  // "IDVP"
+    static constexpr uint32_t PROFILE_VERSION = 1;
+};
+
+} // namespace idverify
+
+#endif // DEVICE_PROFILE_H
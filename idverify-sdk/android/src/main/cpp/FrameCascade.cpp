@@ -0,0 +1,255 @@
+#include "FrameCascade.h"
+#include "FrameRing.h"
+#include "GlareMap.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include "QualityKernel.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <chrono>
+#include <android/log.h>
+
+#define TAG "FrameCascade"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
+
+using namespace cv;
+using namespace std;
+
+namespace idverify {
+
+namespace {
+
+using Clock = chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+// Text ROIs preprocessed by the ROI stage
+constexpr ROIType FRONT_TEXT_TYPES[] = {
+    ROIType::TCKN, ROIType::SURNAME, ROIType::NAME, ROIType::BIRTHDATE, ROIType::SERIAL
+};
+constexpr ROIType BACK_TEXT_TYPES[] = { ROIType::MRZ };
+
+// Trace span names, indexed by CascadeStage
+constexpr const char* STAGE_SPAN_NAMES[CASCADE_STAGE_COUNT] = {
+    "cascade.presence", "cascade.quality", "cascade.detection", "cascade.warp", "cascade.roi"
+};
+
+}
+
+double CascadeStats::averageRejectMs() const {
+    uint64_t rejectedFrames = frames - passed - cancelled;
+    return rejectedFrames > 0 ? rejectedFrameMs / rejectedFrames : 0.0;
+}
+
+FrameCascade::FrameCascade(const CascadeConfig& config) {
+    configure(config);
+}
+
+bool FrameCascade::isValidOrder(const vector<CascadeStage>& order) {
+    array<int, CASCADE_STAGE_COUNT> position;
+    position.fill(-1);
+
+    for (size_t i = 0; i < order.size(); ++i) {
+        int s = static_cast<int>(order[i]);
+        if (s < 0 || s >= CASCADE_STAGE_COUNT || position[s] >= 0) return false;
+        position[s] = static_cast<int>(i);
+    }
+
+    auto at = [&](CascadeStage s) { return position[static_cast<int>(s)]; };
+
+    // WARP needs corners, ROI needs the warped card
+    if (at(CascadeStage::WARP) >= 0 &&
+        (at(CascadeStage::DETECTION) < 0 || at(CascadeStage::DETECTION) > at(CascadeStage::WARP))) {
+        return false;
+    }
+    if (at(CascadeStage::ROI) >= 0 &&
+        (at(CascadeStage::WARP) < 0 || at(CascadeStage::WARP) > at(CascadeStage::ROI))) {
+        return false;
+    }
+    return true;
+}
+
+bool FrameCascade::configure(const CascadeConfig& config) {
+    config_ = config;
+    if (!isValidOrder(config.order)) {
+        LOGE("configure: Invalid stage order, using default");
+        config_.order = CascadeConfig().order;
+        return false;
+    }
+    return true;
+}
+
+CascadeResult FrameCascade::run(const Mat& frame, bool isBackSide, StabilityEngine& stability,
+                                const PipelineSettings& settings, const vector<Point>& previousCorners,
+                                const CancellationToken* token) {
+    CascadeResult result;
+    result.passed = false;
+    result.rejectedAt = CascadeStage::PRESENCE;
+    result.corners.detected = false;
+    result.corners.confidence = 0.0f;
+    result.motion = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0, false};
+    result.blurScore = 0.0f;
+    result.textGlare = 0.0f;
+    result.stageMs.fill(0.0f);
+    result.totalMs = 0.0f;
+    result.status = ProcessStatus::OK;
+
+    Clock::time_point frameStart = Clock::now();
+    stats_.frames++;
+
+    if (frame.empty()) {
+        LOGE("run: Empty frame");
+        stats_.rejected[0]++;
+        return result;
+    }
+
+    for (CascadeStage stage : config_.order) {
+        const int s = static_cast<int>(stage);
+        Clock::time_point stageStart = Clock::now();
+
+        if (result.status == ProcessStatus::OK) {
+            result.status = CancellationToken::statusOf(token);
+        }
+        if (result.status != ProcessStatus::OK) {
+            // Stale frame: stop without counting it as a quality rejection
+            stats_.cancelled++;
+            Metrics::instance().increment(MetricCounter::CANCELLED);
+            result.rejectedAt = stage;
+            result.totalMs = static_cast<float>(elapsedMs(frameStart));
+            LOGD("run: Stopped before stage %d (%d)", s, static_cast<int>(result.status));
+            return result;
+        }
+
+        stats_.evaluated[s]++;
+        bool ok;
+        {
+            TraceSpan span(STAGE_SPAN_NAMES[s], "backSide", isBackSide ? 1 : 0);
+            ok = runStage(stage, frame, isBackSide, stability, settings, previousCorners, token, result);
+        }
+        result.stageMs[s] = static_cast<float>(elapsedMs(stageStart));
+        stats_.stageMs[s] += result.stageMs[s];
+
+        if (result.status != ProcessStatus::OK) {
+            stats_.cancelled++;
+            Metrics::instance().increment(MetricCounter::CANCELLED);
+            result.rejectedAt = stage;
+            result.totalMs = static_cast<float>(elapsedMs(frameStart));
+            LOGD("run: Stopped in stage %d (%d)", s, static_cast<int>(result.status));
+            return result;
+        }
+
+        if (!ok) {
+            stats_.rejected[s]++;
+            Metrics::instance().increment(
+                    static_cast<MetricCounter>(static_cast<int>(MetricCounter::REJECT_PRESENCE) + s));
+            result.rejectedAt = stage;
+            result.totalMs = static_cast<float>(elapsedMs(frameStart));
+            stats_.rejectedFrameMs += result.totalMs;
+            LOGD("run: Rejected at stage %d after %.2fms", s, result.totalMs);
+            return result;
+        }
+    }
+
+    result.passed = true;
+    result.totalMs = static_cast<float>(elapsedMs(frameStart));
+    stats_.passed++;
+    return result;
+}
+
+bool FrameCascade::runStage(CascadeStage stage, const Mat& frame, bool isBackSide,
+                            StabilityEngine& stability, const PipelineSettings& settings,
+                            const vector<Point>& previousCorners, const CancellationToken* token,
+                            CascadeResult& result) {
+    switch (stage) {
+        case CascadeStage::PRESENCE: {
+            // Nearest-neighbour thumbnail touches only the sampled pixels
+            int height = max(3, frame.rows * PRESENCE_WIDTH / max(1, frame.cols));
+            resize(frame, thumb_, Size(PRESENCE_WIDTH, height), 0, 0, INTER_NEAREST);
+            FrameQuality q = QualityKernel::analyze(thumb_);
+            return q.valid &&
+                   q.meanLuma >= config_.minMeanLuma &&
+                   q.meanLuma <= config_.maxMeanLuma &&
+                   q.glareRatio <= config_.maxFrameGlare &&
+                   q.localContrast >= config_.minLocalContrast;
+        }
+
+        case CascadeStage::QUALITY: {
+            // Blur on the full-resolution centre (where the card is framed)
+            Rect centre(frame.cols / 4, frame.rows / 4, frame.cols / 2, frame.rows / 2);
+            Mat crop = frame(centre);
+            if (crop.channels() == 3 || crop.channels() == 4) {
+                cvtColor(crop, center_, crop.channels() == 4 ? COLOR_BGRA2GRAY : COLOR_BGR2GRAY);
+            } else {
+                crop.copyTo(center_);
+            }
+            result.blurScore = QualityKernel::analyze(center_).blurScore;
+
+            // Stability is always updated so the previous frame stays current
+            result.motion = stability.update(frame);
+            bool steady = !result.motion.valid || result.motion.motionPx <= config_.maxMotionPx;
+
+            return result.blurScore >= config_.minBlurScore && steady;
+        }
+
+        case CascadeStage::DETECTION: {
+            result.corners.detected = false;
+            if (settings.useTracking && previousCorners.size() == 4) {
+                result.corners = VisionProcessor::trackCardCorners(frame, previousCorners,
+                                                                   settings.detectionPyramidLevel, token);
+            }
+            if (!result.corners.detected && result.corners.status == ProcessStatus::OK) {
+                result.corners = VisionProcessor::findCardCorners(frame, settings.detectionPyramidLevel,
+                                                                  token);
+            }
+            if (result.corners.status != ProcessStatus::OK) {
+                result.status = result.corners.status;
+                result.corners.detected = false;
+                return false;
+            }
+            return result.corners.detected &&
+                   result.corners.confidence >= config_.minCardConfidence;
+        }
+
+        case CascadeStage::WARP: {
+            result.warped = VisionProcessor::warpToID1(frame, result.corners.corners,
+                                                       settings.warpInterpolation);
+            if (result.warped.empty()) return false;
+            result.textGlare = GlareMap::compute(result.warped, isBackSide).textGlare;
+            return result.textGlare <= config_.maxTextGlare;
+        }
+
+        case CascadeStage::ROI: {
+            const ROIType* types = isBackSide ? BACK_TEXT_TYPES : FRONT_TEXT_TYPES;
+            size_t count = isBackSide ? sizeof(BACK_TEXT_TYPES) / sizeof(BACK_TEXT_TYPES[0])
+                                      : sizeof(FRONT_TEXT_TYPES) / sizeof(FRONT_TEXT_TYPES[0]);
+            Mat gray;
+            if (result.warped.channels() == 3 || result.warped.channels() == 4) {
+                cvtColor(result.warped, gray,
+                         result.warped.channels() == 4 ? COLOR_BGRA2GRAY : COLOR_BGR2GRAY);
+            } else {
+                gray = result.warped;
+            }
+
+            for (size_t i = 0; i < count; ++i) {
+                ROIType type = types[i];
+                ROIRegion region = getROIRegion(type, isBackSide);
+                ROIQuality q = FrameRing::scoreROI(VisionProcessor::cropROI(gray, region), 1.0f);
+                if (q.score < config_.minROIScore) {
+                    LOGD("runStage: ROI %d below quality (%.2f)", static_cast<int>(type), q.score);
+                    return false;
+                }
+                result.rois[static_cast<int>(type)] =
+                        VisionProcessor::preprocessROI(VisionProcessor::cropROI(result.warped, region).clone(),
+                                                       type, isBackSide);
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
+
+} // namespace idverify
@@ -0,0 +1,150 @@
+#ifndef FRAME_CASCADE_H
+#define FRAME_CASCADE_H
+
+#include <opencv2/core.hpp>
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "VisionProcessor.h"
+#include "StabilityEngine.h"
+
+namespace idverify {
+
+/**
+ * Cascade stages, cheapest first in the default order
+ */
+enum class CascadeStage : int {
+    PRESENCE = 0,     // Tiny thumbnail: something with structure, sane exposure
+    QUALITY = 1,      // Blur on the frame centre + global motion
+    DETECTION = 2,    // findCardCorners
+    WARP = 3,         // warpToID1 + glare inside text ROIs
+    ROI = 4           // Per-ROI preprocessing for OCR
+};
+
+constexpr int CASCADE_STAGE_COUNT = 5;
+
+/**
+ * Stage order and reject thresholds
+ */
+struct CascadeConfig {
+    // Evaluation order; DETECTION must precede WARP, WARP must precede ROI
+    std::vector<CascadeStage> order = {
+        CascadeStage::PRESENCE, CascadeStage::QUALITY, CascadeStage::DETECTION,
+        CascadeStage::WARP, CascadeStage::ROI
+    };
+
+    // Stage 0: presence / exposure
+    float minMeanLuma = 40.0f;        // Reject underexposed frames
+    float maxMeanLuma = 225.0f;       // Reject overexposed frames
+    float maxFrameGlare = 0.35f;      // Saturated ratio of the thumbnail
+    float minLocalContrast = 0.04f;   // Flat frames have nothing to detect
+
+    // Stage 1: blur + stability
+    float minBlurScore = 20.0f;       // QualityKernel blurScore (0-100)
+    float maxMotionPx = 12.0f;        // Full-frame px/frame
+
+    // Stage 2: detection
+    float minCardConfidence = 0.15f;  // CornerResult confidence
+
+    // Stage 3: warp
+    float maxTextGlare = 0.08f;       // Worst text ROI glare (GlareMap)
+
+    // Stage 4: ROI
+    float minROIScore = 0.15f;        // Worst text ROI quality (FrameRing::scoreROI)
+};
+
+/**
+ * Outcome of one frame through the cascade
+ */
+struct CascadeResult {
+    bool passed;                          // All stages accepted
+    CascadeStage rejectedAt;              // Valid only if !passed
+    CornerResult corners;                 // Filled once DETECTION ran
+    cv::Mat warped;                       // Filled once WARP ran
+    std::array<cv::Mat, ROI_TYPE_COUNT> rois;  // Preprocessed ROIs once ROI ran
+    StabilityResult motion;               // Filled once QUALITY ran
+    float blurScore;
+    float textGlare;
+    std::array<float, CASCADE_STAGE_COUNT> stageMs;  // Wall time per stage (0 = not run)
+    float totalMs;                        // Wall time spent on this frame
+    ProcessStatus status;                 // Not OK if stopped by the token at rejectedAt
+};
+
+/**
+ * Per-stage counters
+ */
+struct CascadeStats {
+    uint64_t frames = 0;
+    uint64_t passed = 0;
+    std::array<uint64_t, CASCADE_STAGE_COUNT> evaluated{};   // Frames that reached the stage
+    std::array<uint64_t, CASCADE_STAGE_COUNT> rejected{};    // Frames the stage rejected
+    std::array<double, CASCADE_STAGE_COUNT> stageMs{};       // Total time spent in the stage
+    double rejectedFrameMs = 0.0;                            // Total time of rejected frames
+    uint64_t cancelled = 0;                                  // Frames stopped by cancel/deadline
+
+    /**
+     * Average wall time of a rejected frame (ms)
+     */
+    double averageRejectMs() const;
+};
+
+/**
+ * FrameCascade - Quality-gated per-frame pipeline with early exit
+ *
+ * Stages run in the configured order and the frame is dropped at the first
+ * stage whose threshold fails, so blurred or overexposed frames never pay
+ * for detection, warp or ROI binarization. Rejections and stage times are
+ * counted per stage to measure the average cost of a rejected frame.
+ */
+class FrameCascade {
+public:
+    explicit FrameCascade(const CascadeConfig& config = CascadeConfig());
+
+    /**
+     * Replace configuration; invalid stage orders fall back to the default
+     * @return false if the order was rejected
+     */
+    bool configure(const CascadeConfig& config);
+
+    /**
+     * Run one camera frame through the cascade
+     * @param frame BGR camera frame
+     * @param isBackSide Selects text ROIs for the WARP and ROI stages
+     * @param stability Session stability engine (updated by the QUALITY stage)
+     * @param settings Pipeline cost settings (detection level, tracking, warp interpolation)
+     * @param previousCorners Last detected quad, used when settings.useTracking
+     * @param token Optional cancellation token, checked before each stage and inside detection
+     * @return CascadeResult
+     */
+    CascadeResult run(const cv::Mat& frame, bool isBackSide, StabilityEngine& stability,
+                      const PipelineSettings& settings = PipelineSettings(),
+                      const std::vector<cv::Point>& previousCorners = {},
+                      const CancellationToken* token = nullptr);
+
+    const CascadeStats& stats() const { return stats_; }
+    const CascadeConfig& config() const { return config_; }
+    void resetStats() { stats_ = CascadeStats(); }
+
+    /**
+     * Check that stage dependencies hold in an order
+     */
+    static bool isValidOrder(const std::vector<CascadeStage>& order);
+
+    // Width of the stage 0 thumbnail
+    static constexpr int PRESENCE_WIDTH = 80;
+
+private:
+    bool runStage(CascadeStage stage, const cv::Mat& frame, bool isBackSide,
+                  StabilityEngine& stability, const PipelineSettings& settings,
+                  const std::vector<cv::Point>& previousCorners, const CancellationToken* token,
+                  CascadeResult& result);
+
+    CascadeConfig config_;
+    CascadeStats stats_;
+    cv::Mat thumb_;    // Reused stage 0 buffer
+    cv::Mat center_;   // Reused stage 1 buffer
+};
+
+} // namespace idverify
+
+#endif // FRAME_CASCADE_H
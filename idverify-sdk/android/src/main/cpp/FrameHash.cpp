@@ -0,0 +1,51 @@
+#include "FrameHash.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <array>
+
+using namespace cv;
+using namespace std;
+
+namespace idverify {
+
+uint64_t FrameHash::compute(const Mat& frame) {
+    if (frame.empty()) {
+        return 0;
+    }
+
+    // Shrink first so color conversion touches 32x32 pixels only
+    Mat thumb, gray, coeffs;
+    resize(frame, thumb, Size(THUMB_SIZE, THUMB_SIZE), 0, 0, INTER_AREA);
+    if (thumb.channels() == 3 || thumb.channels() == 4) {
+        cvtColor(thumb, gray, thumb.channels() == 4 ? COLOR_BGRA2GRAY : COLOR_BGR2GRAY);
+    } else {
+        gray = thumb;
+    }
+    gray.convertTo(thumb, CV_32F);
+    dct(thumb, coeffs);
+
+    // Median of the low-frequency block without the DC term
+    array<float, HASH_SIZE * HASH_SIZE> low;
+    for (int y = 0; y < HASH_SIZE; ++y) {
+        const float* row = coeffs.ptr<float>(y);
+        for (int x = 0; x < HASH_SIZE; ++x) {
+            low[y * HASH_SIZE + x] = row[x];
+        }
+    }
+    array<float, HASH_SIZE * HASH_SIZE - 1> sorted;
+    copy(low.begin() + 1, low.end(), sorted.begin());
+    nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+    const float median = sorted[sorted.size() / 2];
+
+    uint64_t hash = 0;
+    for (int i = 0; i < HASH_SIZE * HASH_SIZE; ++i) {
+        if (low[i] > median) hash |= (uint64_t(1) << i);
+    }
+    return hash;
+}
+
+int FrameHash::distance(uint64_t a, uint64_t b) {
+    return __builtin_popcountll(a ^ b);
+}
+
+} // namespace idverify
@@ -0,0 +1,103 @@
+#ifndef FRAME_HASH_H
+#define FRAME_HASH_H
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+
+namespace idverify {
+
+/**
+ * FrameHash - 64-bit perceptual hash of a camera frame
+ *
+ * pHash: the frame is area-resized to a 32x32 luma thumbnail, transformed
+ * with a DCT, and the 8x8 lowest frequencies (DC excluded from the median)
+ * are thresholded against their median. Sensor noise and small exposure
+ * changes flip few bits; moving the card flips many.
+ */
+class FrameHash {
+public:
+    /**
+     * Hash a frame
+     * @param frame Gray or color frame
+     * @return 64-bit hash (0 for empty input)
+     */
+    static uint64_t compute(const cv::Mat& frame);
+
+    /**
+     * Number of differing bits
+     */
+    static int distance(uint64_t a, uint64_t b);
+
+    static constexpr int THUMB_SIZE = 32;
+    static constexpr int HASH_SIZE = 8;
+};
+
+/**
+ * Memo hit-rate counters
+ */
+struct MemoStats {
+    uint64_t lookups = 0;
+    uint64_t hits = 0;
+
+    float hitRate() const { return lookups > 0 ? static_cast<float>(hits) / lookups : 0.0f; }
+};
+
+/**
+ * HashMemo - Last result keyed by a perceptual frame hash
+ *
+ * A lookup hits when the new frame is within maxDistance bits of the frame
+ * the cached result was computed on. Distance is always measured against
+ * that processed frame, so slow drift eventually misses; maxHits bounds how
+ * long one result may be reused.
+ */
+template <typename T>
+class HashMemo {
+public:
+    /**
+     * @param maxDistance Max Hamming distance for a hit (< 0 disables the memo)
+     * @param maxHits Consecutive hits before a forced recompute
+     */
+    explicit HashMemo(int maxDistance = 4, int maxHits = 15)
+        : maxDistance_(maxDistance), maxHits_(maxHits), hash_(0), hits_(0), valid_(false) {}
+
+    /**
+     * Cached result for a frame hash, or nullptr on a miss
+     */
+    const T* lookup(uint64_t hash) {
+        stats_.lookups++;
+        if (!valid_ || maxDistance_ < 0 || hits_ >= maxHits_ ||
+            FrameHash::distance(hash, hash_) > maxDistance_) {
+            return nullptr;
+        }
+        hits_++;
+        stats_.hits++;
+        return &value_;
+    }
+
+    /**
+     * Remember the result computed for a frame hash
+     */
+    void store(uint64_t hash, const T& value) {
+        hash_ = hash;
+        value_ = value;
+        hits_ = 0;
+        valid_ = true;
+    }
+
+    void invalidate() { valid_ = false; hits_ = 0; value_ = T(); }
+    void resetStats() { stats_ = MemoStats(); }
+    const MemoStats& stats() const { return stats_; }
+
+private:
+    int maxDistance_;
+    int maxHits_;
+    uint64_t hash_;
+    int hits_;
+    bool valid_;
+    T value_;
+    MemoStats stats_;
+};
+
+} // namespace idverify
+
+#endif // FRAME_HASH_H
@@ -0,0 +1,272 @@
+#include "FrameRecord.h"
+#include <opencv2/imgproc.hpp>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <android/log.h>
+
+#define TAG "FrameRecord"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
+
+using namespace cv;
+using namespace std;
+
+namespace idverify {
+
+int FrameDecision::resultCode(const CascadeResult& result, bool skipped) {
+    if (skipped) return SKIPPED;
+    if (result.status != ProcessStatus::OK) return CANCELLED;
+    return result.passed ? PASSED : static_cast<int>(result.rejectedAt);
+}
+
+int record::channels(RecordFormat format) {
+    switch (format) {
+        case RecordFormat::Y8:    return 1;
+        case RecordFormat::RGBA8: return 4;
+        case RecordFormat::BGR8:  return 3;
+    }
+    return 0;
+}
+
+// ==================== FrameRecorder ====================
+
+FrameRecorder::FrameRecorder()
+    : file_(nullptr), format_(RecordFormat::Y8), maxFrames_(0), offset_(0) {}
+
+FrameRecorder::~FrameRecorder() {
+    close();
+}
+
+bool FrameRecorder::open(const string& path, RecordFormat format, int maxFrames) {
+    close();
+    if (record::channels(format) == 0) {
+        LOGE("open: Unknown format %d", static_cast<int>(format));
+        return false;
+    }
+
+    file_ = fopen(path.c_str(), "wb");
+    if (file_ == nullptr) {
+        LOGE("open: Cannot create %s", path.c_str());
+        return false;
+    }
+    format_ = format;
+    maxFrames_ = maxFrames;
+    offset_ = 0;
+    index_.clear();
+
+    // Placeholder until close(): indexOffset 0 marks an unfinished file
+    record::Header header;
+    memset(&header, 0, sizeof(header));
+    header.magic = record::MAGIC;
+    header.version = record::VERSION;
+    header.format = static_cast<uint16_t>(format);
+    if (!append(&header, sizeof(header))) {
+        fclose(file_);
+        file_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool FrameRecorder::append(const void* data, size_t size) {
+    if (size > 0 && fwrite(data, 1, size, file_) != size) {
+        LOGE("append: Write failed at offset %llu", static_cast<unsigned long long>(offset_));
+        return false;
+    }
+    offset_ += size;
+    return true;
+}
+
+bool FrameRecorder::write(const Mat& frame, int64_t timestampUs, const FrameDecision& decision,
+                          const string& annotation) {
+    if (file_ == nullptr || frame.empty() || frame.depth() != CV_8U) return false;
+    if (maxFrames_ > 0 && frames() >= maxFrames_) return false;
+
+    const int cn = frame.channels();
+    const Mat* pixels = &frame;
+    switch (format_) {
+        case RecordFormat::Y8:
+            if (cn == 3) { cvtColor(frame, converted_, COLOR_BGR2GRAY); pixels = &converted_; }
+            else if (cn != 1) return false;
+            break;
+        case RecordFormat::RGBA8:
+            if (cn == 3) { cvtColor(frame, converted_, COLOR_BGR2RGBA); pixels = &converted_; }
+            else if (cn == 1) { cvtColor(frame, converted_, COLOR_GRAY2RGBA); pixels = &converted_; }
+            else if (cn != 4) return false;
+            break;
+        case RecordFormat::BGR8:
+            if (cn == 1) { cvtColor(frame, converted_, COLOR_GRAY2BGR); pixels = &converted_; }
+            else if (cn != 3) return false;
+            break;
+    }
+
+    // Pixels start on a cache-line boundary so mapped frames are aligned views
+    static const uint8_t zeros[record::ALIGNMENT] = {};
+    size_t pad = (record::ALIGNMENT - offset_ % record::ALIGNMENT) % record::ALIGNMENT;
+    if (!append(zeros, pad)) return false;
+
+    record::IndexEntry entry{};
+    entry.offset = offset_;
+    entry.width = static_cast<uint32_t>(pixels->cols);
+    entry.height = static_cast<uint32_t>(pixels->rows);
+    entry.timestampUs = timestampUs;
+    entry.decision = decision;
+
+    const size_t rowBytes = pixels->cols * pixels->elemSize();
+    if (pixels->isContinuous()) {
+        if (!append(pixels->data, rowBytes * pixels->rows)) return false;
+    } else {
+        for (int y = 0; y < pixels->rows; ++y) {
+            if (!append(pixels->ptr(y), rowBytes)) return false;
+        }
+    }
+
+    entry.annotationOffset = offset_;
+    entry.annotationLength = static_cast<uint32_t>(annotation.size());
+    if (!append(annotation.data(), annotation.size())) return false;
+
+    index_.push_back(entry);
+    return true;
+}
+
+int FrameRecorder::close() {
+    if (file_ == nullptr) return -1;
+
+    bool ok = true;
+    static const uint8_t zeros[record::ALIGNMENT] = {};
+    size_t pad = (8 - offset_ % 8) % 8;
+    ok = ok && append(zeros, pad);
+
+    record::Header header;
+    memset(&header, 0, sizeof(header));
+    header.magic = record::MAGIC;
+    header.version = record::VERSION;
+    header.format = static_cast<uint16_t>(format_);
+    header.frameCount = static_cast<uint32_t>(index_.size());
+    header.indexOffset = offset_;
+    header.createdUnixMs = static_cast<uint64_t>(chrono::duration_cast<chrono::milliseconds>(
+            chrono::system_clock::now().time_since_epoch()).count());
+
+    ok = ok && append(index_.data(), index_.size() * sizeof(record::IndexEntry));
+    ok = ok && fseek(file_, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file_) == 1;
+    ok = (fclose(file_) == 0) && ok;
+    file_ = nullptr;
+
+    int count = frames();
+    index_.clear();
+    converted_.release();
+    if (!ok) {
+        LOGE("close: Could not finalize recording");
+        return -1;
+    }
+    LOGD("close: %d frames, %llu bytes", count, static_cast<unsigned long long>(offset_));
+    return count;
+}
+
+// ==================== FrameReplay ====================
+
+FrameReplay::FrameReplay()
+    : data_(nullptr), size_(0), header_(nullptr), index_(nullptr), count_(0) {}
+
+FrameReplay::~FrameReplay() {
+    close();
+}
+
+bool FrameReplay::open(const string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOGE("open: Cannot open %s", path.c_str());
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(record::Header))) {
+        LOGE("open: %s is too small", path.c_str());
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        LOGE("open: mmap failed for %s", path.c_str());
+        return false;
+    }
+    madvise(data, size, MADV_SEQUENTIAL);
+    data_ = static_cast<const uint8_t*>(data);
+    size_ = size;
+
+    const record::Header* header = reinterpret_cast<const record::Header*>(data_);
+    const int cn = record::channels(static_cast<RecordFormat>(header->format));
+    const uint64_t indexBytes = static_cast<uint64_t>(header->frameCount) * sizeof(record::IndexEntry);
+    if (header->magic != record::MAGIC || header->version != record::VERSION || cn == 0 ||
+        header->indexOffset == 0 || header->indexOffset % 8 != 0 ||
+        header->indexOffset > size_ || indexBytes > size_ - header->indexOffset) {
+        LOGE("open: %s is not a finished recording", path.c_str());
+        close();
+        return false;
+    }
+
+    // Validate every entry once so frame() can skip bounds checks
+    const record::IndexEntry* index = reinterpret_cast<const record::IndexEntry*>(data_ + header->indexOffset);
+    for (uint32_t i = 0; i < header->frameCount; ++i) {
+        const record::IndexEntry& e = index[i];
+        const uint64_t bytes = static_cast<uint64_t>(e.width) * e.height * cn;
+        if (e.width == 0 || e.height == 0 || e.offset > size_ || bytes > size_ - e.offset ||
+            e.annotationOffset > size_ || e.annotationLength > size_ - e.annotationOffset) {
+            LOGE("open: Frame %u of %s is out of bounds", i, path.c_str());
+            close();
+            return false;
+        }
+    }
+
+    header_ = header;
+    index_ = index;
+    count_ = header->frameCount;
+    return true;
+}
+
+void FrameReplay::close() {
+    if (data_ != nullptr) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    header_ = nullptr;
+    index_ = nullptr;
+    count_ = 0;
+}
+
+RecordFormat FrameReplay::format() const {
+    return header_ != nullptr ? static_cast<RecordFormat>(header_->format) : RecordFormat::Y8;
+}
+
+bool FrameReplay::frame(size_t index, RecordedFrame& out) const {
+    if (index >= count_) return false;
+
+    const record::IndexEntry& e = index_[index];
+    const int type = CV_8UC(record::channels(format()));
+    out.image = Mat(static_cast<int>(e.height), static_cast<int>(e.width), type,
+                    const_cast<uint8_t*>(data_ + e.offset));
+    out.timestampUs = e.timestampUs;
+    out.decision = e.decision;
+    out.annotation = reinterpret_cast<const char*>(data_ + e.annotationOffset);
+    out.annotationLength = e.annotationLength;
+    return true;
+}
+
+bool FrameReplay::isRecording(const string& path) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) return false;
+    uint32_t magic = 0;
+    bool ok = fread(&magic, sizeof(magic), 1, file) == 1 && magic == record::MAGIC;
+    fclose(file);
+    return ok;
+}
+
+} // namespace idverify
@@ -0,0 +1,203 @@
+#ifndef FRAME_RECORD_H
+#define FRAME_RECORD_H
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "FrameCascade.h"
+
+namespace idverify {
+
+/**
+ * Pixel layout of recorded frames (one per file)
+ */
+enum class RecordFormat : uint16_t {
+    Y8 = 1,         // Luma only (smallest; replay may differ by rounding)
+    RGBA8 = 2,      // As delivered by the camera bitmap (bit-exact replay)
+    BGR8 = 3        // Pipeline input layout (zero-copy, bit-exact replay)
+};
+
+/**
+ * Pipeline decision for one frame, as returned by sessionProcessFrame
+ */
+struct FrameDecision {
+    int8_t result = -1;         // 0-4 rejecting stage, 5 passed, 6 skipped, 7 cancelled, -1 none
+    uint8_t governorLevel = 0;  // Governor level the frame was processed at
+    uint8_t memoHit = 0;        // Result reused from the frame-hash memo
+    uint8_t flags = 0;          // FLAG_* bits
+    float totalMs = 0.0f;       // Cascade time (0 for skipped frames)
+
+    static constexpr uint8_t FLAG_BACK_SIDE = 1;       // Scanned as back side
+    static constexpr uint8_t FLAG_SESSION_RESET = 2;   // ScanSession::reset() ran before this frame
+
+    static constexpr int PASSED = CASCADE_STAGE_COUNT;
+    static constexpr int SKIPPED = CASCADE_STAGE_COUNT + 1;
+    static constexpr int CANCELLED = CASCADE_STAGE_COUNT + 2;
+
+    /**
+     * Result code of a processFrame call
+     * @param skipped True if the governor skipped the frame
+     */
+    static int resultCode(const CascadeResult& result, bool skipped);
+};
+
+/**
+ * One frame of a recording (image is a read-only view into the mapping)
+ */
+struct RecordedFrame {
+    cv::Mat image;              // Y8: CV_8UC1, RGBA8: CV_8UC4, BGR8: CV_8UC3
+    int64_t timestampUs;        // Session recordings: since recording started
+    FrameDecision decision;
+    const char* annotation;     // Opaque bytes (e.g. a corpus label), not NUL-terminated
+    uint32_t annotationLength;
+};
+
+/**
+ * .idvr container (little-endian, all offsets from the start of the file):
+ *
+ *   header   64 bytes (magic "IDVR", version, format, frame count, index offset)
+ *   frames   per frame: pixels (64-byte aligned, rows packed) + annotation
+ *   index    frameCount x 48-byte entries (offset, size, timestamp, decision)
+ *
+ * The index is written last, so a recording that was never closed has
+ * indexOffset == 0 and is rejected by FrameReplay.
+ */
+namespace record {
+
+constexpr uint32_t MAGIC = 0x52564449;     // "IDVR"
+constexpr uint16_t VERSION = 1;
+constexpr size_t ALIGNMENT = 64;
+
+struct Header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t format;            // RecordFormat
+    uint32_t frameCount;
+    uint32_t reserved0;
+    uint64_t indexOffset;
+    uint64_t createdUnixMs;
+    uint8_t reserved[32];
+};
+
+struct IndexEntry {
+    uint64_t offset;            // Pixels
+    uint32_t width;
+    uint32_t height;
+    int64_t timestampUs;
+    uint64_t annotationOffset;
+    uint32_t annotationLength;
+    FrameDecision decision;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(Header) == 64, "record::Header must stay 64 bytes");
+static_assert(sizeof(IndexEntry) == 48, "record::IndexEntry must stay 48 bytes");
+
+/**
+ * Bytes per pixel of a format (0 if unknown)
+ */
+int channels(RecordFormat format);
+
+} // namespace record
+
+/**
+ * FrameRecorder - Appends frames and decisions to a .idvr file
+ *
+ * Frames are converted into the file's format through a reused buffer and
+ * streamed to disk; only the 48-byte index entries stay in memory.
+ */
+class FrameRecorder {
+public:
+    FrameRecorder();
+    ~FrameRecorder();
+
+    FrameRecorder(const FrameRecorder&) = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+    /**
+     * Create (truncate) a recording
+     * @param format Pixel layout stored for every frame
+     * @param maxFrames Frames accepted before write() starts failing (0 = unlimited)
+     * @return false if the file cannot be created
+     */
+    bool open(const std::string& path, RecordFormat format, int maxFrames = 0);
+
+    /**
+     * Append one frame
+     * @param frame BGR (or gray for Y8) frame
+     * @param timestampUs Capture time
+     * @param annotation Opaque bytes kept with the frame
+     * @return false if closed, full, or the write failed
+     */
+    bool write(const cv::Mat& frame, int64_t timestampUs, const FrameDecision& decision,
+               const std::string& annotation = std::string());
+
+    /**
+     * Write the index and header; the file is valid only after this
+     * @return Frames in the recording (-1 if the file could not be finalized)
+     */
+    int close();
+
+    bool isOpen() const { return file_ != nullptr; }
+    int frames() const { return static_cast<int>(index_.size()); }
+
+private:
+    bool append(const void* data, size_t size);
+
+    FILE* file_;
+    RecordFormat format_;
+    int maxFrames_;
+    uint64_t offset_;                           // End of written data
+    std::vector<record::IndexEntry> index_;
+    cv::Mat converted_;                         // Reused conversion buffer
+};
+
+/**
+ * FrameReplay - Read-only memory-mapped view of a .idvr file
+ *
+ * Opening validates the header and index; frames are then served without
+ * decoding or copying. Safe to read from several threads.
+ */
+class FrameReplay {
+public:
+    FrameReplay();
+    ~FrameReplay();
+
+    FrameReplay(const FrameReplay&) = delete;
+    FrameReplay& operator=(const FrameReplay&) = delete;
+
+    /**
+     * Map a recording
+     * @return false if the file is missing, truncated or not a closed recording
+     */
+    bool open(const std::string& path);
+
+    void close();
+
+    size_t size() const { return count_; }
+    RecordFormat format() const;
+
+    /**
+     * View of one frame (valid until close())
+     * @return false if index is out of range
+     */
+    bool frame(size_t index, RecordedFrame& out) const;
+
+    /**
+     * Check a file for the .idvr magic without mapping it
+     */
+    static bool isRecording(const std::string& path);
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    const record::Header* header_;
+    const record::IndexEntry* index_;
+    size_t count_;
+};
+
+} // namespace idverify
+
+#endif // FRAME_RECORD_H
@@ -0,0 +1,207 @@
+#include "FrameRing.h"
+#include "VisionProcessor.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <android/log.h>
+
+#define TAG "FrameRing"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
+
+using namespace cv;
+using namespace std;
+
+namespace idverify {
+
+namespace {
+
+// ROIs scored per side (EXPIRY is read from the MRZ band)
+constexpr ROIType FRONT_TYPES[] = {
+    ROIType::TCKN, ROIType::SURNAME, ROIType::NAME,
+    ROIType::PHOTO, ROIType::SERIAL, ROIType::BIRTHDATE
+};
+constexpr ROIType BACK_TYPES[] = { ROIType::MRZ };
+
+// Laplacian variance at which sharpness reaches 0.5
+constexpr float BLUR_HALF_POINT = 150.0f;
+
+// Glare ratio inside a text field at which the score drops to 0
+constexpr float GLARE_CUTOFF = 0.25f;
+
+// Luma level considered saturated (same as detectGlare)
+constexpr int GLARE_LEVEL = 240;
+
+}
+
+FrameRing::FrameRing(int capacity)
+    : slots_(max(1, capacity)), head_(0), count_(0) {}
+
+ROIQuality FrameRing::scoreROI(const Mat& gray, float sourceScale) {
+    ROIQuality q = {0.0f, 1.0f, 0.0f, 0.0f, 0.0f};
+    if (gray.empty()) {
+        return q;
+    }
+
+    Mat lap;
+    Laplacian(gray, lap, CV_16S);
+    Scalar lapMean, lapStd;
+    meanStdDev(lap, lapMean, lapStd);
+
+    Scalar mean, stddev;
+    meanStdDev(gray, mean, stddev);
+
+    int saturated = countNonZero(gray >= GLARE_LEVEL);
+
+    q.blur = static_cast<float>(lapStd[0] * lapStd[0]);
+    q.glare = static_cast<float>(saturated) / static_cast<float>(gray.total());
+    q.contrast = min(1.0f, static_cast<float>(stddev[0]) / 128.0f);
+    q.resolution = sourceScale;
+
+    float sharpness = q.blur / (q.blur + BLUR_HALF_POINT);
+    float glarePenalty = max(0.0f, 1.0f - q.glare / GLARE_CUTOFF);
+    float contrastFactor = min(1.0f, q.contrast * 4.0f);  // stddev >= 32 is enough
+    float resolutionFactor = min(1.0f, max(0.0f, sourceScale));
+
+    q.score = sharpness * glarePenalty * contrastFactor * resolutionFactor;
+    return q;
+}
+
+void FrameRing::push(const Mat& warpedCard, bool isBackSide, float sourceScale, uint64_t frameId) {
+    if (warpedCard.empty()) {
+        LOGE("push: Empty input");
+        return;
+    }
+
+    Slot& slot = slots_[head_];
+
+    // copyTo reuses the slot buffer when size/type match, so steady state allocates nothing
+    warpedCard.copyTo(slot.card);
+    slot.isBackSide = isBackSide;
+    slot.frameId = frameId;
+    slot.scored.fill(false);
+
+    if (warpedCard.channels() == 3 || warpedCard.channels() == 4) {
+        cvtColor(warpedCard, gray_, warpedCard.channels() == 4 ? COLOR_BGRA2GRAY : COLOR_BGR2GRAY);
+    } else {
+        warpedCard.copyTo(gray_);
+    }
+
+    auto scoreTypes = [&](const ROIType* types, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            ROIType type = types[i];
+            Mat roiGray = VisionProcessor::cropROI(gray_, getROIRegion(type, isBackSide));
+            slot.quality[static_cast<int>(type)] = scoreROI(roiGray, sourceScale);
+            slot.scored[static_cast<int>(type)] = true;
+        }
+    };
+
+    if (isBackSide) {
+        scoreTypes(BACK_TYPES, sizeof(BACK_TYPES) / sizeof(BACK_TYPES[0]));
+    } else {
+        scoreTypes(FRONT_TYPES, sizeof(FRONT_TYPES) / sizeof(FRONT_TYPES[0]));
+    }
+
+    head_ = (head_ + 1) % capacity();
+    count_ = min(count_ + 1, capacity());
+}
+
+BestROI FrameRing::bestROI(ROIType type) const {
+    BestROI best;
+    best.found = false;
+    best.frameId = 0;
+    best.quality = {0.0f, 1.0f, 0.0f, 0.0f, 0.0f};
+
+    // EXPIRY lives in the MRZ band; score lookups use the MRZ entry
+    ROIType lookup = (type == ROIType::EXPIRY) ? ROIType::MRZ : type;
+    int index = static_cast<int>(lookup);
+    if (index < 0 || index >= ROI_TYPE_COUNT) {
+        return best;
+    }
+
+    const Slot* bestSlot = nullptr;
+    for (int i = 0; i < count_; ++i) {
+        const Slot& slot = slots_[i];
+        if (!slot.scored[index]) continue;
+        if (bestSlot == nullptr || slot.quality[index].score > best.quality.score) {
+            bestSlot = &slot;
+            best.quality = slot.quality[index];
+        }
+    }
+
+    if (bestSlot == nullptr) {
+        return best;
+    }
+
+    // Owned copy: the slot buffer is overwritten in place by later pushes
+    best.crop = VisionProcessor::cropROI(bestSlot->card,
+                                         getROIRegion(lookup, bestSlot->isBackSide)).clone();
+    best.frameId = bestSlot->frameId;
+    best.found = true;
+    return best;
+}
+
+ROIQuality FrameRing::latestQuality(ROIType type) const {
+    ROIQuality none = {0.0f, 1.0f, 0.0f, 0.0f, 0.0f};
+    if (count_ == 0) {
+        return none;
+    }
+
+    int latest = (head_ + capacity() - 1) % capacity();
+    int index = static_cast<int>(type == ROIType::EXPIRY ? ROIType::MRZ : type);
+    if (index < 0 || index >= ROI_TYPE_COUNT || !slots_[latest].scored[index]) {
+        return none;
+    }
+    return slots_[latest].quality[index];
+}
+
+float FrameRing::textScore(const Slot& slot) {
+    float worst = 1.0f;
+    bool any = false;
+    for (int i = 0; i < ROI_TYPE_COUNT; ++i) {
+        if (!slot.scored[i] || i == static_cast<int>(ROIType::PHOTO)) continue;
+        worst = min(worst, slot.quality[i].score);
+        any = true;
+    }
+    return any ? worst : 0.0f;
+}
+
+float FrameRing::latestTextScore() const {
+    if (count_ == 0) {
+        return 0.0f;
+    }
+    return textScore(slots_[(head_ + capacity() - 1) % capacity()]);
+}
+
+BestFrame FrameRing::bestFrame(bool isBackSide) const {
+    BestFrame best;
+    best.score = 0.0f;
+    best.frameId = 0;
+    best.found = false;
+
+    const Slot* bestSlot = nullptr;
+    for (int i = 0; i < count_; ++i) {
+        const Slot& slot = slots_[i];
+        if (slot.isBackSide != isBackSide) continue;
+        float score = textScore(slot);
+        if (bestSlot == nullptr || score > best.score) {
+            bestSlot = &slot;
+            best.score = score;
+        }
+    }
+
+    if (bestSlot == nullptr) {
+        return best;
+    }
+
+    best.card = bestSlot->card.clone();
+    best.frameId = bestSlot->frameId;
+    best.found = true;
+    return best;
+}
+
+void FrameRing::reset() {
+    head_ = 0;
+    count_ = 0;
+}
+
+} // namespace idverify
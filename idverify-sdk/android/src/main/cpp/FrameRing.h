@@ -0,0 +1,126 @@
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include <opencv2/core.hpp>
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "ROIMapper.h"
+
+namespace idverify {
+
+/**
+ * Quality of one ROI inside one warped frame
+ * Computed once when the frame enters the ring
+ */
+struct ROIQuality {
+    float blur;        // Laplacian variance inside the ROI (higher = sharper)
+    float glare;       // 0-1, ratio of saturated pixels inside the ROI
+    float contrast;    // 0-1, luma standard deviation / 128
+    float resolution;  // Source pixels per warped pixel (1.0 = native)
+    float score;       // 0-1 combined score used for selection
+};
+
+/**
+ * Best crop for one ROI type across the ring
+ */
+struct BestROI {
+    cv::Mat crop;        // Unprocessed ROI crop (owned copy)
+    ROIQuality quality;  // Quality the selection was based on
+    uint64_t frameId;    // Frame the crop was taken from
+    bool found;          // False if no frame of the matching side is buffered
+};
+
+/**
+ * Best whole card across the ring
+ */
+struct BestFrame {
+    cv::Mat card;        // Warped card (owned copy)
+    float score;         // Worst text-ROI score of that frame
+    uint64_t frameId;
+    bool found;          // False if no frame of the requested side is buffered
+};
+
+/**
+ * FrameRing - Bounded ring of the last K warped cards with per-ROI quality
+ *
+ * Auto-capture decides late; the frame that triggered it is often not the
+ * best one. The ring keeps K warped cards in preallocated slots and scores
+ * every ROI on push, so bestROI() is a K-way max over stored scores and the
+ * chosen field may come from a different frame than its neighbours.
+ */
+class FrameRing {
+public:
+    /**
+     * @param capacity Number of warped cards kept (K)
+     */
+    explicit FrameRing(int capacity = 8);
+
+    /**
+     * Copy a warped card into the oldest slot and score its ROIs
+     * @param warpedCard 856x540 warped card image
+     * @param isBackSide True for back-side frames (MRZ scored)
+     * @param sourceScale Source pixels per warped pixel (card width / 856)
+     * @param frameId Caller frame identifier
+     */
+    void push(const cv::Mat& warpedCard, bool isBackSide, float sourceScale, uint64_t frameId);
+
+    /**
+     * Sharpest, least-glared crop of a field across buffered frames
+     * @param type ROI type
+     * @return BestROI (found=false if no frame of the matching side)
+     */
+    BestROI bestROI(ROIType type) const;
+
+    /**
+     * Quality scores of the most recently pushed frame
+     * @param type ROI type
+     * @return Quality (score=0 if not scored for that frame)
+     */
+    ROIQuality latestQuality(ROIType type) const;
+
+    /**
+     * Worst text-ROI score (PHOTO excluded) of the most recently pushed frame
+     * @return 0-1 (0 if the ring is empty)
+     */
+    float latestTextScore() const;
+
+    /**
+     * Frame whose worst text ROI is best, for single-frame capture output
+     * @param isBackSide Side to select from
+     * @return BestFrame (found=false if no frame of that side)
+     */
+    BestFrame bestFrame(bool isBackSide) const;
+
+    void reset();
+
+    int size() const { return count_; }
+    int capacity() const { return static_cast<int>(slots_.size()); }
+
+    /**
+     * Score one ROI crop
+     * @param gray Grayscale ROI crop
+     * @param sourceScale Source pixels per warped pixel
+     */
+    static ROIQuality scoreROI(const cv::Mat& gray, float sourceScale);
+
+private:
+    struct Slot {
+        cv::Mat card;                                    // Reused warped card buffer
+        bool isBackSide = false;
+        uint64_t frameId = 0;
+        std::array<ROIQuality, ROI_TYPE_COUNT> quality;  // Indexed by ROIType
+        std::array<bool, ROI_TYPE_COUNT> scored;         // ROI scored for this frame
+    };
+
+    static float textScore(const Slot& slot);
+
+    std::vector<Slot> slots_;
+    int head_;    // Next slot to write
+    int count_;   // Valid slots
+    cv::Mat gray_;  // Reused grayscale conversion buffer
+};
+
+} // namespace idverify
+
+#endif // FRAME_RING_H
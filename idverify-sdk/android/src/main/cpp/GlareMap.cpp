@@ -0,0 +1,176 @@
+#include "GlareMap.h"
+#include "VisionProcessor.h"
+#include <opencv2/imgproc.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <android/log.h>
+
+#define TAG "GlareMap"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
+
+using namespace cv;
+using namespace std;
+
+namespace idverify {
+
+namespace {
+
+// Text ROIs per side; PHOTO and HOLOGRAM_ZONE are allowed to shine
+constexpr ROIType FRONT_TEXT_TYPES[] = {
+    ROIType::TCKN, ROIType::SURNAME, ROIType::NAME, ROIType::SERIAL, ROIType::BIRTHDATE
+};
+constexpr ROIType BACK_TEXT_TYPES[] = { ROIType::MRZ };
+
+void toGray(const Mat& src, Mat& gray) {
+    if (src.channels() == 3 || src.channels() == 4) {
+        cvtColor(src, gray, src.channels() == 4 ? COLOR_BGRA2GRAY : COLOR_BGR2GRAY);
+    } else {
+        gray = src;
+    }
+}
+
+}
+
+void GlareMap::countRow(const uchar* row, int width, int* tileCounts) {
+    int x = 0;
+    int t = 0;
+#if CV_SIMD128
+    // One vector per tile row: compare, mask to 0/1, horizontal sum
+    const v_uint8x16 level = v_setall_u8(static_cast<uchar>(GLARE_LEVEL));
+    const v_uint8x16 one = v_setall_u8(1);
+    for (; x + TILE_WIDTH <= width; x += TILE_WIDTH, ++t) {
+        v_uint8x16 v = v_load(row + x);
+        tileCounts[t] += static_cast<int>(v_reduce_sum((v >= level) & one));
+    }
+#endif
+    for (; x < width; ++x) {
+        tileCounts[x / TILE_WIDTH] += row[x] >= GLARE_LEVEL;
+    }
+}
+
+GlareReport GlareMap::fromLuma(const Mat& luma, bool isBackSide) {
+    GlareReport report;
+    report.roiGlare.fill(-1.0f);
+    report.cardGlare = 0.0f;
+    report.textGlare = 0.0f;
+    report.hologramGlare = 0.0f;
+    report.valid = false;
+
+    const int tilesX = (luma.cols + TILE_WIDTH - 1) / TILE_WIDTH;
+    const int tilesY = (luma.rows + TILE_HEIGHT - 1) / TILE_HEIGHT;
+
+    // Single pass over the plane; counts accumulate per tile
+    vector<int> counts(tilesX * tilesY, 0);
+    int total = 0;
+    for (int y = 0; y < luma.rows; ++y) {
+        countRow(luma.ptr<uchar>(y), luma.cols, &counts[(y / TILE_HEIGHT) * tilesX]);
+    }
+
+    report.tiles.create(tilesY, tilesX, CV_32F);
+    for (int ty = 0; ty < tilesY; ++ty) {
+        int th = min(TILE_HEIGHT, luma.rows - ty * TILE_HEIGHT);
+        float* out = report.tiles.ptr<float>(ty);
+        for (int tx = 0; tx < tilesX; ++tx) {
+            int tw = min(TILE_WIDTH, luma.cols - tx * TILE_WIDTH);
+            int c = counts[ty * tilesX + tx];
+            out[tx] = static_cast<float>(c) / static_cast<float>(tw * th);
+            total += c;
+        }
+    }
+
+    report.cardGlare = static_cast<float>(total) / static_cast<float>(luma.total());
+    report.valid = true;
+
+    auto fill = [&](const ROIType* types, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            float g = regionGlare(report, getROIRegion(types[i], isBackSide));
+            report.roiGlare[static_cast<int>(types[i])] = g;
+            report.textGlare = max(report.textGlare, g);
+        }
+    };
+
+    if (isBackSide) {
+        fill(BACK_TEXT_TYPES, sizeof(BACK_TEXT_TYPES) / sizeof(BACK_TEXT_TYPES[0]));
+    } else {
+        fill(FRONT_TEXT_TYPES, sizeof(FRONT_TEXT_TYPES) / sizeof(FRONT_TEXT_TYPES[0]));
+        report.roiGlare[static_cast<int>(ROIType::PHOTO)] = regionGlare(report, FrontROI::PHOTO);
+        report.hologramGlare = regionGlare(report, FrontROI::HOLOGRAM_ZONE);
+    }
+
+    LOGD("fromLuma: card=%.3f, text=%.3f, hologram=%.3f",
+         report.cardGlare, report.textGlare, report.hologramGlare);
+
+    return report;
+}
+
+GlareReport GlareMap::compute(const Mat& warpedCard, bool isBackSide) {
+    if (warpedCard.empty()) {
+        LOGE("compute: Empty input");
+        GlareReport report = fromLuma(Mat(GRID_HEIGHT, GRID_WIDTH, CV_8U, Scalar(0)), isBackSide);
+        report.valid = false;
+        return report;
+    }
+
+    Mat gray, luma;
+    toGray(warpedCard, gray);
+    resize(gray, luma, Size(GRID_WIDTH, GRID_HEIGHT), 0, 0, INTER_AREA);
+
+    return fromLuma(luma, isBackSide);
+}
+
+GlareReport GlareMap::computeInQuad(const Mat& frame, const vector<Point>& corners, bool isBackSide) {
+    if (frame.empty() || corners.size() != 4) {
+        LOGE("computeInQuad: Invalid input");
+        GlareReport report = fromLuma(Mat(GRID_HEIGHT, GRID_WIDTH, CV_8U, Scalar(0)), isBackSide);
+        report.valid = false;
+        return report;
+    }
+
+    vector<Point2f> src = VisionProcessor::orderCorners(corners);
+    vector<Point2f> dst = {
+        Point2f(0, 0),
+        Point2f(GRID_WIDTH - 1, 0),
+        Point2f(GRID_WIDTH - 1, GRID_HEIGHT - 1),
+        Point2f(0, GRID_HEIGHT - 1)
+    };
+
+    // Only the card quad is sampled; background never enters the map
+    Mat gray, luma;
+    toGray(frame, gray);
+    Mat M = getPerspectiveTransform(src, dst);
+    warpPerspective(gray, luma, M, Size(GRID_WIDTH, GRID_HEIGHT), INTER_LINEAR);
+
+    return fromLuma(luma, isBackSide);
+}
+
+float GlareMap::regionGlare(const GlareReport& report, const ROIRegion& region) {
+    if (report.tiles.empty()) {
+        return 0.0f;
+    }
+
+    // Region in grid pixels, then tiles it overlaps
+    int x0 = static_cast<int>(region.x * GRID_WIDTH);
+    int y0 = static_cast<int>(region.y * GRID_HEIGHT);
+    int x1 = static_cast<int>((region.x + region.width) * GRID_WIDTH);
+    int y1 = static_cast<int>((region.y + region.height) * GRID_HEIGHT);
+
+    int tx0 = max(0, x0 / TILE_WIDTH);
+    int ty0 = max(0, y0 / TILE_HEIGHT);
+    int tx1 = min(report.tiles.cols - 1, max(tx0, (x1 - 1) / TILE_WIDTH));
+    int ty1 = min(report.tiles.rows - 1, max(ty0, (y1 - 1) / TILE_HEIGHT));
+
+    double sum = 0.0;
+    int n = 0;
+    for (int ty = ty0; ty <= ty1; ++ty) {
+        const float* row = report.tiles.ptr<float>(ty);
+        for (int tx = tx0; tx <= tx1; ++tx) {
+            sum += row[tx];
+            n++;
+        }
+    }
+
+    return n > 0 ? static_cast<float>(sum / n) : 0.0f;
+}
+
+} // namespace idverify
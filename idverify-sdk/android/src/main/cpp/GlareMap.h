@@ -0,0 +1,83 @@
+#ifndef GLARE_MAP_H
+#define GLARE_MAP_H
+
+#include <opencv2/core.hpp>
+#include <array>
+#include <vector>
+#include "ROIMapper.h"
+
+namespace idverify {
+
+/**
+ * Card-only glare report
+ */
+struct GlareReport {
+    cv::Mat tiles;                                // CV_32F, saturated ratio per tile (card grid)
+    std::array<float, ROI_TYPE_COUNT> roiGlare;   // 0-1 per ROIType, -1 if not on this side
+    float cardGlare;                              // 0-1 over the whole card
+    float textGlare;                              // 0-1, worst text ROI (photo/hologram ignored)
+    float hologramGlare;                          // 0-1 inside FrontROI::HOLOGRAM_ZONE
+    bool valid;
+};
+
+/**
+ * GlareMap - Tiled glare measurement on the card region only
+ *
+ * Works on a half-resolution luma plane of the warped card (or of the quad,
+ * warped directly at that resolution). One pass over the plane counts
+ * saturated pixels per 16x8 tile with 128-bit universal intrinsics; per-ROI
+ * ratios are then read off the tile grid, so background glare and hologram
+ * glare no longer count against text fields.
+ */
+class GlareMap {
+public:
+    /**
+     * Glare map of an already warped card
+     * @param warpedCard 856x540 warped card (gray or color)
+     * @param isBackSide True to report back-side ROIs
+     * @return GlareReport
+     */
+    static GlareReport compute(const cv::Mat& warpedCard, bool isBackSide);
+
+    /**
+     * Glare map of the card quad in a raw camera frame
+     * The quad is warped straight to the half-resolution luma grid
+     * @param frame Camera frame (gray or color)
+     * @param corners 4 card corners (any order)
+     * @param isBackSide True to report back-side ROIs
+     * @return GlareReport
+     */
+    static GlareReport computeInQuad(const cv::Mat& frame, const std::vector<cv::Point>& corners,
+                                     bool isBackSide);
+
+    /**
+     * Glare ratio of an arbitrary card region from a computed report
+     * @param report Report from compute/computeInQuad
+     * @param region Normalized card region
+     * @return 0-1 saturated ratio (tiles overlapping the region)
+     */
+    static float regionGlare(const GlareReport& report, const ROIRegion& region);
+
+    // Half-resolution grid the map is computed on
+    static constexpr int GRID_WIDTH = 428;
+    static constexpr int GRID_HEIGHT = 270;
+
+    // Tile size in grid pixels (16 = one 128-bit vector of u8)
+    static constexpr int TILE_WIDTH = 16;
+    static constexpr int TILE_HEIGHT = 8;
+
+    // Luma at or above this level is saturated (same as detectGlare)
+    static constexpr int GLARE_LEVEL = 240;
+
+private:
+    static GlareReport fromLuma(const cv::Mat& luma, bool isBackSide);
+
+    /**
+     * Count saturated pixels of one row into per-tile counters
+     */
+    static void countRow(const uchar* row, int width, int* tileCounts);
+};
+
+} // namespace idverify
+
+#endif // GLARE_MAP_H
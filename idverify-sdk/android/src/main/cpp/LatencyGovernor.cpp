@@ -0,0 +1,161 @@
+#include "LatencyGovernor.h"
+#include <algorithm>
+#include <cmath>
+#include <android/log.h>
+
+#define TAG "LatencyGovernor"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
+
+using namespace std;
+
+namespace idverify {
+
+// ==================== LatencyHistogram ====================
+
+float LatencyHistogram::bucketUpperMs(int bucket) {
+    // 0.25 ms * sqrt(2)^bucket
+    return 0.25f * std::pow(1.41421356f, static_cast<float>(bucket));
+}
+
+void LatencyHistogram::record(float ms) {
+    int bucket = 0;
+    if (ms > 0.25f) {
+        bucket = static_cast<int>(std::ceil(2.0f * std::log2(ms / 0.25f)));
+    }
+    buckets_[min(max(bucket, 0), BUCKETS - 1)]++;
+    count_++;
+}
+
+float LatencyHistogram::percentile(float p) const {
+    if (count_ == 0) return 0.0f;
+
+    uint64_t target = static_cast<uint64_t>(std::ceil(p * count_));
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        seen += buckets_[i];
+        if (seen >= target) return bucketUpperMs(i);
+    }
+    return bucketUpperMs(BUCKETS - 1);
+}
+
+void LatencyHistogram::reset() {
+    buckets_.fill(0);
+    count_ = 0;
+}
+
+// ==================== LatencyGovernor ====================
+
+LatencyGovernor::LatencyGovernor(const GovernorConfig& config)
+    : config_(config) {
+    reset();
+}
+
+PipelineSettings LatencyGovernor::settingsForLevel(int level, const PipelineSettings& base) {
+    PipelineSettings s = base;
+
+    // Ladder, cheapest quality loss first; each level includes the previous ones
+    if (level >= 1) {
+        s.useTracking = true;
+    }
+    if (level >= 2) {
+        s.detectionPyramidLevel = max(s.detectionPyramidLevel, 1);
+    }
+    if (level >= 3) {
+        s.denoise = max(s.denoise, DenoiseTier::GAUSSIAN);
+    }
+    if (level >= 4) {
+        s.detectionPyramidLevel = max(s.detectionPyramidLevel, 2);
+        s.denoise = DenoiseTier::NONE;
+    }
+    if (level >= 5) {
+        s.frameSkip = max(s.frameSkip, 1);
+    }
+
+    return s;
+}
+
+bool LatencyGovernor::shouldProcess() {
+    if (sinceProcessed_ < static_cast<uint64_t>(settings_.frameSkip)) {
+        sinceProcessed_++;
+        skipped_++;
+        return false;
+    }
+    sinceProcessed_ = 0;
+    return true;
+}
+
+void LatencyGovernor::recordFrame(float totalMs, const array<float, CASCADE_STAGE_COUNT>& stageMs) {
+    frames_++;
+    histogram_.record(totalMs);
+
+    const float a = config_.smoothing;
+    smoothedMs_ = (frames_ == 1) ? totalMs : (1.0f - a) * smoothedMs_ + a * totalMs;
+    for (int i = 0; i < CASCADE_STAGE_COUNT; ++i) {
+        if (stageMs[i] > 0.0f) {
+            stageMs_[i] = (stageMs_[i] == 0.0f) ? stageMs[i] : (1.0f - a) * stageMs_[i] + a * stageMs[i];
+        }
+    }
+
+    // Hysteresis: count consecutive frames on either side of the band
+    if (smoothedMs_ > config_.budgetMs) {
+        overCount_++;
+        underCount_ = 0;
+    } else if (smoothedMs_ < config_.budgetMs * config_.relaxRatio) {
+        underCount_++;
+        overCount_ = 0;
+    } else {
+        overCount_ = 0;
+        underCount_ = 0;
+    }
+
+    if (overCount_ >= config_.degradeAfter && level_ < config_.maxLevel) {
+        setLevel(level_ + 1);
+        LOGD("recordFrame: Over budget (%.1fms > %.1fms), level -> %d",
+             smoothedMs_, config_.budgetMs, level_);
+    } else if (underCount_ >= config_.relaxAfter && level_ > 0) {
+        setLevel(level_ - 1);
+        LOGD("recordFrame: Under budget (%.1fms), level -> %d", smoothedMs_, level_);
+    }
+}
+
+void LatencyGovernor::setLevel(int level) {
+    level_ = min(max(level, 0), min(config_.maxLevel, LEVEL_COUNT - 1));
+    settings_ = settingsForLevel(level_, base_);
+    overCount_ = 0;
+    underCount_ = 0;
+}
+
+void LatencyGovernor::setBaseSettings(const PipelineSettings& base) {
+    base_ = base;
+    settings_ = settingsForLevel(level_, base_);
+}
+
+GovernorState LatencyGovernor::state() const {
+    GovernorState s;
+    s.level = level_;
+    s.settings = settings_;
+    s.smoothedMs = smoothedMs_;
+    s.p50Ms = histogram_.percentile(0.50f);
+    s.p95Ms = histogram_.percentile(0.95f);
+    s.p99Ms = histogram_.percentile(0.99f);
+    s.stageMs = stageMs_;
+    s.frames = frames_;
+    s.skipped = skipped_;
+    return s;
+}
+
+void LatencyGovernor::reset() {
+    level_ = 0;
+    settings_ = settingsForLevel(0, base_);
+    smoothedMs_ = 0.0f;
+    stageMs_.fill(0.0f);
+    overCount_ = 0;
+    underCount_ = 0;
+    frames_ = 0;
+    skipped_ = 0;
+    sinceProcessed_ = 0;
+    histogram_.reset();
+}
+
+} // namespace idverify
@@ -0,0 +1,132 @@
+#ifndef LATENCY_GOVERNOR_H
+#define LATENCY_GOVERNOR_H
+
+#include <array>
+#include <cstdint>
+#include "VisionProcessor.h"
+#include "FrameCascade.h"
+
+namespace idverify {
+
+/**
+ * Governor configuration
+ */
+struct GovernorConfig {
+    float budgetMs = 33.0f;        // Target per-frame latency
+    float relaxRatio = 0.6f;       // Step back up when smoothed latency < budget * ratio
+    int degradeAfter = 5;          // Consecutive over-budget frames before degrading
+    int relaxAfter = 30;           // Consecutive under-budget frames before relaxing
+    float smoothing = 0.2f;        // EWMA factor for frame latency
+    int maxLevel = 5;              // Deepest degradation level (0..LEVEL_COUNT-1)
+};
+
+/**
+ * Log-spaced latency histogram (0.25 ms .. ~1 s, factor sqrt(2) per bucket)
+ */
+class LatencyHistogram {
+public:
+    static constexpr int BUCKETS = 24;
+
+    void record(float ms);
+    float percentile(float p) const;   // p in 0-1, bucket upper bound in ms
+    uint64_t count() const { return count_; }
+    void reset();
+
+    static float bucketUpperMs(int bucket);
+
+private:
+    std::array<uint64_t, BUCKETS> buckets_{};
+    uint64_t count_ = 0;
+};
+
+/**
+ * Governor decisions and latency distribution
+ */
+struct GovernorState {
+    int level;                      // 0 = full quality
+    PipelineSettings settings;      // Settings in force at this level
+    float smoothedMs;               // EWMA of frame latency
+    float p50Ms;
+    float p95Ms;
+    float p99Ms;
+    std::array<float, CASCADE_STAGE_COUNT> stageMs;  // EWMA per stage
+    uint64_t frames;                // Frames measured
+    uint64_t skipped;               // Frames skipped by frame skipping
+};
+
+/**
+ * LatencyGovernor - Closed-loop control of pipeline cost
+ *
+ * Measures every processed frame (total and per stage) and walks a fixed
+ * degradation ladder to hold a per-frame budget: detection pyramid level,
+ * tracking instead of full detection, cheaper denoise, then frame skipping.
+ * Steps are taken with hysteresis (N frames over budget to degrade, M frames
+ * comfortably under to relax) so the pipeline does not oscillate.
+ */
+class LatencyGovernor {
+public:
+    explicit LatencyGovernor(const GovernorConfig& config = GovernorConfig());
+
+    /**
+     * Whether the next camera frame should be processed (frame skipping)
+     * Counts the frame as skipped when returning false
+     */
+    bool shouldProcess();
+
+    /**
+     * Settings to use for the frame about to be processed
+     */
+    const PipelineSettings& settings() const { return settings_; }
+
+    /**
+     * Record a processed frame and adjust the level
+     * @param totalMs Frame wall time
+     * @param stageMs Per-stage wall time (0 for stages that did not run)
+     */
+    void recordFrame(float totalMs, const std::array<float, CASCADE_STAGE_COUNT>& stageMs);
+
+    /**
+     * Start from a given level
+     */
+    void setLevel(int level);
+
+    int level() const { return level_; }
+
+    /**
+     * Replace the level-0 settings (e.g. from a device calibration profile)
+     */
+    void setBaseSettings(const PipelineSettings& base);
+
+    /**
+     * Change the per-frame budget (takes effect from the next frame)
+     */
+    void setBudgetMs(float budgetMs) { config_.budgetMs = budgetMs; }
+
+    GovernorState state() const;
+    void reset();
+
+    /**
+     * Settings of one ladder level on top of a base profile
+     */
+    static PipelineSettings settingsForLevel(int level, const PipelineSettings& base = PipelineSettings());
+
+    static constexpr int LEVEL_COUNT = 6;
+
+private:
+    GovernorConfig config_;
+    PipelineSettings base_;
+    PipelineSettings settings_;
+    int level_;
+    float smoothedMs_;
+    std::array<float, CASCADE_STAGE_COUNT> stageMs_;
+    int overCount_;
+    int underCount_;
+    uint64_t frames_;
+    uint64_t skipped_;
+    uint64_t sinceProcessed_;
+    LatencyHistogram histogram_;
+};
+
+} // namespace idverify
+
+#endif // LATENCY_GOVERNOR_H
@@ -0,0 +1,189 @@
+#include "MRZConsensus.h"
+#include "MRZDecoder.h"
+#include "MRZParser.h"
+#include "ROIMapper.h"
+#include <algorithm>
+#include <android/log.h>
+
+#define TAG "MRZConsensus"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
+
+using namespace std;
+
+namespace idverify {
+
+// ==================== Voting ====================
+
+MRZConsensus::MRZConsensus(float decay)
+    : decay_(std::max(0.0f, std::min(1.0f, decay))) {
+    reset();
+}
+
+void MRZConsensus::reset() {
+    for (auto& line : votes_) {
+        for (auto& histogram : line) histogram.fill(0.0f);
+    }
+    seeded_.fill(false);
+    result_.accepted = false;
+    for (string& line : result_.lines) line.assign(MRZ_LINE_LENGTH, '<');
+    result_.frames = 0;
+    result_.score = 0;
+    result_.stability = 0.0f;
+}
+
+void MRZConsensus::decayVotes() {
+    if (decay_ >= 1.0f) return;
+    for (auto& line : votes_) {
+        for (auto& histogram : line) {
+            for (float& v : histogram) v *= decay_;
+        }
+    }
+}
+
+char MRZConsensus::winner(int line, int pos) const {
+    const auto& histogram = votes_[line][pos];
+    const int best = static_cast<int>(max_element(histogram.begin(), histogram.end()) - histogram.begin());
+    return histogram[best] > 0.0f ? OCRWhitelist::MRZ_CHARSET[best] : '<';
+}
+
+bool MRZConsensus::align(int line, const string& text, array<int, 2 * MRZ_LINE_LENGTH>& positions) const {
+    const int n = static_cast<int>(text.size());
+    if (n == 0 || n > 2 * MRZ_LINE_LENGTH) return false;
+
+    // Nothing to align to yet: only a full-length read can seed the line
+    if (!seeded_[line]) {
+        if (n != MRZ_LINE_LENGTH) return false;
+        for (int i = 0; i < n; ++i) positions[i] = i;
+        return true;
+    }
+
+    char consensus[MRZ_LINE_LENGTH];
+    for (int p = 0; p < MRZ_LINE_LENGTH; ++p) consensus[p] = winner(line, p);
+
+    // Edit distance of the read against the current winners
+    int d[2 * MRZ_LINE_LENGTH + 1][MRZ_LINE_LENGTH + 1];
+    for (int i = 0; i <= n; ++i) d[i][0] = i;
+    for (int j = 0; j <= MRZ_LINE_LENGTH; ++j) d[0][j] = j;
+    for (int i = 1; i <= n; ++i) {
+        for (int j = 1; j <= MRZ_LINE_LENGTH; ++j) {
+            const int diagonal = d[i - 1][j - 1] + (text[i - 1] != consensus[j - 1] ? 1 : 0);
+            d[i][j] = std::min(diagonal, std::min(d[i - 1][j], d[i][j - 1]) + 1);
+        }
+    }
+
+    // Mostly different from the consensus: another line or noise, don't vote
+    if (d[n][MRZ_LINE_LENGTH] > MRZ_LINE_LENGTH / 2) return false;
+
+    int i = n, j = MRZ_LINE_LENGTH;
+    while (i > 0) {
+        if (j > 0 && d[i][j] == d[i - 1][j - 1] + (text[i - 1] != consensus[j - 1] ? 1 : 0)) {
+            positions[--i] = --j;
+        } else if (d[i][j] == d[i - 1][j] + 1) {
+            positions[--i] = -1;    // Extra character in the read
+        } else {
+            --j;                    // Character missing from the read
+        }
+    }
+    return true;
+}
+
+const MRZConsensusResult& MRZConsensus::add(const string& line1, const string& line2,
+                                            const string& line3, float confidence) {
+    decayVotes();
+
+    const string* text[MRZ_LINE_COUNT] = { &line1, &line2, &line3 };
+    const float weight = std::max(MIN_WEIGHT, std::min(1.0f, confidence));
+    array<int, 2 * MRZ_LINE_LENGTH> positions;
+    string line;
+    for (int l = 0; l < MRZ_LINE_COUNT; ++l) {
+        line.clear();
+        for (char c : *text[l]) line += MRZDecoder::normalize(c);
+        if (!align(l, line, positions)) continue;
+
+        for (int i = 0; i < static_cast<int>(line.size()); ++i) {
+            const int t = MRZReader::charIndex(line[i]);
+            if (positions[i] >= 0 && t >= 0) votes_[l][positions[i]][t] += weight;
+        }
+        seeded_[l] = true;
+    }
+
+    result_.frames++;
+    evaluate();
+    return result_;
+}
+
+const MRZConsensusResult& MRZConsensus::add(const MRZReadResult& read) {
+    if (!read.found) return result_;
+    decayVotes();
+
+    for (int l = 0; l < MRZ_LINE_COUNT; ++l) {
+        for (int p = 0; p < MRZ_LINE_LENGTH; ++p) {
+            const MRZChar& c = read.chars[l][p];
+            const int t = MRZReader::charIndex(c.candidates[0].c);
+            if (t >= 0) votes_[l][p][t] += std::max(MIN_WEIGHT, c.confidence);
+        }
+        seeded_[l] = true;
+    }
+
+    result_.frames++;
+    evaluate();
+    return result_;
+}
+
+// ==================== Evaluation ====================
+
+void MRZConsensus::evaluate() {
+    // Winners with their vote shares, in the shape MRZDecoder reads
+    MRZReadResult voted;
+    voted.found = true;
+    float shareSum = 0.0f, minShare = 1.0f;
+    array<int, MRZ_ALPHABET_SIZE> order;
+    for (int l = 0; l < MRZ_LINE_COUNT; ++l) {
+        voted.lines[l].assign(MRZ_LINE_LENGTH, '<');
+        for (int p = 0; p < MRZ_LINE_LENGTH; ++p) {
+            const auto& histogram = votes_[l][p];
+            MRZChar& c = voted.chars[l][p];
+            float total = 0.0f;
+            for (float v : histogram) total += v;
+
+            if (total <= 0.0f) {
+                c.candidates.fill({ '<', 0.0f });
+            } else {
+                for (int t = 0; t < MRZ_ALPHABET_SIZE; ++t) order[t] = t;
+                partial_sort(order.begin(), order.begin() + MRZ_CANDIDATES, order.end(),
+                             [&](int a, int b) { return histogram[a] > histogram[b]; });
+                for (int k = 0; k < MRZ_CANDIDATES; ++k) {
+                    c.candidates[k] = { OCRWhitelist::MRZ_CHARSET[order[k]], histogram[order[k]] / total };
+                }
+            }
+            c.confidence = c.candidates[0].score;
+            voted.lines[l][p] = c.candidates[0].c;
+            shareSum += c.confidence;
+            minShare = std::min(minShare, c.confidence);
+        }
+    }
+    voted.meanConfidence = shareSum / (MRZ_LINE_COUNT * MRZ_LINE_LENGTH);
+    voted.minConfidence = minShare;
+    result_.stability = voted.meanConfidence;
+
+    if (!seeded_[0] || !seeded_[1] || !seeded_[2]) {
+        result_.lines = voted.lines;
+        result_.accepted = false;
+        result_.score = 0;
+        return;
+    }
+
+    MRZDecodeResult decoded = MRZDecoder::decode(voted);
+    result_.lines = decoded.valid ? decoded.lines : voted.lines;
+
+    MRZFields fields = MRZParser::parse(result_.lines[0], result_.lines[1], result_.lines[2]);
+    result_.score = fields.score;
+    // Letters in digit fields can pass the 7-3-1 sums (J = 19 = 9 mod 10), so the schema must hold too
+    result_.accepted = decoded.valid && fields.valid;
+    if (result_.accepted) {
+        LOGD("evaluate: Accepted after %d reads (stability %.2f)", result_.frames, result_.stability);
+    }
+}
+
+} // namespace idverify
@@ -0,0 +1,82 @@
+#ifndef MRZ_CONSENSUS_H
+#define MRZ_CONSENSUS_H
+
+#include "MRZReader.h"
+#include <array>
+#include <string>
+
+namespace idverify {
+
+/**
+ * Current vote of an MRZConsensus
+ */
+struct MRZConsensusResult {
+    bool accepted;                                  // Voted MRZ passes all four check digits
+    std::array<std::string, MRZ_LINE_COUNT> lines;  // Voted lines after MRZDecoder
+    int frames;                                     // Reads voted since reset
+    int score;                                      // Check-digit score of the voted lines (0-60)
+    float stability;                                // 0-1: mean vote share of each position's winner
+};
+
+/**
+ * MRZConsensus - Multi-frame voting over MRZ reads
+ *
+ * Every read votes, character by character, into per-position histograms
+ * weighted by recognition confidence, so frames that are each wrong in a
+ * different place still add up to a correct MRZ. Text lines of the wrong
+ * length (dropped or doubled characters) are first aligned to the current
+ * winners by edit distance; native reads are already cut into 30 cells.
+ *
+ * After each read the winners, with their vote shares as scores, go
+ * through MRZDecoder and MRZParser, and the result is accepted as soon
+ * as all four check digits hold. Older votes decay so a misread
+ * that dominated early frames is eventually outvoted.
+ */
+class MRZConsensus {
+public:
+    /**
+     * @param decay Weight kept by earlier votes on each new read (0-1, 1 = never forget)
+     */
+    explicit MRZConsensus(float decay = 0.9f);
+
+    /**
+     * Vote a text read (e.g. from a text recognizer)
+     * @param confidence Weight of every character of this read (0-1)
+     */
+    const MRZConsensusResult& add(const std::string& line1, const std::string& line2,
+                                  const std::string& line3, float confidence = 1.0f);
+
+    /**
+     * Vote a native read, each character weighted by its confidence
+     * Reads with found=false are ignored
+     */
+    const MRZConsensusResult& add(const MRZReadResult& read);
+
+    const MRZConsensusResult& result() const { return result_; }
+
+    void reset();
+
+    // Smallest weight a character votes with, so zero-confidence reads still count
+    static constexpr float MIN_WEIGHT = 0.05f;
+
+private:
+    /**
+     * Consensus position of every text character (-1 = extra character)
+     * @return false if the line is too garbled to align
+     */
+    bool align(int line, const std::string& text, std::array<int, 2 * MRZ_LINE_LENGTH>& positions) const;
+
+    char winner(int line, int pos) const;
+
+    void decayVotes();
+    void evaluate();
+
+    std::array<std::array<std::array<float, MRZ_ALPHABET_SIZE>, MRZ_LINE_LENGTH>, MRZ_LINE_COUNT> votes_;
+    std::array<bool, MRZ_LINE_COUNT> seeded_;     // Line has received votes
+    float decay_;
+    MRZConsensusResult result_;
+};
+
+} // namespace idverify
+
+#endif // MRZ_CONSENSUS_H
@@ -0,0 +1,363 @@
+#include "MRZDecoder.h"
+#include "VisionProcessor.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <android/log.h>
+
+#define TAG "MRZDecoder"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
+
+using namespace std;
+
+namespace idverify {
+
+namespace {
+
+const int WEIGHTS[3] = { 7, 3, 1 };
+const float INF_COST = 1e30f;
+
+/**
+ * Span of the composite check string with its own check digit, if any
+ */
+struct Segment {
+    int line;
+    int begin, end;     // Data positions [begin, end)
+    int check;          // Check digit position, -1 if none
+    int compIndex;      // Index of begin in the composite string
+};
+
+// Composite = line1[5-29] + line2[0-6] + line2[8-14] + line2[18-28]
+const Segment SEGMENTS[] = {
+    { 0, 5, 14, 14, 0 },     // Document number
+    { 0, 15, 30, -1, 10 },   // Optional data 1 (TCKN)
+    { 1, 0, 6, 6, 25 },      // Birth date
+    { 1, 8, 14, 14, 32 },    // Expiry date
+    { 1, 18, 29, -1, 39 },   // Optional data 2
+};
+const int SEGMENT_COUNT = sizeof(SEGMENTS) / sizeof(SEGMENTS[0]);
+const int MAX_SEGMENT = 16;     // Positions incl. check digit
+const int COMPOSITE_LINE = 1;
+const int COMPOSITE_POS = 29;
+
+// DP state: field residue * 10 + composite residue
+const int STATES = 100;
+
+struct Cell {
+    float cost;
+    int8_t option;
+    uint8_t prev;
+};
+
+bool inCheckedSegment(int line, int pos) {
+    if (line == COMPOSITE_LINE && pos == COMPOSITE_POS) return true;
+    for (const Segment& s : SEGMENTS) {
+        if (s.line == line && pos >= s.begin && pos < (s.check >= 0 ? s.check + 1 : s.end)) return true;
+    }
+    return false;
+}
+
+}
+
+// ==================== Schema ====================
+
+char MRZDecoder::normalize(char c) {
+    char upper = static_cast<char>(toupper(static_cast<unsigned char>(c)));
+    if ((upper >= 'A' && upper <= 'Z') || (upper >= '0' && upper <= '9')) return upper;
+    return '<';     // Blanks, dots and anything else read as filler
+}
+
+MRZCharClass MRZDecoder::charClass(int line, int pos) {
+    switch (line) {
+        case 0:
+            if (pos == 0) return MRZCharClass::ALPHA;           // Document code "I<"
+            if (pos == 1) return MRZCharClass::FILLER;
+            if (pos < 5) return MRZCharClass::ALPHA;            // Issuing state
+            if (pos == 5 || pos == 8) return MRZCharClass::ALPHA;   // Serial A99A99999
+            if (pos == 15 || pos >= 27) return MRZCharClass::FILLER;
+            return MRZCharClass::DIGIT;                         // Serial digits, check, TCKN
+        case 1:
+            if (pos <= 6) return MRZCharClass::DIGIT;           // Birth date + check
+            if (pos == 7) return MRZCharClass::SEX;
+            if (pos <= 14) return MRZCharClass::DIGIT;          // Expiry date + check
+            if (pos <= 17) return MRZCharClass::ALPHA;          // Nationality
+            if (pos <= 28) return MRZCharClass::FILLER;         // Optional data
+            return MRZCharClass::DIGIT;                         // Composite check
+        default:
+            return MRZCharClass::ALPHA_FILLER;                  // Names
+    }
+}
+
+bool MRZDecoder::allows(MRZCharClass cls, char c) {
+    const bool digit = c >= '0' && c <= '9';
+    const bool alpha = c >= 'A' && c <= 'Z';
+    switch (cls) {
+        case MRZCharClass::DIGIT: return digit;
+        case MRZCharClass::ALPHA: return alpha;
+        case MRZCharClass::ALPHA_FILLER: return alpha || c == '<';
+        case MRZCharClass::SEX: return c == 'M' || c == 'F' || c == 'X' || c == '<';
+        case MRZCharClass::FILLER: return c == '<';
+    }
+    return false;
+}
+
+const char* MRZDecoder::confusions(char c) {
+    switch (c) {
+        case '0': return "ODQ";
+        case 'O': return "0DQ";
+        case 'D': return "0O";
+        case 'Q': return "0O";
+        case '1': return "IL";
+        case 'I': return "1";
+        case 'L': return "1";
+        case '2': return "Z";
+        case 'Z': return "2";
+        case '4': return "A";
+        case 'A': return "4";
+        case '5': return "S";
+        case 'S': return "5";
+        case '6': return "G";
+        case 'G': return "6";
+        case '7': return "T";
+        case 'T': return "7";
+        case '8': return "B";
+        case 'B': return "8";
+        case '<': return "K";
+        case 'K': return "<";
+        default: return "";
+    }
+}
+
+// ==================== Options ====================
+
+void MRZDecoder::addOption(Slot& slot, char c, float cost) {
+    for (int i = 0; i < slot.count; ++i) {
+        if (slot.options[i].c == c) {
+            if (cost >= slot.options[i].cost) return;
+            // Re-insert below at the lower cost
+            for (int j = i; j + 1 < slot.count; ++j) slot.options[j] = slot.options[j + 1];
+            slot.count--;
+            break;
+        }
+    }
+    if (slot.count == MAX_OPTIONS && cost >= slot.options[MAX_OPTIONS - 1].cost) return;
+
+    // Keep options sorted by cost
+    int i = std::min(slot.count, MAX_OPTIONS - 1);
+    while (i > 0 && slot.options[i - 1].cost > cost) {
+        slot.options[i] = slot.options[i - 1];
+        i--;
+    }
+    slot.options[i] = { c, cost };
+    slot.count = std::min(slot.count + 1, MAX_OPTIONS);
+}
+
+void MRZDecoder::fillFromText(Slot& slot, MRZCharClass cls, char read) {
+    slot.count = 0;
+    slot.read = read;
+    const bool fits = allows(cls, read);
+    if (fits) addOption(slot, read, 0.0f);
+    for (const char* a = confusions(read); *a != '\0'; ++a) {
+        if (allows(cls, *a)) addOption(slot, *a, fits ? SUBSTITUTION_COST : REPAIR_COST);
+    }
+    // A filler position can only hold '<', whatever was read there
+    if (cls == MRZCharClass::FILLER && !fits) addOption(slot, '<', REPAIR_COST);
+}
+
+// ==================== Decoding ====================
+
+MRZDecodeResult MRZDecoder::decode(const string& line1, const string& line2, const string& line3) {
+    const string* text[MRZ_LINE_COUNT] = { &line1, &line2, &line3 };
+    Slots slots;
+    for (int l = 0; l < MRZ_LINE_COUNT; ++l) {
+        for (int p = 0; p < MRZ_LINE_LENGTH; ++p) {
+            char c = p < static_cast<int>(text[l]->size()) ? normalize((*text[l])[p]) : '<';
+            fillFromText(slots[l][p], charClass(l, p), c);
+        }
+    }
+    return solve(slots);
+}
+
+string MRZDecoder::correctLine(const string& line, int lineIndex) {
+    string corrected(MRZ_LINE_LENGTH, '<');
+    Slot slot;
+    for (int p = 0; p < MRZ_LINE_LENGTH; ++p) {
+        char c = p < static_cast<int>(line.size()) ? normalize(line[p]) : '<';
+        fillFromText(slot, charClass(lineIndex, p), c);
+        corrected[p] = slot.count > 0 ? slot.options[0].c : c;
+    }
+    return corrected;
+}
+
+MRZDecodeResult MRZDecoder::decode(const MRZReadResult& read) {
+    if (!read.found) {
+        return decode(string(), string(), string());
+    }
+
+    Slots slots;
+    for (int l = 0; l < MRZ_LINE_COUNT; ++l) {
+        for (int p = 0; p < MRZ_LINE_LENGTH; ++p) {
+            const MRZChar& ch = read.chars[l][p];
+            const MRZCharClass cls = charClass(l, p);
+            Slot& slot = slots[l][p];
+            fillFromText(slot, cls, ch.candidates[0].c);
+
+            // Runner-up matches, priced by how far they trail the best one
+            const float best = ch.candidates[0].score;
+            for (int k = 1; k < MRZ_CANDIDATES; ++k) {
+                const MRZCandidate& cand = ch.candidates[k];
+                if (!allows(cls, cand.c)) continue;
+                const float gap = std::max(0.0f, best - cand.score) / READER_GAP;
+                addOption(slot, cand.c, std::min(2.0f * SUBSTITUTION_COST, gap));
+            }
+        }
+    }
+    return solve(slots);
+}
+
+MRZDecodeResult MRZDecoder::solve(Slots& slots) {
+    MRZDecodeResult result;
+    result.valid = false;
+    result.cost = 0.0f;
+    result.edits = 0;
+
+    // Unchecked positions (and the fallback) take their cheapest option
+    for (int l = 0; l < MRZ_LINE_COUNT; ++l) {
+        result.lines[l].assign(MRZ_LINE_LENGTH, '<');
+        for (int p = 0; p < MRZ_LINE_LENGTH; ++p) {
+            const Slot& slot = slots[l][p];
+            result.lines[l][p] = slot.count > 0 ? slot.options[0].c : slot.read;
+            if (!inCheckedSegment(l, p) && slot.count > 0) result.cost += slot.options[0].cost;
+        }
+    }
+    const float uncheckedCost = result.cost;
+
+    // Per segment: cheapest assignment for every composite residue
+    float segCost[SEGMENT_COUNT][10];
+    static thread_local Cell table[SEGMENT_COUNT][MAX_SEGMENT + 1][STATES];
+    for (int s = 0; s < SEGMENT_COUNT; ++s) {
+        const Segment& seg = SEGMENTS[s];
+        const int dataLength = seg.end - seg.begin;
+        const int length = dataLength + (seg.check >= 0 ? 1 : 0);
+        Cell (*layers)[STATES] = table[s];
+
+        for (int k = 0; k <= length; ++k) {
+            for (int st = 0; st < STATES; ++st) layers[k][st] = { INF_COST, -1, 0 };
+        }
+        layers[0][0].cost = 0.0f;
+
+        for (int k = 0; k < length; ++k) {
+            const bool isCheck = k == dataLength;
+            const int pos = seg.begin + k;
+            const Slot& slot = slots[seg.line][pos];
+            const int compWeight = WEIGHTS[(seg.compIndex + k) % 3];
+            const int ownWeight = seg.check >= 0 ? WEIGHTS[k % 3] : 0;
+
+            for (int st = 0; st < STATES; ++st) {
+                const Cell& from = layers[k][st];
+                if (from.cost >= INF_COST) continue;
+                const int own = st / 10, comp = st % 10;
+                for (int o = 0; o < slot.count; ++o) {
+                    const int v = MRZValidator::charToValue(slot.options[o].c);
+                    int next;
+                    if (isCheck) {
+                        if (v != own) continue;
+                        next = (comp + v * compWeight) % 10;
+                    } else {
+                        next = ((own + v * ownWeight) % 10) * 10 + (comp + v * compWeight) % 10;
+                    }
+                    const float cost = from.cost + slot.options[o].cost;
+                    Cell& to = layers[k + 1][next];
+                    if (cost < to.cost) {
+                        to = { cost, static_cast<int8_t>(o), static_cast<uint8_t>(st) };
+                    }
+                }
+            }
+        }
+        // Checked segments end with own residue 0; unchecked ones never track it
+        for (int r = 0; r < 10; ++r) segCost[s][r] = layers[length][r].cost;
+    }
+
+    // Join segments on the composite residue
+    float joint[SEGMENT_COUNT + 1][10];
+    uint8_t pick[SEGMENT_COUNT + 1][10] = {};
+    for (int r = 0; r < 10; ++r) joint[0][r] = r == 0 ? 0.0f : INF_COST;
+    for (int s = 0; s < SEGMENT_COUNT; ++s) {
+        for (int r = 0; r < 10; ++r) joint[s + 1][r] = INF_COST;
+        for (int r = 0; r < 10; ++r) {
+            if (joint[s][r] >= INF_COST) continue;
+            for (int q = 0; q < 10; ++q) {
+                if (segCost[s][q] >= INF_COST) continue;
+                const float cost = joint[s][r] + segCost[s][q];
+                const int next = (r + q) % 10;
+                if (cost < joint[s + 1][next]) {
+                    joint[s + 1][next] = cost;
+                    pick[s + 1][next] = static_cast<uint8_t>(q);
+                }
+            }
+        }
+    }
+
+    // Composite check digit must equal the total residue
+    const Slot& compositeSlot = slots[COMPOSITE_LINE][COMPOSITE_POS];
+    float bestCost = INF_COST;
+    int bestOption = -1;
+    for (int o = 0; o < compositeSlot.count; ++o) {
+        const int v = MRZValidator::charToValue(compositeSlot.options[o].c);
+        const float cost = joint[SEGMENT_COUNT][v] + compositeSlot.options[o].cost;
+        if (joint[SEGMENT_COUNT][v] < INF_COST && cost < bestCost) {
+            bestCost = cost;
+            bestOption = o;
+        }
+    }
+
+    auto backtrack = [&](int s, int residue) {
+        const Segment& seg = SEGMENTS[s];
+        const int length = (seg.end - seg.begin) + (seg.check >= 0 ? 1 : 0);
+        int st = residue;
+        for (int k = length; k > 0; --k) {
+            const Cell& cell = table[s][k][st];
+            result.lines[seg.line][seg.begin + k - 1] = slots[seg.line][seg.begin + k - 1].options[cell.option].c;
+            st = cell.prev;
+        }
+    };
+
+    if (bestOption >= 0) {
+        result.valid = true;
+        result.cost = uncheckedCost + bestCost;
+        result.lines[COMPOSITE_LINE][COMPOSITE_POS] = compositeSlot.options[bestOption].c;
+
+        int residue = MRZValidator::charToValue(compositeSlot.options[bestOption].c);
+        for (int s = SEGMENT_COUNT - 1; s >= 0; --s) {
+            const int q = pick[s + 1][residue];
+            residue = (residue - q + 10) % 10;
+            backtrack(s, q);
+        }
+    } else {
+        // No reading passes all four: still satisfy each field's own check where possible
+        result.cost = uncheckedCost + (compositeSlot.count > 0 ? compositeSlot.options[0].cost : 0.0f);
+        for (int s = 0; s < SEGMENT_COUNT; ++s) {
+            const int best = static_cast<int>(min_element(segCost[s], segCost[s] + 10) - segCost[s]);
+            if (segCost[s][best] < INF_COST) {
+                result.cost += segCost[s][best];
+                backtrack(s, best);
+                continue;
+            }
+            const Segment& seg = SEGMENTS[s];
+            for (int p = seg.begin; p < (seg.check >= 0 ? seg.check + 1 : seg.end); ++p) {
+                const Slot& slot = slots[seg.line][p];
+                if (slot.count > 0) result.cost += slot.options[0].cost;
+            }
+        }
+    }
+
+    for (int l = 0; l < MRZ_LINE_COUNT; ++l) {
+        for (int p = 0; p < MRZ_LINE_LENGTH; ++p) {
+            if (result.lines[l][p] != slots[l][p].read) result.edits++;
+        }
+    }
+    return result;
+}
+
+} // namespace idverify
@@ -0,0 +1,123 @@
+#ifndef MRZ_DECODER_H
+#define MRZ_DECODER_H
+
+#include "MRZReader.h"
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace idverify {
+
+/**
+ * Characters a TD1 position may hold (ICAO 9303 part 5, TCKK layout)
+ */
+enum class MRZCharClass : uint8_t {
+    DIGIT = 0,          // Dates, TCKN and check digits
+    ALPHA = 1,          // Codes, serial letters
+    ALPHA_FILLER = 2,   // Names: A-Z or '<'
+    SEX = 3,            // M, F, X or '<'
+    FILLER = 4          // Fixed and unused positions: '<' only
+};
+
+/**
+ * Best checksum-consistent reading of a TD1 MRZ
+ */
+struct MRZDecodeResult {
+    bool valid;                                     // All four check digits hold
+    std::array<std::string, MRZ_LINE_COUNT> lines;  // Valid MRZ, or per-field best guess if !valid
+    float cost;                                     // Sum of substitution costs (0 = taken as read)
+    int edits;                                      // Characters changed from the read
+};
+
+/**
+ * MRZDecoder - Checksum-constrained decoding of TD1 reads
+ *
+ * The schema follows the TCKK: serial A99A99999 as document number, the
+ * TCKN at line 1 positions 16-26 and blank optional data elsewhere.
+ * Every position gets a short list of options: the character as read if
+ * its field allows it, plus its OCR-B confusion set (O/0, I/1, S/5, B/8,
+ * ...) filtered by the field's class. Keeping a character is free and a
+ * confusion swap costs SUBSTITUTION_COST, but a character the field cannot
+ * hold (a digit in a name, a letter in a date) is repaired for only
+ * REPAIR_COST. Reader matches add their runner-up candidates, priced by
+ * their score gap to the best match.
+ *
+ * Positions outside the check-digit fields take their cheapest option.
+ * The five composite segments are solved exactly by dynamic programming
+ * over (field residue, composite residue) mod 10, and then joined on the
+ * composite check digit, so the result is the cheapest assignment that
+ * passes all four 7-3-1 checks.
+ */
+class MRZDecoder {
+public:
+    /**
+     * Decode text lines (e.g. from a text recognizer)
+     * Lines are upper-cased, blanks and dots read as '<', and padded/cut to 30
+     */
+    static MRZDecodeResult decode(const std::string& line1, const std::string& line2, const std::string& line3);
+
+    /**
+     * Decode a native read, using each character's ranked template matches
+     */
+    static MRZDecodeResult decode(const MRZReadResult& read);
+
+    /**
+     * Cheapest class-valid option per position of one line (no checksum search)
+     * @param lineIndex 0-2
+     */
+    static std::string correctLine(const std::string& line, int lineIndex);
+
+    /**
+     * Upper-case MRZ character; blanks, dots and anything else become '<'
+     */
+    static char normalize(char c);
+
+    /**
+     * Field class of a TD1 position
+     */
+    static MRZCharClass charClass(int line, int pos);
+
+    /**
+     * True if the class admits the character
+     */
+    static bool allows(MRZCharClass cls, char c);
+
+    /**
+     * OCR-B look-alikes of a character ("" if none)
+     */
+    static const char* confusions(char c);
+
+    // Cost of swapping a character the field allows for a look-alike
+    static constexpr float SUBSTITUTION_COST = 1.0f;
+
+    // Cost of replacing a character the field cannot hold by a look-alike
+    static constexpr float REPAIR_COST = 0.25f;
+
+    // Reader score gap priced at one substitution (MRZReader's confidence margin)
+    static constexpr float READER_GAP = 0.15f;
+
+    // Options kept per position
+    static constexpr int MAX_OPTIONS = 6;
+
+private:
+    struct Option {
+        char c;
+        float cost;
+    };
+
+    struct Slot {
+        Option options[MAX_OPTIONS];
+        int count;
+        char read;      // Character as read, after normalization
+    };
+
+    using Slots = std::array<std::array<Slot, MRZ_LINE_LENGTH>, MRZ_LINE_COUNT>;
+
+    static void addOption(Slot& slot, char c, float cost);
+    static void fillFromText(Slot& slot, MRZCharClass cls, char read);
+    static MRZDecodeResult solve(Slots& slots);
+};
+
+} // namespace idverify
+
+#endif // MRZ_DECODER_H
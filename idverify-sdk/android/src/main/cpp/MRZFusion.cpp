@@ -0,0 +1,146 @@
+#include "MRZFusion.h"
+#include "VisionProcessor.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+#include <android/log.h>
+
+#define TAG "MRZFusion"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
+
+using namespace cv;
+using namespace std;
+
+namespace idverify {
+
+MRZFusion::MRZFusion(int capacity, bool upsample)
+    : capacity_(max(1, capacity)), upsample_(upsample) {}
+
+void MRZFusion::addFrame(const Mat& mrzCrop) {
+    if (mrzCrop.empty()) {
+        return;
+    }
+
+    Entry entry;
+    if (mrzCrop.channels() == 3 || mrzCrop.channels() == 4) {
+        cvtColor(mrzCrop, entry.gray, mrzCrop.channels() == 4 ? COLOR_BGRA2GRAY : COLOR_BGR2GRAY);
+    } else {
+        entry.gray = mrzCrop.clone();
+    }
+
+    // All crops are registered on the first crop's grid
+    if (!frames_.empty() && entry.gray.size() != frames_.front().gray.size()) {
+        resize(entry.gray, entry.gray, frames_.front().gray.size(), 0, 0, INTER_AREA);
+    }
+
+    // Sharpness picks the reference frame; computed once here, not per fuse()
+    Mat lap;
+    Laplacian(entry.gray, lap, CV_16S);
+    Scalar mean, stddev;
+    meanStdDev(lap, mean, stddev);
+    entry.sharpness = stddev[0] * stddev[0];
+
+    frames_.push_back(std::move(entry));
+    while (static_cast<int>(frames_.size()) > capacity_) {
+        frames_.pop_front();
+    }
+}
+
+FusionResult MRZFusion::fuse() const {
+    FusionResult result;
+    result.framesUsed = 0;
+    result.scale = upsample_ ? 2 : 1;
+    result.meanResponse = 0.0f;
+    result.valid = false;
+
+    if (frames_.empty()) {
+        return result;
+    }
+
+    // Reference = sharpest buffered crop
+    size_t refIndex = 0;
+    for (size_t i = 1; i < frames_.size(); ++i) {
+        if (frames_[i].sharpness > frames_[refIndex].sharpness) refIndex = i;
+    }
+
+    const Size srcSize = frames_[refIndex].gray.size();
+    const int s = result.scale;
+    const Size dstSize(srcSize.width * s, srcSize.height * s);
+
+    Mat refF;
+    frames_[refIndex].gray.convertTo(refF, CV_32F);
+    Mat window;
+    createHanningWindow(window, srcSize, CV_32F);
+
+    Mat accum = Mat::zeros(dstSize, CV_32F);
+    Mat weightSum = Mat::zeros(dstSize, CV_32F);
+    Mat frameF, warped, valid;
+    double responseSum = 0.0;
+    int registered = 0;
+
+    for (size_t i = 0; i < frames_.size(); ++i) {
+        frames_[i].gray.convertTo(frameF, CV_32F);
+
+        // Sub-pixel shift of this frame relative to the reference
+        double response = 1.0;
+        Point2d shift(0.0, 0.0);
+        if (i != refIndex) {
+            shift = phaseCorrelate(refF, frameF, window, &response);
+            if (response < MIN_RESPONSE ||
+                std::abs(shift.x) > MAX_SHIFT || std::abs(shift.y) > MAX_SHIFT) {
+                LOGD("fuse: Skip frame %zu (response=%.3f, shift=%.2f,%.2f)",
+                     i, response, shift.x, shift.y);
+                continue;
+            }
+        }
+
+        // Undo shift and upsample in a single warp (pixel-center aligned)
+        const double offset = (s - 1) * 0.5;
+        Mat M = (Mat_<double>(2, 3) << s, 0, -shift.x * s + offset,
+                                       0, s, -shift.y * s + offset);
+        warpAffine(frameF, warped, M, dstSize, INTER_CUBIC, BORDER_REPLICATE);
+
+        // Registered frames count equally; glare pixels carry no weight
+        threshold(warped, valid, GLARE_LEVEL, 1.0, THRESH_BINARY_INV);
+        accumulateProduct(warped, valid, accum);
+        weightSum += valid;
+
+        if (i != refIndex) {
+            responseSum += response;
+            registered++;
+        }
+        result.framesUsed++;
+    }
+
+    if (result.framesUsed == 0) {
+        return result;
+    }
+
+    // Pixels that were glare in every frame fall back to the reference
+    Mat refUp;
+    const double offset = (s - 1) * 0.5;
+    Mat S = (Mat_<double>(2, 3) << s, 0, offset, 0, s, offset);
+    warpAffine(refF, refUp, S, dstSize, INTER_CUBIC, BORDER_REPLICATE);
+
+    Mat empty = weightSum < 1e-6f;
+    weightSum.setTo(1.0f, empty);
+    divide(accum, weightSum, accum);
+    refUp.copyTo(accum, empty);
+
+    accum.convertTo(result.fused, CV_8U);
+    result.binarized = VisionProcessor::binarizeMRZ(result.fused, s);
+    result.meanResponse = registered > 0 ? static_cast<float>(responseSum / registered) : 1.0f;
+    result.valid = true;
+
+    LOGD("fuse: %d/%zu frames, scale=%d, response=%.3f",
+         result.framesUsed, frames_.size(), s, result.meanResponse);
+
+    return result;
+}
+
+void MRZFusion::reset() {
+    frames_.clear();
+}
+
+} // namespace idverify
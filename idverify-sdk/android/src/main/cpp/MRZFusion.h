@@ -0,0 +1,81 @@
+#ifndef MRZ_FUSION_H
+#define MRZ_FUSION_H
+
+#include <opencv2/core.hpp>
+#include <deque>
+
+namespace idverify {
+
+/**
+ * Multi-frame MRZ fusion result
+ */
+struct FusionResult {
+    cv::Mat fused;          // Fused grayscale MRZ (2x size if upsampled)
+    cv::Mat binarized;      // fused after MRZ binarization
+    int framesUsed;         // Frames that registered against the reference
+    int scale;              // 1 or 2 (upsampling factor)
+    float meanResponse;     // Mean phase correlation peak of registered frames (0-1)
+    bool valid;             // True if at least one frame was fused
+};
+
+/**
+ * MRZFusion - Shift-and-add super-resolution over the last N MRZ crops
+ *
+ * Each warped frame gives an MRZ character only ~25x35 px. Crops from
+ * successive frames are registered to the sharpest one with sub-pixel
+ * phase correlation, optionally upsampled 2x in the same warp, and
+ * averaged with saturated (glare) pixels masked out. The fused image has
+ * higher SNR than any single frame and is binarized once.
+ */
+class MRZFusion {
+public:
+    /**
+     * @param capacity Number of recent MRZ crops to keep (N)
+     * @param upsample True to fuse onto a 2x grid
+     */
+    explicit MRZFusion(int capacity = 5, bool upsample = true);
+
+    /**
+     * Add an unbinarized MRZ crop (e.g. cropROI(warped, BackROI::MRZ))
+     * Oldest crop is dropped when capacity is reached
+     * @param mrzCrop Grayscale or color crop
+     */
+    void addFrame(const cv::Mat& mrzCrop);
+
+    /**
+     * Register and fuse all buffered crops
+     * @return FusionResult (valid=false if buffer is empty)
+     */
+    FusionResult fuse() const;
+
+    /**
+     * Drop all buffered crops
+     */
+    void reset();
+
+    int size() const { return static_cast<int>(frames_.size()); }
+    int capacity() const { return capacity_; }
+
+private:
+    struct Entry {
+        cv::Mat gray;      // CV_8UC1 crop
+        double sharpness;  // Laplacian variance, computed once on add
+    };
+
+    // Frames whose correlation peak is weaker than this are not fused
+    static constexpr double MIN_RESPONSE = 0.05;
+
+    // Frames shifted further than this (px) are treated as misregistered
+    static constexpr double MAX_SHIFT = 12.0;
+
+    // Pixels at or above this level are treated as glare and excluded
+    static constexpr float GLARE_LEVEL = 250.0f;
+
+    int capacity_;
+    bool upsample_;
+    std::deque<Entry> frames_;
+};
+
+} // namespace idverify
+
+#endif // MRZ_FUSION_H
@@ -0,0 +1,254 @@
+#include "MRZLocator.h"
+#include "ROIMapper.h"
+#include "Trace.h"
+#include "VisionProcessor.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+#include <android/log.h>
+
+#define TAG "MRZLocator"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
+
+using namespace cv;
+using namespace std;
+
+namespace idverify {
+
+namespace {
+
+// Blackhat responses below this are paper texture, whatever Otsu says
+const double MIN_INK_LEVEL = 16.0;
+
+// Skew search: coarse sweep, then a fine one around the best coarse angle
+const float COARSE_STEP = 0.5f;
+const float FINE_STEP = 0.1f;
+
+double toRadians(float degrees) {
+    return degrees * CV_PI / 180.0;
+}
+
+}
+
+// ==================== Ink and Skew ====================
+
+Mat MRZLocator::inkMask(const Mat& gray, int scale) {
+    scale = std::max(1, scale);
+
+    // Dark strokes thinner than the kernel in either direction; print and shading are wider
+    Mat kernel = getStructuringElement(MORPH_RECT, Size(15 * scale, 7 * scale));
+    Mat blackhat;
+    morphologyEx(gray, blackhat, MORPH_BLACKHAT, kernel);
+
+    Mat mask;
+    double level = threshold(blackhat, mask, 0, 255, THRESH_BINARY | THRESH_OTSU);
+    if (level < MIN_INK_LEVEL) {
+        threshold(blackhat, mask, MIN_INK_LEVEL, 255, THRESH_BINARY);
+    }
+    return mask;
+}
+
+double MRZLocator::projectionVariance(const vector<Point>& ink, int rows, int cols, float degrees) {
+    const double t = tan(toRadians(degrees));
+    const double cx = cols * 0.5;
+    const int pad = static_cast<int>(ceil(cx * fabs(t))) + 1;
+
+    vector<int> hist(rows + 2 * pad, 0);
+    for (const Point& p : ink) {
+        int r = cvRound(p.y - (p.x - cx) * t) + pad;
+        if (r >= 0 && r < static_cast<int>(hist.size())) hist[r]++;
+    }
+
+    // Ink total is fixed, so the sum of squares ranks angles like the variance
+    double sum = 0.0;
+    for (int h : hist) sum += static_cast<double>(h) * h;
+    return sum;
+}
+
+float MRZLocator::estimateSkew(const Mat& mask, float maxDegrees) {
+    vector<Point> ink;
+    findNonZero(mask, ink);
+    if (ink.size() < 16) return 0.0f;
+
+    float best = 0.0f;
+    double bestScore = projectionVariance(ink, mask.rows, mask.cols, 0.0f);
+    for (float a = -maxDegrees; a <= maxDegrees + 1e-3f; a += COARSE_STEP) {
+        double score = projectionVariance(ink, mask.rows, mask.cols, a);
+        if (score > bestScore) {
+            bestScore = score;
+            best = a;
+        }
+    }
+
+    const float center = best;
+    for (float a = center - COARSE_STEP + FINE_STEP; a < center + COARSE_STEP - 1e-3f; a += FINE_STEP) {
+        if (fabs(a) > maxDegrees) continue;
+        double score = projectionVariance(ink, mask.rows, mask.cols, a);
+        if (score > bestScore) {
+            bestScore = score;
+            best = a;
+        }
+    }
+    return best;
+}
+
+// ==================== Lines ====================
+
+bool MRZLocator::findLines(const Mat& mask, int scale, array<Rect, MRZ_LINE_COUNT>& boxes) {
+    // Side margins hold card edges, never MRZ text
+    const int margin = mask.cols / 50;
+    const int width = mask.cols - 2 * margin;
+    Mat rowSum;
+    reduce(mask.colRange(margin, mask.cols - margin), rowSum, 1, REDUCE_SUM, CV_32S);
+    const int rows = mask.rows;
+
+    // Near-solid rows are edges or print bars, not text
+    const int solid = static_cast<int>(0.85f * width);
+    vector<int> profile(rows);
+    int peak = 0;
+    for (int y = 0; y < rows; ++y) {
+        int v = rowSum.at<int>(y) / 255;
+        profile[y] = v > solid ? 0 : v;
+        peak = std::max(peak, profile[y]);
+    }
+    if (peak == 0) return false;
+
+    // Core rows above 25% of the peak, extended down to 5% (cap tops and baselines carry little ink)
+    const int high = std::max(static_cast<int>(0.25f * peak), static_cast<int>(0.03f * width));
+    const int low = std::max(1, static_cast<int>(0.05f * peak));
+    const int minHeight = std::max(4, rows / 14);
+
+    struct Run { int top, bottom; long mass; };
+    vector<Run> runs;
+    for (int y = 0; y < rows; ) {
+        if (profile[y] < high) { y++; continue; }
+        int top = y, bottom = y;
+        while (bottom + 1 < rows && (profile[bottom + 1] >= high ||
+               (bottom + 1 + scale < rows && profile[bottom + 1 + scale] >= high))) {
+            bottom++;
+        }
+        y = bottom + 1;
+        while (top > 0 && profile[top - 1] >= low) top--;
+        while (bottom + 1 < rows && profile[bottom + 1] >= low) bottom++;
+
+        if (!runs.empty() && top <= runs.back().bottom) {
+            runs.back().bottom = std::max(runs.back().bottom, bottom);
+        } else {
+            runs.push_back({ top, bottom, 0 });
+        }
+    }
+
+    for (Run& r : runs) {
+        for (int y = r.top; y <= r.bottom; ++y) r.mass += profile[y];
+    }
+    runs.erase(remove_if(runs.begin(), runs.end(),
+                         [&](const Run& r) { return r.bottom - r.top + 1 < minHeight; }), runs.end());
+    if (runs.size() < MRZ_LINE_COUNT) return false;
+
+    // The three heaviest rows of text, top to bottom
+    partial_sort(runs.begin(), runs.begin() + MRZ_LINE_COUNT, runs.end(),
+                 [](const Run& a, const Run& b) { return a.mass > b.mass; });
+    runs.resize(MRZ_LINE_COUNT);
+    sort(runs.begin(), runs.end(), [](const Run& a, const Run& b) { return a.top < b.top; });
+
+    // Horizontal ink span of each line, ignoring specks at either end
+    for (int i = 0; i < MRZ_LINE_COUNT; ++i) {
+        const Rect rowsRect(margin, runs[i].top, width, runs[i].bottom - runs[i].top + 1);
+        Mat colSum;
+        reduce(mask(rowsRect), colSum, 0, REDUCE_SUM, CV_32S);
+        const int* col = colSum.ptr<int>();
+
+        long total = 0;
+        for (int x = 0; x < width; ++x) total += col[x];
+        long cum = 0;
+        int first = 0, last = width - 1;
+        for (int x = 0; x < width; ++x) {
+            cum += col[x];
+            if (cum > total / 500) { first = x; break; }
+        }
+        cum = 0;
+        for (int x = width - 1; x >= 0; --x) {
+            cum += col[x];
+            if (cum > total / 500) { last = x; break; }
+        }
+        if (last <= first) return false;
+        boxes[i] = Rect(margin + first, rowsRect.y, last - first + 1, rowsRect.height);
+    }
+    return true;
+}
+
+void MRZLocator::nominalLines(Size band, array<Rect, MRZ_LINE_COUNT>& boxes) {
+    const ROIRegion nominal[MRZ_LINE_COUNT] = { BackROI::MRZ_LINE1, BackROI::MRZ_LINE2, BackROI::MRZ_LINE3 };
+    const Rect bounds(0, 0, band.width, band.height);
+    for (int i = 0; i < MRZ_LINE_COUNT; ++i) {
+        const float y = (nominal[i].y - BackROI::MRZ.y) / BackROI::MRZ.height;
+        const float h = nominal[i].height / BackROI::MRZ.height;
+        boxes[i] = Rect(cvRound(nominal[i].x * band.width), cvRound(y * band.height),
+                        cvRound(nominal[i].width * band.width), std::max(1, cvRound(h * band.height))) & bounds;
+    }
+}
+
+// ==================== Locate ====================
+
+MRZLineLayout MRZLocator::locate(const Mat& band, int scale, bool cropLines) {
+    TraceSpan span("locateMRZLines");
+    scale = std::max(1, scale);
+
+    MRZLineLayout layout;
+    layout.found = false;
+    layout.skewDegrees = 0.0f;
+    if (band.empty()) {
+        LOGE("locate: Empty band");
+        return layout;
+    }
+
+    Mat gray;
+    if (band.channels() == 3 || band.channels() == 4) {
+        cvtColor(band, gray, band.channels() == 4 ? COLOR_BGRA2GRAY : COLOR_BGR2GRAY);
+    } else {
+        gray = band;
+    }
+
+    Mat mask = inkMask(gray, scale);
+    layout.skewDegrees = estimateSkew(mask);
+
+    if (fabs(layout.skewDegrees) >= MIN_DESKEW_DEGREES) {
+        Mat rotation = getRotationMatrix2D(Point2f(gray.cols * 0.5f, gray.rows * 0.5f), layout.skewDegrees, 1.0);
+        warpAffine(gray, layout.deskewed, rotation, gray.size(), INTER_LINEAR, BORDER_REPLICATE);
+        Mat level;
+        warpAffine(mask, level, rotation, mask.size(), INTER_NEAREST, BORDER_CONSTANT, Scalar(0));
+        mask = level;
+    } else {
+        layout.deskewed = gray;
+    }
+
+    layout.found = findLines(mask, scale, layout.boxes);
+    if (!layout.found) {
+        LOGD("locate: No 3 lines in %dx%d band, using nominal positions", band.cols, band.rows);
+        nominalLines(gray.size(), layout.boxes);
+    }
+
+    if (!cropLines) return layout;
+
+    const Rect bounds(0, 0, layout.deskewed.cols, layout.deskewed.rows);
+    const int height = LINE_HEIGHT * scale;
+    for (int i = 0; i < MRZ_LINE_COUNT; ++i) {
+        const Rect& box = layout.boxes[i];
+        const int padY = std::max(2 * scale, box.height / 5);
+        const int padX = box.height / 2;
+        Rect crop = Rect(box.x - padX, box.y - padY, box.width + 2 * padX, box.height + 2 * padY) & bounds;
+        if (crop.area() == 0) continue;
+
+        const int width = std::max(1, cvRound(crop.width * static_cast<double>(height) / crop.height));
+        resize(layout.deskewed(crop), layout.lines[i], Size(width, height), 0, 0,
+               crop.height > height ? INTER_AREA : INTER_LINEAR);
+    }
+    return layout;
+}
+
+MRZLineLayout MRZLocator::locateInCard(const Mat& warpedCard) {
+    return locate(VisionProcessor::cropROI(warpedCard, BackROI::MRZ), 1, true);
+}
+
+} // namespace idverify
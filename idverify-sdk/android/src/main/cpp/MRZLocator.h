@@ -0,0 +1,94 @@
+#ifndef MRZ_LOCATOR_H
+#define MRZ_LOCATOR_H
+
+#include "MRZReader.h"
+#include <opencv2/core.hpp>
+#include <array>
+
+namespace idverify {
+
+/**
+ * Three MRZ text lines found in a band
+ */
+struct MRZLineLayout {
+    bool found;                                     // Lines located by projection (false = nominal MRZ_LINE1..3)
+    float skewDegrees;                              // Estimated text skew, removed in deskewed
+    cv::Mat deskewed;                               // Grayscale band rotated level
+    std::array<cv::Rect, MRZ_LINE_COUNT> boxes;     // Tight text boxes in deskewed pixels
+    std::array<cv::Mat, MRZ_LINE_COUNT> lines;      // Height-normalized grayscale line crops
+};
+
+/**
+ * MRZLocator - Projection-profile line localization for the TD1 MRZ
+ *
+ * A blackhat filter keeps dark strokes smaller than a character and drops
+ * the card's background print and shading. The skew of the resulting ink
+ * mask is the angle whose sheared row projection has the highest variance
+ * (text rows collapse into sharp peaks only when level); the band is
+ * rotated by it, and the three text lines are the heaviest runs of the
+ * level row profile.
+ *
+ * Each line is cropped tight with a small margin and resized to
+ * LINE_HEIGHT * scale rows, so OCR gets three small inputs of uniform
+ * text height instead of one fixed band, and they can run in parallel.
+ * When fewer than three lines are found the nominal BackROI::MRZ_LINE1..3
+ * positions are returned with found = false.
+ */
+class MRZLocator {
+public:
+    /**
+     * Locate the three lines of an MRZ band
+     * @param band Grayscale or color band (e.g. cropROI(BackROI::MRZ) or a fused MRZ)
+     * @param scale Resolution factor vs. the 856x540 card (2 for a 2x fused band)
+     * @param cropLines False to skip the per-line crops (boxes and deskewed only)
+     */
+    static MRZLineLayout locate(const cv::Mat& band, int scale = 1, bool cropLines = true);
+
+    /**
+     * Locate the MRZ lines of a warped card (BackROI::MRZ band)
+     * @param warpedCard 856x540 warped back side
+     */
+    static MRZLineLayout locateInCard(const cv::Mat& warpedCard);
+
+    /**
+     * Ink mask of dark text: blackhat response above its Otsu level
+     * @return CV_8UC1 mask, 255 = ink
+     */
+    static cv::Mat inkMask(const cv::Mat& gray, int scale = 1);
+
+    /**
+     * Skew of the text rows in an ink mask (degrees, positive = falling to the right)
+     * @param maxDegrees Search range +/-
+     */
+    static float estimateSkew(const cv::Mat& mask, float maxDegrees = MAX_SKEW_DEGREES);
+
+    // Normalized line crop height at scale 1 (about one OCR-B cap height plus margins)
+    static constexpr int LINE_HEIGHT = 32;
+
+    // Larger tilts are left to the card warp
+    static constexpr float MAX_SKEW_DEGREES = 5.0f;
+
+private:
+    // Rotations below this are not worth resampling the band
+    static constexpr float MIN_DESKEW_DEGREES = 0.1f;
+
+    /**
+     * Row ink variance of the mask sheared by an angle (higher = more level)
+     */
+    static double projectionVariance(const std::vector<cv::Point>& ink, int rows, int cols, float degrees);
+
+    /**
+     * Three heaviest text rows of a level ink mask
+     * @return false if fewer than three lines
+     */
+    static bool findLines(const cv::Mat& mask, int scale, std::array<cv::Rect, MRZ_LINE_COUNT>& boxes);
+
+    /**
+     * BackROI::MRZ_LINE1..3 mapped into a BackROI::MRZ band
+     */
+    static void nominalLines(cv::Size band, std::array<cv::Rect, MRZ_LINE_COUNT>& boxes);
+};
+
+} // namespace idverify
+
+#endif // MRZ_LOCATOR_H
@@ -0,0 +1,87 @@
+#include "MRZParser.h"
+
+using namespace std;
+
+namespace idverify {
+
+namespace {
+
+// Check digit stored after a field (false if the line is too short)
+bool fieldCheck(string_view line, const MRZField& f) {
+    const string_view data = MRZParser::field(line, f);
+    return !data.empty() && line.size() > static_cast<size_t>(f.check) &&
+           MRZParser::checkDigit(data, line[f.check]);
+}
+
+string_view trimFillers(string_view text) {
+    const size_t end = text.find_last_not_of('<');
+    return end == string_view::npos ? string_view() : text.substr(0, end + 1);
+}
+
+}
+
+// ==================== Parse ====================
+
+MRZFields MRZParser::parse(string_view line1, string_view line2, string_view line3) noexcept {
+    const string_view lines[3] = { line1.substr(0, TD1::LINE_LENGTH),
+                                   line2.substr(0, TD1::LINE_LENGTH),
+                                   line3.substr(0, TD1::LINE_LENGTH) };
+    MRZFields f = {};
+
+    f.documentCode = field(lines[0], TD1::DOCUMENT_CODE);
+    f.issuer = field(lines[0], TD1::ISSUER);
+    f.documentNumber = field(lines[0], TD1::DOCUMENT_NUMBER);
+    f.tckn = field(lines[0], TD1::TCKN);
+    f.birthDate = field(lines[1], TD1::BIRTH_DATE);
+    f.sex = field(lines[1], TD1::SEX);
+    f.expiryDate = field(lines[1], TD1::EXPIRY_DATE);
+    f.nationality = field(lines[1], TD1::NATIONALITY);
+
+    // SURNAME<<GIVEN<NAMES<<<...
+    const string_view names = trimFillers(lines[2]);
+    const size_t split = names.find("<<");
+    f.surname = trimFillers(names.substr(0, split));
+    if (split != string_view::npos) {
+        const size_t first = names.find_first_not_of('<', split);
+        if (first != string_view::npos) f.givenNames = names.substr(first);
+    }
+
+    f.docNumValid = fieldCheck(lines[0], TD1::DOCUMENT_NUMBER);
+    f.dobValid = fieldCheck(lines[1], TD1::BIRTH_DATE);
+    f.expiryValid = fieldCheck(lines[1], TD1::EXPIRY_DATE);
+    f.tcknValid = validTCKN(f.tckn);
+
+    if (lines[0].size() == TD1::LINE_LENGTH && lines[1].size() == TD1::LINE_LENGTH) {
+        int sum = 0, phase = 0;
+        for (const MRZField& range : TD1::COMPOSITE) {
+            sum += weightedSum(field(lines[range.line], range), phase);
+            phase = (phase + range.length) % 3;
+        }
+        const char check = lines[1][TD1::COMPOSITE_CHECK];
+        f.compositeValid = check >= '0' && check <= '9' && sum % 10 == check - '0';
+    }
+
+    f.valid = f.docNumValid && f.dobValid && f.expiryValid && f.compositeValid;
+    f.score = 15 * (f.docNumValid + f.dobValid + f.expiryValid + f.compositeValid);
+    return f;
+}
+
+// ==================== TCKN ====================
+
+bool MRZParser::validTCKN(string_view tckn) noexcept {
+    if (tckn.size() != 11 || tckn[0] == '0') return false;
+    for (char c : tckn) {
+        if (c < '0' || c > '9') return false;
+    }
+
+    // Odd positions (1st, 3rd, ... 9th) times 7 minus even positions gives digit 10
+    int odds = 0, evens = 0;
+    for (int i = 0; i < 9; ++i) {
+        (i % 2 == 0 ? odds : evens) += tckn[i] - '0';
+    }
+    const int digit10 = ((odds * 7 - evens) % 10 + 10) % 10;
+    const int digit11 = (odds + evens + digit10) % 10;
+    return digit10 == tckn[9] - '0' && digit11 == tckn[10] - '0';
+}
+
+} // namespace idverify
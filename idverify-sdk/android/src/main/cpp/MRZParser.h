@@ -0,0 +1,125 @@
+#ifndef MRZ_PARSER_H
+#define MRZ_PARSER_H
+
+#include <cstdint>
+#include <string_view>
+
+namespace idverify {
+
+/**
+ * Character range of one TD1 field
+ */
+struct MRZField {
+    int8_t line;        // 0-2
+    int8_t start;
+    int8_t length;
+    int8_t check;       // Check digit position on the same line (-1 = none)
+};
+
+/**
+ * TD1 field offsets (ICAO 9303 part 5, TCKK layout)
+ */
+namespace TD1 {
+
+constexpr int LINE_LENGTH = 30;
+
+constexpr MRZField DOCUMENT_CODE   = { 0, 0, 2, -1 };
+constexpr MRZField ISSUER          = { 0, 2, 3, -1 };
+constexpr MRZField DOCUMENT_NUMBER = { 0, 5, 9, 14 };
+constexpr MRZField TCKN            = { 0, 16, 11, -1 };    // Optional data 1 on the TCKK
+constexpr MRZField BIRTH_DATE      = { 1, 0, 6, 6 };
+constexpr MRZField SEX             = { 1, 7, 1, -1 };
+constexpr MRZField EXPIRY_DATE     = { 1, 8, 6, 14 };
+constexpr MRZField NATIONALITY     = { 1, 15, 3, -1 };
+constexpr MRZField NAMES           = { 2, 0, 30, -1 };
+
+// Composite check digit (line 2) covers these ranges, weights running on across them
+constexpr MRZField COMPOSITE[] = { { 0, 5, 25, -1 }, { 1, 0, 7, -1 }, { 1, 8, 7, -1 }, { 1, 18, 11, -1 } };
+constexpr int COMPOSITE_CHECK = 29;
+
+}
+
+/**
+ * Fields of one MRZ, as views into the parsed lines
+ * Views are only valid while the caller's line buffers are; missing fields are empty
+ */
+struct MRZFields {
+    std::string_view documentCode;
+    std::string_view issuer;
+    std::string_view documentNumber;
+    std::string_view tckn;
+    std::string_view birthDate;     // YYMMDD
+    std::string_view sex;
+    std::string_view expiryDate;    // YYMMDD
+    std::string_view nationality;
+    std::string_view surname;
+    std::string_view givenNames;    // Names still separated by '<'
+    bool docNumValid;
+    bool dobValid;
+    bool expiryValid;
+    bool compositeValid;
+    bool tcknValid;
+    bool valid;                     // All four check digits hold
+    int score;                      // 0-60, 15 per check digit (as ValidationScore)
+};
+
+/**
+ * MRZParser - Allocation-free TD1 field split and check-digit validation
+ *
+ * Works on the lines exactly as given: no OCR correction, no logging and
+ * no heap use, so it can run inside candidate search loops. Lines longer
+ * than 30 characters are read up to position 30; checks whose range does
+ * not fit a shorter line fail. Use MRZDecoder first for raw OCR text.
+ */
+class MRZParser {
+public:
+    static MRZFields parse(std::string_view line1, std::string_view line2, std::string_view line3) noexcept;
+
+    /**
+     * Characters of a field in its line (empty if the line is too short)
+     */
+    static constexpr std::string_view field(std::string_view line, const MRZField& f) noexcept {
+        return line.size() >= static_cast<size_t>(f.start + f.length)
+               ? line.substr(f.start, f.length) : std::string_view();
+    }
+
+    /**
+     * 0-9 -> 0-9, A-Z -> 10-35, '<' and anything else -> 0
+     */
+    static constexpr int charValue(char c) noexcept {
+        return (c >= '0' && c <= '9') ? c - '0' : (c >= 'A' && c <= 'Z') ? c - 'A' + 10 : 0;
+    }
+
+    /**
+     * 7-3-1 weighted sum, starting at weight index phase
+     */
+    static constexpr int weightedSum(std::string_view data, int phase = 0) noexcept {
+        constexpr int weights[3] = { 7, 3, 1 };
+        int sum = 0;
+        for (char c : data) {
+            sum += charValue(c) * weights[phase];
+            phase = phase == 2 ? 0 : phase + 1;
+        }
+        return sum;
+    }
+
+    /**
+     * ICAO check digit of data (0-9)
+     */
+    static constexpr int checksum(std::string_view data) noexcept {
+        return weightedSum(data) % 10;
+    }
+
+    static constexpr bool checkDigit(std::string_view data, char check) noexcept {
+        return check >= '0' && check <= '9' && checksum(data) == check - '0';
+    }
+
+    /**
+     * TCKN rules: 11 digits, no leading zero, digits 10 and 11 are checks
+     */
+    static bool validTCKN(std::string_view tckn) noexcept;
+};
+
+} // namespace idverify
+
+#endif // MRZ_PARSER_H
@@ -0,0 +1,407 @@
+#include "MRZReader.h"
+#include "MRZLocator.h"
+#include "Metrics.h"
+#include "ROIMapper.h"
+#include "Trace.h"
+#include "VisionProcessor.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <android/log.h>
+
+#define TAG "MRZReader"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
+
+using namespace cv;
+using namespace std;
+
+namespace idverify {
+
+namespace {
+
+const uint32_t TEMPLATE_MAGIC = 0x54564449;    // "IDVT"
+const uint16_t TEMPLATE_VERSION = 1;
+
+// Score gap to the runner-up at which a match counts as unambiguous
+const float CONFIDENCE_MARGIN = 0.15f;
+
+// Built-in template rendering (pitch and cap height close to a warped MRZ cell)
+const int RENDER_FACE = FONT_HERSHEY_SIMPLEX;
+const double RENDER_SCALE = 1.0;
+const int RENDER_THICKNESS = 2;
+const int RENDER_PITCH = 27;
+
+void renderTemplate(char c, int top, int bottom, float* out) {
+    const int margin = 12;
+    Size cap = getTextSize("H", RENDER_FACE, RENDER_SCALE, RENDER_THICKNESS, nullptr);
+    int baseline = 0;
+    Size size = getTextSize(string(1, c), RENDER_FACE, RENDER_SCALE, RENDER_THICKNESS, &baseline);
+
+    Mat canvas = Mat::zeros(cap.height + 2 * margin, RENDER_PITCH + 2 * margin, CV_8U);
+    putText(canvas, string(1, c), Point(margin + (RENDER_PITCH - size.width) / 2, margin + cap.height),
+            RENDER_FACE, RENDER_SCALE, Scalar(255), RENDER_THICKNESS, LINE_AA);
+
+    Mat cell, ink;
+    canvas(Rect(margin, top, RENDER_PITCH, bottom - top + 1)).convertTo(ink, CV_32F, 1.0 / 255.0);
+    resize(ink, cell, Size(MRZReader::CELL_WIDTH, MRZReader::CELL_HEIGHT), 0, 0, INTER_AREA);
+    memcpy(out, cell.ptr<float>(), sizeof(float) * MRZReader::CELL_WIDTH * MRZReader::CELL_HEIGHT);
+}
+
+void normalizeVector(float* v, int n) {
+    double mean = 0.0;
+    for (int i = 0; i < n; ++i) mean += v[i];
+    mean /= n;
+    double norm = 0.0;
+    for (int i = 0; i < n; ++i) {
+        v[i] = static_cast<float>(v[i] - mean);
+        norm += static_cast<double>(v[i]) * v[i];
+    }
+    norm = sqrt(norm);
+    if (norm < 1e-6) return;
+    for (int i = 0; i < n; ++i) v[i] = static_cast<float>(v[i] / norm);
+}
+
+float dot(const float* a, const float* b, int n) {
+    float sum = 0.0f;
+    for (int i = 0; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+}
+
+// ==================== Construction ====================
+
+MRZReader::MRZReader()
+    : templates_(MRZ_ALPHABET_SIZE * CELL_AREA, 0.0f),
+      sums_(MRZ_ALPHABET_SIZE * CELL_AREA, 0.0),
+      counts_(MRZ_ALPHABET_SIZE, 0) {
+    // Text rows of the rendered line: ink extent of a capital, as MRZLocator sees it
+    const int margin = 12;
+    Size cap = getTextSize("H", RENDER_FACE, RENDER_SCALE, RENDER_THICKNESS, nullptr);
+    Mat probe = Mat::zeros(cap.height + 2 * margin, RENDER_PITCH + 2 * margin, CV_8U);
+    putText(probe, "H", Point(margin, margin + cap.height), RENDER_FACE, RENDER_SCALE,
+            Scalar(255), RENDER_THICKNESS, LINE_AA);
+    Mat rows;
+    reduce(probe, rows, 1, REDUCE_MAX);
+    int top = 0, bottom = probe.rows - 1;
+    while (top < bottom && rows.at<uchar>(top) < 128) top++;
+    while (bottom > top && rows.at<uchar>(bottom) < 128) bottom--;
+
+    for (int i = 0; i < MRZ_ALPHABET_SIZE; ++i) {
+        float* t = &templates_[i * CELL_AREA];
+        renderTemplate(OCRWhitelist::MRZ_CHARSET[i], top, bottom, t);
+        normalizeVector(t, CELL_AREA);
+    }
+}
+
+int MRZReader::charIndex(char c) {
+    const char* p = strchr(OCRWhitelist::MRZ_CHARSET, c);
+    return (c != '\0' && p != nullptr) ? static_cast<int>(p - OCRWhitelist::MRZ_CHARSET) : -1;
+}
+
+// ==================== Segmentation ====================
+
+bool MRZReader::segmentLine(const Mat& ink, const Rect& line, array<float, MRZ_LINE_LENGTH + 1>& borders) {
+    Mat colSum;
+    reduce(ink(line), colSum, 0, REDUCE_SUM, CV_32S);
+    const int cols = colSum.cols;
+    vector<int> col(colSum.ptr<int>(), colSum.ptr<int>() + cols);
+
+    // Ink running into the band edge is the card border, not a glyph
+    for (int x = 0; x < cols && col[x] > 0; ++x) col[x] = 0;
+    for (int x = cols - 1; x >= 0 && col[x] > 0; --x) col[x] = 0;
+
+    long total = 0;
+    for (int x = 0; x < cols; ++x) total += col[x];
+    if (total == 0) return false;
+
+    // Ink span, ignoring specks at either end
+    long cum = 0;
+    int first = 0, last = cols - 1;
+    for (int x = 0; x < cols; ++x) {
+        cum += col[x];
+        if (cum > total / 500) { first = x; break; }
+    }
+    cum = 0;
+    for (int x = cols - 1; x >= 0; --x) {
+        cum += col[x];
+        if (cum > total / 500) { last = x; break; }
+    }
+    if (last <= first) return false;
+
+    // The last glyph stops short of its cell border
+    const float p0 = (last - first + 1) / (MRZ_LINE_LENGTH - 0.2f);
+    auto at = [&](float x) {
+        int i = cvRound(x);
+        return (i >= 0 && i < cols) ? col[i] : 0;
+    };
+
+    float bestCost = 1e30f, bestPitch = p0, bestStart = first - 0.1f * p0;
+    for (float p = 0.94f * p0; p <= 1.06f * p0; p += std::max(0.02f, 0.005f * p0)) {
+        for (float x0 = first - 0.45f * p; x0 <= first; x0 += 0.25f) {
+            if (x0 + MRZ_LINE_LENGTH * p < last) continue;
+            float cost = 0.0f;
+            for (int k = 0; k <= MRZ_LINE_LENGTH; ++k) {
+                float b = x0 + k * p;
+                cost += at(b) + 0.5f * (at(b - 1.0f) + at(b + 1.0f));
+            }
+            if (cost < bestCost || (cost == bestCost && fabs(p - p0) < fabs(bestPitch - p0))) {
+                bestCost = cost;
+                bestPitch = p;
+                bestStart = x0;
+            }
+        }
+    }
+
+    for (int k = 0; k <= MRZ_LINE_LENGTH; ++k) {
+        borders[k] = bestStart + k * bestPitch;
+    }
+    return true;
+}
+
+bool MRZReader::segment(const Mat& band, int scale, Mat& inkPadded, int& pad,
+                        array<Rect, MRZ_LINE_COUNT>& lines,
+                        array<array<float, MRZ_LINE_LENGTH + 1>, MRZ_LINE_COUNT>& borders) {
+    if (band.empty()) return false;
+
+    // Level the band and find the text rows; cells are cut from full-width rows
+    MRZLineLayout layout = MRZLocator::locate(band, scale, false);
+    if (!layout.found) return false;
+
+    // binarizeMRZ leaves text black on white
+    Mat binary = VisionProcessor::binarizeMRZ(layout.deskewed, scale);
+    Mat ink;
+    threshold(binary, ink, 127, 1, THRESH_BINARY_INV);
+
+    for (int i = 0; i < MRZ_LINE_COUNT; ++i) {
+        lines[i] = Rect(0, layout.boxes[i].y, ink.cols, layout.boxes[i].height);
+        if (!segmentLine(ink, lines[i], borders[i])) return false;
+    }
+
+    // Cells near the band edge sample into the zero border
+    pad = 8 * std::max(1, scale);
+    Mat inkFloat;
+    ink.convertTo(inkFloat, CV_32F);
+    copyMakeBorder(inkFloat, inkPadded, pad, pad, pad, pad, BORDER_CONSTANT, Scalar(0));
+    return true;
+}
+
+void MRZReader::sampleCell(const Mat& inkPadded, int pad, const Rect& line, float x0, float x1, Mat& cell) {
+    const float ex = (x1 - x0) / CELL_WIDTH;
+    const float ey = static_cast<float>(line.height) / CELL_HEIGHT;
+    int left = cvRound(x0 - ex) + pad;
+    int right = cvRound(x1 + ex) + pad;
+    int top = cvRound(line.y - ey) + pad;
+    int bottom = cvRound(line.y + line.height + ey) + pad;
+    left = std::max(0, std::min(left, inkPadded.cols - 1));
+    right = std::max(left + 1, std::min(right, inkPadded.cols));
+    top = std::max(0, std::min(top, inkPadded.rows - 1));
+    bottom = std::max(top + 1, std::min(bottom, inkPadded.rows));
+    resize(inkPadded(Rect(left, top, right - left, bottom - top)), cell,
+           Size(CELL_WIDTH + 2, CELL_HEIGHT + 2), 0, 0, INTER_AREA);
+}
+
+// ==================== Classification ====================
+
+bool MRZReader::normalizeWindow(const Mat& cell, int dx, int dy, float* out) {
+    for (int y = 0; y < CELL_HEIGHT; ++y) {
+        memcpy(out + y * CELL_WIDTH, cell.ptr<float>(y + dy) + dx, sizeof(float) * CELL_WIDTH);
+    }
+    float sum = 0.0f;
+    for (int i = 0; i < CELL_AREA; ++i) sum += out[i];
+    if (sum < 0.01f * CELL_AREA) return false;
+    normalizeVector(out, CELL_AREA);
+    return true;
+}
+
+void MRZReader::classify(const Mat& cell, MRZChar& out) const {
+    array<float, MRZ_ALPHABET_SIZE> scores;
+    scores.fill(-1.0f);
+
+    float window[CELL_AREA];
+    for (int dy = 0; dy <= 2; ++dy) {
+        for (int dx = 0; dx <= 2; ++dx) {
+            if (!normalizeWindow(cell, dx, dy, window)) continue;
+            for (int t = 0; t < MRZ_ALPHABET_SIZE; ++t) {
+                scores[t] = std::max(scores[t], dot(window, &templates_[t * CELL_AREA], CELL_AREA));
+            }
+        }
+    }
+
+    array<int, MRZ_ALPHABET_SIZE> order;
+    for (int t = 0; t < MRZ_ALPHABET_SIZE; ++t) order[t] = t;
+    partial_sort(order.begin(), order.begin() + MRZ_CANDIDATES, order.end(),
+                 [&](int a, int b) { return scores[a] > scores[b]; });
+    for (int k = 0; k < MRZ_CANDIDATES; ++k) {
+        out.candidates[k] = { OCRWhitelist::MRZ_CHARSET[order[k]], scores[order[k]] };
+    }
+
+    const float best = scores[order[0]];
+    const float margin = best - scores[order[1]];
+    out.confidence = std::max(0.0f, std::min(1.0f, best)) *
+                     std::max(0.0f, std::min(1.0f, margin / CONFIDENCE_MARGIN));
+}
+
+// ==================== Reading ====================
+
+MRZReadResult MRZReader::read(const Mat& warpedCard) const {
+    return readBand(VisionProcessor::cropROI(warpedCard, BackROI::MRZ), 1);
+}
+
+MRZReadResult MRZReader::readBand(const Mat& band, int scale) const {
+    StageTimer timer(MetricStage::MRZ_READ);
+    TraceSpan span("readMRZ");
+
+    MRZReadResult result;
+    result.found = false;
+    result.meanConfidence = 0.0f;
+    result.minConfidence = 0.0f;
+    for (auto& line : result.chars) {
+        for (MRZChar& c : line) {
+            c.candidates.fill({ '<', -1.0f });
+            c.confidence = 0.0f;
+        }
+    }
+
+    Mat inkPadded;
+    int pad = 0;
+    array<array<float, MRZ_LINE_LENGTH + 1>, MRZ_LINE_COUNT> borders;
+    if (!segment(band, scale, inkPadded, pad, result.lineBoxes, borders)) {
+        LOGD("readBand: No 3-line MRZ in %dx%d band", band.cols, band.rows);
+        return result;
+    }
+
+    Mat cell;
+    float sum = 0.0f, minConf = 1.0f;
+    for (int i = 0; i < MRZ_LINE_COUNT; ++i) {
+        string& text = result.lines[i];
+        text.assign(MRZ_LINE_LENGTH, '<');
+        for (int k = 0; k < MRZ_LINE_LENGTH; ++k) {
+            sampleCell(inkPadded, pad, result.lineBoxes[i], borders[i][k], borders[i][k + 1], cell);
+            MRZChar& c = result.chars[i][k];
+            classify(cell, c);
+            text[k] = c.candidates[0].c;
+            sum += c.confidence;
+            minConf = std::min(minConf, c.confidence);
+        }
+    }
+
+    result.found = true;
+    result.meanConfidence = sum / (MRZ_LINE_COUNT * MRZ_LINE_LENGTH);
+    result.minConfidence = minConf;
+    return result;
+}
+
+// ==================== Templates ====================
+
+int MRZReader::learn(const Mat& band, const array<string, MRZ_LINE_COUNT>& lines, int scale) {
+    Mat inkPadded;
+    int pad = 0;
+    array<Rect, MRZ_LINE_COUNT> boxes;
+    array<array<float, MRZ_LINE_LENGTH + 1>, MRZ_LINE_COUNT> borders;
+    if (!segment(band, scale, inkPadded, pad, boxes, borders)) return 0;
+
+    int learned = 0;
+    Mat cell;
+    float window[CELL_AREA], best[CELL_AREA];
+    for (int i = 0; i < MRZ_LINE_COUNT; ++i) {
+        if (static_cast<int>(lines[i].size()) < MRZ_LINE_LENGTH) continue;
+        for (int k = 0; k < MRZ_LINE_LENGTH; ++k) {
+            const int t = charIndex(lines[i][k]);
+            if (t < 0) continue;
+            sampleCell(inkPadded, pad, boxes[i], borders[i][k], borders[i][k + 1], cell);
+
+            // Align to the current template so the average stays sharp
+            float bestScore = -2.0f;
+            for (int dy = 0; dy <= 2; ++dy) {
+                for (int dx = 0; dx <= 2; ++dx) {
+                    if (!normalizeWindow(cell, dx, dy, window)) continue;
+                    float s = dot(window, &templates_[t * CELL_AREA], CELL_AREA);
+                    if (s > bestScore) {
+                        bestScore = s;
+                        memcpy(best, window, sizeof(best));
+                    }
+                }
+            }
+            if (bestScore < -1.0f) continue;
+
+            double* acc = &sums_[t * CELL_AREA];
+            for (int j = 0; j < CELL_AREA; ++j) acc[j] += best[j];
+            counts_[t]++;
+            learned++;
+        }
+    }
+    return learned;
+}
+
+int MRZReader::finishLearning(int minSamples) {
+    int replaced = 0;
+    for (int t = 0; t < MRZ_ALPHABET_SIZE; ++t) {
+        if (counts_[t] >= std::max(1, minSamples)) {
+            float* dst = &templates_[t * CELL_AREA];
+            const double* acc = &sums_[t * CELL_AREA];
+            for (int j = 0; j < CELL_AREA; ++j) dst[j] = static_cast<float>(acc[j] / counts_[t]);
+            normalizeVector(dst, CELL_AREA);
+            replaced++;
+        }
+    }
+    fill(sums_.begin(), sums_.end(), 0.0);
+    fill(counts_.begin(), counts_.end(), 0);
+    LOGD("finishLearning: %d/%d templates replaced", replaced, MRZ_ALPHABET_SIZE);
+    return replaced;
+}
+
+bool MRZReader::saveTemplates(const string& path) const {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        LOGE("saveTemplates: Cannot create %s", path.c_str());
+        return false;
+    }
+    const uint16_t header[4] = { TEMPLATE_VERSION, CELL_WIDTH, CELL_HEIGHT, MRZ_ALPHABET_SIZE };
+    bool ok = fwrite(&TEMPLATE_MAGIC, sizeof(TEMPLATE_MAGIC), 1, file) == 1 &&
+              fwrite(header, sizeof(header), 1, file) == 1;
+    for (int t = 0; ok && t < MRZ_ALPHABET_SIZE; ++t) {
+        const uint8_t tag[4] = { static_cast<uint8_t>(OCRWhitelist::MRZ_CHARSET[t]), 0, 0, 0 };
+        ok = fwrite(tag, sizeof(tag), 1, file) == 1 &&
+             fwrite(&templates_[t * CELL_AREA], sizeof(float), CELL_AREA, file) == CELL_AREA;
+    }
+    ok = (fclose(file) == 0) && ok;
+    return ok;
+}
+
+bool MRZReader::loadTemplates(const string& path) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        LOGE("loadTemplates: Cannot open %s", path.c_str());
+        return false;
+    }
+    uint32_t magic = 0;
+    uint16_t header[4] = {};
+    bool ok = fread(&magic, sizeof(magic), 1, file) == 1 && fread(header, sizeof(header), 1, file) == 1 &&
+              magic == TEMPLATE_MAGIC && header[0] == TEMPLATE_VERSION &&
+              header[1] == CELL_WIDTH && header[2] == CELL_HEIGHT && header[3] <= MRZ_ALPHABET_SIZE;
+
+    // Characters missing from the file keep their current template
+    vector<float> loaded = templates_;
+    for (int i = 0; ok && i < header[3]; ++i) {
+        uint8_t tag[4];
+        float cell[CELL_AREA];
+        ok = fread(tag, sizeof(tag), 1, file) == 1 && fread(cell, sizeof(float), CELL_AREA, file) == CELL_AREA;
+        const int t = charIndex(static_cast<char>(tag[0]));
+        if (ok && t >= 0) {
+            memcpy(&loaded[t * CELL_AREA], cell, sizeof(cell));
+        }
+    }
+    fclose(file);
+    if (!ok) {
+        LOGE("loadTemplates: %s is not a %dx%d MRZ template file", path.c_str(), CELL_WIDTH, CELL_HEIGHT);
+        return false;
+    }
+    templates_.swap(loaded);
+    return true;
+}
+
+} // namespace idverify
@@ -0,0 +1,152 @@
+#ifndef MRZ_READER_H
+#define MRZ_READER_H
+
+#include <opencv2/core.hpp>
+#include <array>
+#include <string>
+#include <vector>
+
+namespace idverify {
+
+// TD1 geometry
+constexpr int MRZ_LINE_COUNT = 3;
+constexpr int MRZ_LINE_LENGTH = 30;
+
+// Characters of OCRWhitelist::MRZ_CHARSET
+constexpr int MRZ_ALPHABET_SIZE = 37;
+
+// Ranked template matches kept per character
+constexpr int MRZ_CANDIDATES = 3;
+
+/**
+ * One template match
+ */
+struct MRZCandidate {
+    char c;
+    float score;        // Normalized correlation (-1..1, higher = closer)
+};
+
+/**
+ * Recognized character with its runner-up matches
+ */
+struct MRZChar {
+    std::array<MRZCandidate, MRZ_CANDIDATES> candidates;  // Best first
+    float confidence;   // 0-1: best score scaled by its margin to the runner-up
+};
+
+/**
+ * Native MRZ read of one band
+ */
+struct MRZReadResult {
+    bool found;                                         // Three lines of 30 cells segmented
+    std::array<std::string, MRZ_LINE_COUNT> lines;      // Best character per cell
+    std::array<std::array<MRZChar, MRZ_LINE_LENGTH>, MRZ_LINE_COUNT> chars;
+    std::array<cv::Rect, MRZ_LINE_COUNT> lineBoxes;     // Text rows in deskewed band pixels
+    float meanConfidence;
+    float minConfidence;
+};
+
+/**
+ * MRZReader - Fixed-pitch OCR-B reader for the TD1 MRZ
+ *
+ * The band is leveled and split into three text lines by MRZLocator,
+ * binarized (binarizeMRZ), and each line cut into 30 cells: the MRZ has
+ * no blanks ('<' fills), so the ink span holds exactly 30 cells and the
+ * pitch/offset are fitted to put cell borders on the emptiest columns. Every cell is
+ * resampled to CELL_WIDTH x CELL_HEIGHT and matched against one template
+ * per MRZ_CHARSET character by zero-mean normalized correlation, allowing
+ * a one-cell-pixel shift for segmentation error.
+ *
+ * Built-in templates are rendered with a Hershey stroke font, a stand-in
+ * for OCR-B (and the font of the synthetic corpus). Real cards read best
+ * with templates averaged from labeled crops via learn() and shipped with
+ * saveTemplates() / loadTemplates(). The JNI entry points serve no reader
+ * until NativeProcessor.loadMRZTemplates has succeeded.
+ *
+ * read() and readBand() are const and may run on several threads; learn()
+ * and loadTemplates() must not overlap them.
+ */
+class MRZReader {
+public:
+    MRZReader();
+
+    /**
+     * Read the MRZ of a warped card (BackROI::MRZ band)
+     * @param warpedCard 856x540 warped back side
+     */
+    MRZReadResult read(const cv::Mat& warpedCard) const;
+
+    /**
+     * Read an MRZ band crop
+     * @param band Grayscale or color band (e.g. cropROI(BackROI::MRZ) or a fused MRZ)
+     * @param scale Resolution factor vs. the 856x540 card (2 for a 2x fused band)
+     */
+    MRZReadResult readBand(const cv::Mat& band, int scale = 1) const;
+
+    /**
+     * Accumulate the cells of a labeled band into per-character averages
+     * @param lines Ground-truth TD1 lines
+     * @return Cells learned (0 if the band did not segment into 3x30)
+     */
+    int learn(const cv::Mat& band, const std::array<std::string, MRZ_LINE_COUNT>& lines, int scale = 1);
+
+    /**
+     * Replace templates of characters seen at least minSamples times by their averages
+     * @return Characters replaced
+     */
+    int finishLearning(int minSamples = 5);
+
+    /**
+     * Template file: u32 magic "IDVT", u16 version, u16 cell width, u16 cell height,
+     * u16 count, count x {u8 char, 3 pad, float[width * height]} (little-endian)
+     * @return false if the file is missing or does not match this reader
+     */
+    bool loadTemplates(const std::string& path);
+    bool saveTemplates(const std::string& path) const;
+
+    /**
+     * Index of a character in MRZ_CHARSET (-1 if not an MRZ character)
+     */
+    static int charIndex(char c);
+
+    static constexpr int CELL_WIDTH = 12;
+    static constexpr int CELL_HEIGHT = 16;
+
+private:
+    static constexpr int CELL_AREA = CELL_WIDTH * CELL_HEIGHT;
+
+    /**
+     * Fit 31 cell borders across one line
+     * @return false if the line holds no ink
+     */
+    static bool segmentLine(const cv::Mat& ink, const cv::Rect& line, std::array<float, MRZ_LINE_LENGTH + 1>& borders);
+
+    /**
+     * Resample one cell with a one-pixel margin to (CELL_WIDTH + 2) x (CELL_HEIGHT + 2)
+     */
+    static void sampleCell(const cv::Mat& inkPadded, int pad, const cv::Rect& line,
+                           float x0, float x1, cv::Mat& cell);
+
+    /**
+     * Zero-mean, unit-norm copy of a CELL_WIDTH x CELL_HEIGHT window
+     * @return false for a blank window
+     */
+    static bool normalizeWindow(const cv::Mat& cell, int dx, int dy, float* out);
+
+    void classify(const cv::Mat& cell, MRZChar& out) const;
+
+    /**
+     * Binarize, locate and segment a band
+     */
+    static bool segment(const cv::Mat& band, int scale, cv::Mat& inkPadded, int& pad,
+                        std::array<cv::Rect, MRZ_LINE_COUNT>& lines,
+                        std::array<std::array<float, MRZ_LINE_LENGTH + 1>, MRZ_LINE_COUNT>& borders);
+
+    std::vector<float> templates_;      // MRZ_ALPHABET_SIZE x CELL_AREA, normalized
+    std::vector<double> sums_;          // Learning accumulators
+    std::vector<int> counts_;
+};
+
+} // namespace idverify
+
+#endif // MRZ_READER_H
@@ -0,0 +1,119 @@
+#include "Metrics.h"
+#include <cstring>
+
+using namespace std;
+
+namespace idverify {
+
+namespace {
+
+template <typename T>
+void put(vector<uint8_t>& out, T value) {
+    size_t offset = out.size();
+    out.resize(offset + sizeof(T));
+    memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+}
+
+// ==================== AtomicHistogram ====================
+
+int AtomicHistogram::bucketIndex(uint64_t us) {
+    if (us < SUB_BUCKETS) {
+        return static_cast<int>(us);
+    }
+    if (us >= (uint64_t(1) << 32)) {
+        return BUCKETS - 1;
+    }
+    // Magnitude = index of the highest set bit (>= SUB_BITS here)
+    const int magnitude = 63 - __builtin_clzll(us);
+    const int sub = static_cast<int>((us >> (magnitude - SUB_BITS)) & (SUB_BUCKETS - 1));
+    return (magnitude - SUB_BITS + 1) * SUB_BUCKETS + sub;
+}
+
+uint64_t AtomicHistogram::bucketLowerUs(int index) {
+    if (index < SUB_BUCKETS) {
+        return static_cast<uint64_t>(index);
+    }
+    const int magnitude = index / SUB_BUCKETS + SUB_BITS - 1;
+    const uint64_t sub = static_cast<uint64_t>(index % SUB_BUCKETS);
+    return (SUB_BUCKETS + sub) << (magnitude - SUB_BITS);
+}
+
+uint64_t AtomicHistogram::bucketUpperUs(int index) {
+    if (index < SUB_BUCKETS) {
+        return static_cast<uint64_t>(index) + 1;
+    }
+    const int magnitude = index / SUB_BUCKETS + SUB_BITS - 1;
+    return bucketLowerUs(index) + (uint64_t(1) << (magnitude - SUB_BITS));
+}
+
+uint64_t AtomicHistogram::percentileUs(double p) const {
+    const uint64_t total = count();
+    if (total == 0) return 0;
+
+    const uint64_t target = static_cast<uint64_t>(p * total + 0.5);
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        seen += bucket(i);
+        if (seen >= target && seen > 0) return bucketUpperUs(i);
+    }
+    return bucketUpperUs(BUCKETS - 1);
+}
+
+void AtomicHistogram::reset() {
+    for (auto& b : buckets_) b.store(0, memory_order_relaxed);
+    count_.store(0, memory_order_relaxed);
+    sumUs_.store(0, memory_order_relaxed);
+}
+
+// ==================== Metrics ====================
+
+Metrics& Metrics::instance() {
+    static Metrics metrics;
+    return metrics;
+}
+
+Metrics::Metrics() : enabled_(true) {
+    for (auto& c : counters_) c.store(0, memory_order_relaxed);
+}
+
+void Metrics::snapshot(vector<uint8_t>& out) const {
+    out.clear();
+    out.reserve(16 + METRIC_COUNTER_COUNT * 8 + METRIC_STAGE_COUNT * 64);
+
+    put<uint32_t>(out, SNAPSHOT_MAGIC);
+    put<uint16_t>(out, SNAPSHOT_VERSION);
+    put<uint16_t>(out, METRIC_STAGE_COUNT);
+    put<uint16_t>(out, METRIC_COUNTER_COUNT);
+    put<uint16_t>(out, AtomicHistogram::BUCKETS);
+
+    for (const auto& c : counters_) {
+        put<uint64_t>(out, c.load(memory_order_relaxed));
+    }
+
+    for (const AtomicHistogram& h : stages_) {
+        put<uint64_t>(out, h.count());
+        put<uint64_t>(out, h.sumUs());
+
+        // Sparse buckets: latencies cluster in a handful of buckets
+        size_t countOffset = out.size();
+        put<uint16_t>(out, 0);
+        uint16_t nonEmpty = 0;
+        for (int i = 0; i < AtomicHistogram::BUCKETS; ++i) {
+            uint64_t n = h.bucket(i);
+            if (n == 0) continue;
+            put<uint16_t>(out, static_cast<uint16_t>(i));
+            put<uint64_t>(out, n);
+            nonEmpty++;
+        }
+        memcpy(out.data() + countOffset, &nonEmpty, sizeof(nonEmpty));
+    }
+}
+
+void Metrics::reset() {
+    for (auto& h : stages_) h.reset();
+    for (auto& c : counters_) c.store(0, memory_order_relaxed);
+}
+
+} // namespace idverify
@@ -0,0 +1,202 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace idverify {
+
+/**
+ * Timed pipeline stages
+ */
+enum class MetricStage : int {
+    INGEST = 0,     // Bitmap -> Mat conversion at the JNI boundary
+    DETECT = 1,     // findCardCorners / trackCardCorners
+    WARP = 2,       // warpToID1
+    BINARIZE = 3,   // binarizeForOCR (incl. MRZ band)
+    ROI = 4,        // preprocessROI
+    VALIDATE = 5,   // MRZ checksum validation
+    MRZ_READ = 6    // Native MRZ recognition (MRZReader)
+};
+
+constexpr int METRIC_STAGE_COUNT = 7;
+
+/**
+ * Event counters
+ */
+enum class MetricCounter : int {
+    FRAMES = 0,             // Frames a ScanSession processes (memo hits included, governor skips not)
+    REJECT_PRESENCE = 1,    // Cascade rejections, one per CascadeStage
+    REJECT_QUALITY = 2,
+    REJECT_DETECTION = 3,
+    REJECT_WARP = 4,
+    REJECT_ROI = 5,
+    DETECTIONS = 6,         // Card quads found
+    TRACKER_LOSSES = 7,     // trackCardCorners lost the card
+    CANCELLED = 8,          // Frames stopped by cancel/deadline
+    MEMO_HITS = 9           // Frames answered from the frame-hash memo
+};
+
+constexpr int METRIC_COUNTER_COUNT = 10;
+
+/**
+ * AtomicHistogram - Wait-free log-linear latency histogram (microseconds)
+ *
+ * HDR-style layout: values below 8 us get their own bucket, above that
+ * every power of two is split into 8 linear sub-buckets (<= 12.5% error)
+ * up to 2^32 us. record() is two relaxed fetch_adds and one bucket
+ * fetch_add; readers may see a slightly torn count/sum pair, which is fine
+ * for monitoring.
+ */
+class AtomicHistogram {
+public:
+    static constexpr int SUB_BITS = 3;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BITS;
+    static constexpr int BUCKETS = (32 - SUB_BITS + 1) * SUB_BUCKETS;
+
+    AtomicHistogram() { reset(); }
+
+    void record(uint64_t us) {
+        buckets_[bucketIndex(us)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sumUs_.fetch_add(us, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t sumUs() const { return sumUs_.load(std::memory_order_relaxed); }
+    uint64_t bucket(int i) const { return buckets_[i].load(std::memory_order_relaxed); }
+
+    /**
+     * Approximate percentile
+     * @param p 0-1
+     * @return Upper bound of the bucket holding the percentile (us)
+     */
+    uint64_t percentileUs(double p) const;
+
+    void reset();
+
+    static int bucketIndex(uint64_t us);
+    static uint64_t bucketLowerUs(int index);
+    static uint64_t bucketUpperUs(int index);
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKETS> buckets_;
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> sumUs_;
+};
+
+/**
+ * Metrics - Process-wide stage histograms and counters
+ *
+ * Written from the analysis thread(s) without locks; read by the JNI
+ * snapshot call. Disabling skips the clock reads in StageTimer and
+ * stops the counters. A single thread can also be left out without
+ * touching the global switch (InstrumentationPause).
+ *
+ * Snapshot layout (little-endian):
+ *   u32 magic "IDVM", u16 version, u16 stageCount, u16 counterCount, u16 bucketCount
+ *   u64 counters[counterCount]
+ *   per stage: u64 count, u64 sumUs, u16 nonEmpty, nonEmpty x {u16 bucket, u64 count}
+ */
+class Metrics {
+public:
+    static Metrics& instance();
+
+    void record(MetricStage stage, uint64_t us) {
+        stages_[static_cast<int>(stage)].record(us);
+    }
+
+    void increment(MetricCounter counter, uint64_t n = 1) {
+        if (!enabled() || threadPaused_) return;
+        counters_[static_cast<int>(counter)].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t counter(MetricCounter counter) const {
+        return counters_[static_cast<int>(counter)].load(std::memory_order_relaxed);
+    }
+
+    const AtomicHistogram& histogram(MetricStage stage) const {
+        return stages_[static_cast<int>(stage)];
+    }
+
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+    void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+
+    /**
+     * True while the calling thread is inside an InstrumentationPause
+     * (StageTimer, TraceSpan and counters then skip it)
+     */
+    static bool threadPaused() { return threadPaused_; }
+
+    /**
+     * Serialize all histograms and counters
+     * @param out Replaced with the snapshot bytes
+     */
+    void snapshot(std::vector<uint8_t>& out) const;
+
+    void reset();
+
+    static constexpr uint32_t SNAPSHOT_MAGIC = 0x4D564449;  // "IDVM"
+    static constexpr uint16_t SNAPSHOT_VERSION = 1;
+
+private:
+    Metrics();
+
+    std::array<AtomicHistogram, METRIC_STAGE_COUNT> stages_;
+    std::array<std::atomic<uint64_t>, METRIC_COUNTER_COUNT> counters_;
+    std::atomic<bool> enabled_;
+
+    friend class InstrumentationPause;
+    static inline thread_local bool threadPaused_ = false;
+};
+
+/**
+ * InstrumentationPause - Keeps the calling thread out of Metrics and Trace while in scope
+ *
+ * Other threads and the global enable switches are untouched, so e.g. a
+ * calibration run on a worker does not blank out a live session.
+ */
+class InstrumentationPause {
+public:
+    InstrumentationPause() : previous_(Metrics::threadPaused_) { Metrics::threadPaused_ = true; }
+    ~InstrumentationPause() { Metrics::threadPaused_ = previous_; }
+
+    InstrumentationPause(const InstrumentationPause&) = delete;
+    InstrumentationPause& operator=(const InstrumentationPause&) = delete;
+
+private:
+    bool previous_;
+};
+
+/**
+ * StageTimer - Records the scope's wall time into a stage histogram
+ */
+class StageTimer {
+public:
+    explicit StageTimer(MetricStage stage)
+        : stage_(stage), active_(Metrics::instance().enabled() && !Metrics::threadPaused()) {
+        if (active_) start_ = std::chrono::steady_clock::now();
+    }
+
+    ~StageTimer() {
+        if (!active_) return;
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start_).count();
+        Metrics::instance().record(stage_, static_cast<uint64_t>(us));
+    }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    MetricStage stage_;
+    bool active_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace idverify
+
+#endif // METRICS_H
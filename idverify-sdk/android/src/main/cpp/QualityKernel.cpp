@@ -0,0 +1,181 @@
+#include "QualityKernel.h"
+#include <opencv2/imgproc.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <android/log.h>
+
+#define TAG "QualityKernel"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
+
+using namespace cv;
+using namespace std;
+
+namespace idverify {
+
+namespace {
+
+// int32 lanes are flushed to int64 after this many pixels to avoid overflow
+// (each lane gains at most 2 * 1020^2 per 8 pixels)
+constexpr int FLUSH_PIXELS = 1024;
+
+/**
+ * Laplacian sum and sum of squares for interior pixels of one row
+ * Kernel [0 1 0; 1 -4 1; 0 1 0] (cv::Laplacian with ksize=1)
+ */
+void laplacianRow(const uchar* up, const uchar* c, const uchar* dn, int cols,
+                  int64_t& sum, int64_t& sumSq) {
+    int x = 1;
+    const int end = cols - 1;
+#if CV_SIMD128
+    const v_int16x8 ones = v_setall_s16(1);
+    while (x + 8 <= end) {
+        v_int32x4 vsum = v_setzero_s32();
+        v_int32x4 vsq = v_setzero_s32();
+        const int blockEnd = min(end, x + FLUSH_PIXELS);
+        for (; x + 8 <= blockEnd; x += 8) {
+            v_int16x8 u = v_reinterpret_as_s16(v_load_expand(up + x));
+            v_int16x8 d = v_reinterpret_as_s16(v_load_expand(dn + x));
+            v_int16x8 l = v_reinterpret_as_s16(v_load_expand(c + x - 1));
+            v_int16x8 r = v_reinterpret_as_s16(v_load_expand(c + x + 1));
+            v_int16x8 m = v_reinterpret_as_s16(v_load_expand(c + x));
+            v_int16x8 lap = (u + d) + (l + r) - (m << 2);
+            vsum += v_dotprod(lap, ones);
+            vsq += v_dotprod(lap, lap);
+        }
+        v_int64x2 s0, s1, q0, q1;
+        v_expand(vsum, s0, s1);
+        v_expand(vsq, q0, q1);
+        sum += v_reduce_sum(s0 + s1);
+        sumSq += v_reduce_sum(q0 + q1);
+    }
+#endif
+    for (; x < end; ++x) {
+        int lap = up[x] + dn[x] + c[x - 1] + c[x + 1] - 4 * c[x];
+        sum += lap;
+        sumSq += lap * lap;
+    }
+}
+
+}
+
+FrameQuality QualityKernel::analyze(const Mat& src) {
+    FrameQuality q;
+    q.laplacianVariance = 0.0f;
+    q.blurScore = 0.0f;
+    q.glareRatio = 0.0f;
+    q.meanLuma = 0.0f;
+    q.underexposedRatio = 0.0f;
+    q.contrast = 0.0f;
+    q.localContrast = 0.0f;
+    q.histogram.fill(0);
+    q.valid = false;
+
+    if (src.empty() || src.rows < 3 || src.cols < 3) {
+        LOGE("analyze: Input too small");
+        return q;
+    }
+
+    Mat gray;
+    if (src.channels() == 3 || src.channels() == 4) {
+        cvtColor(src, gray, src.channels() == 4 ? COLOR_BGRA2GRAY : COLOR_BGR2GRAY);
+    } else {
+        gray = src;
+    }
+
+    const int rows = gray.rows;
+    const int cols = gray.cols;
+
+    // Column -> tile lookup so the per-pixel loop has no division
+    vector<uint8_t> tileOfCol(cols);
+    for (int x = 0; x < cols; ++x) {
+        tileOfCol[x] = static_cast<uint8_t>(x * TILES_X / cols);
+    }
+
+    array<uint64_t, TILES_X * TILES_Y> tileSum{};
+    array<uint64_t, TILES_X * TILES_Y> tileSq{};
+    array<uint32_t, TILES_X * TILES_Y> tileCount{};
+    array<uint32_t, 256> levels{};
+    int64_t lapSum = 0;
+    int64_t lapSq = 0;
+
+    for (int y = 0; y < rows; ++y) {
+        const uchar* row = gray.ptr<uchar>(y);
+
+        if (y > 0 && y < rows - 1) {
+            laplacianRow(gray.ptr<uchar>(y - 1), row, gray.ptr<uchar>(y + 1), cols, lapSum, lapSq);
+        }
+
+        // Same row, still in L1: level counts and tile moments
+        const int tileRow = (y * TILES_Y / rows) * TILES_X;
+        uint32_t rowSum[TILES_X] = {0};
+        uint32_t rowSq[TILES_X] = {0};
+        uint32_t rowCount[TILES_X] = {0};
+        for (int x = 0; x < cols; ++x) {
+            const uint32_t v = row[x];
+            const int t = tileOfCol[x];
+            levels[v]++;
+            rowSum[t] += v;
+            rowSq[t] += v * v;
+            rowCount[t]++;
+        }
+        for (int t = 0; t < TILES_X; ++t) {
+            tileSum[tileRow + t] += rowSum[t];
+            tileSq[tileRow + t] += rowSq[t];
+            tileCount[tileRow + t] += rowCount[t];
+        }
+    }
+
+    // Global statistics from the 256-level counts
+    const double total = static_cast<double>(rows) * cols;
+    uint64_t saturated = 0, dark = 0, sum = 0, sumSq = 0;
+    for (int v = 0; v < 256; ++v) {
+        const uint64_t n = levels[v];
+        q.histogram[v >> 2] += static_cast<uint32_t>(n);
+        sum += n * v;
+        sumSq += n * v * v;
+        if (v >= GLARE_LEVEL) saturated += n;
+        if (v < DARK_LEVEL) dark += n;
+    }
+
+    const double mean = sum / total;
+    const double variance = max(0.0, sumSq / total - mean * mean);
+    q.meanLuma = static_cast<float>(mean);
+    q.contrast = static_cast<float>(min(1.0, std::sqrt(variance) / 128.0));
+    q.glareRatio = static_cast<float>(saturated / total);
+    q.underexposedRatio = static_cast<float>(dark / total);
+
+    // Laplacian variance over interior pixels
+    const double lapN = static_cast<double>(rows - 2) * (cols - 2);
+    const double lapMean = lapSum / lapN;
+    const double lapVar = max(0.0, lapSq / lapN - lapMean * lapMean);
+    q.laplacianVariance = static_cast<float>(lapVar);
+    q.blurScore = static_cast<float>(min(100.0, lapVar * 20.0));
+
+    // Per-tile mean / stddev
+    q.tileMean.create(TILES_Y, TILES_X, CV_32F);
+    q.tileStd.create(TILES_Y, TILES_X, CV_32F);
+    double stdSum = 0.0;
+    for (int ty = 0; ty < TILES_Y; ++ty) {
+        for (int tx = 0; tx < TILES_X; ++tx) {
+            const int t = ty * TILES_X + tx;
+            const double n = std::max<uint32_t>(1, tileCount[t]);
+            const double m = tileSum[t] / n;
+            const double sd = std::sqrt(max(0.0, tileSq[t] / n - m * m));
+            q.tileMean.at<float>(ty, tx) = static_cast<float>(m);
+            q.tileStd.at<float>(ty, tx) = static_cast<float>(sd);
+            stdSum += sd;
+        }
+    }
+    q.localContrast = static_cast<float>(min(1.0, stdSum / (TILES_X * TILES_Y) / 128.0));
+    q.valid = true;
+
+    LOGD("analyze: lapVar=%.2f, glare=%.3f, mean=%.1f, contrast=%.3f",
+         lapVar, q.glareRatio, mean, q.contrast);
+
+    return q;
+}
+
+} // namespace idverify
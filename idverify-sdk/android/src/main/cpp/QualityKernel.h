@@ -0,0 +1,59 @@
+#ifndef QUALITY_KERNEL_H
+#define QUALITY_KERNEL_H
+
+#include <opencv2/core.hpp>
+#include <array>
+#include <cstdint>
+
+namespace idverify {
+
+/**
+ * All frame quality metrics from one pass over the luma plane
+ */
+struct FrameQuality {
+    float laplacianVariance;   // Raw variance of the 4-neighbour Laplacian
+    float blurScore;           // 0-100, same scale as calculateBlurScore
+    float glareRatio;          // 0-1, pixels >= GLARE_LEVEL
+    float meanLuma;            // 0-255
+    float underexposedRatio;   // 0-1, pixels < DARK_LEVEL
+    float contrast;            // 0-1, global luma stddev / 128
+    float localContrast;       // 0-1, mean of per-tile stddev / 128
+    std::array<uint32_t, 64> histogram;  // 64-bin luma histogram (4 levels per bin)
+    cv::Mat tileMean;          // CV_32F TILES_Y x TILES_X
+    cv::Mat tileStd;           // CV_32F TILES_Y x TILES_X
+    bool valid;
+};
+
+/**
+ * QualityKernel - Fused blur / glare / exposure / contrast measurement
+ *
+ * Blur, glare and exposure used to walk the image separately (and the blur
+ * path allocated a CV_64F Laplacian). This kernel reads each row once:
+ * the Laplacian is evaluated on int16 lanes with 128-bit universal
+ * intrinsics and its sum / sum of squares accumulate in integers, while the
+ * same cache-hot row feeds the histogram, saturation count and per-tile
+ * mean/variance.
+ */
+class QualityKernel {
+public:
+    /**
+     * Measure a frame
+     * @param src Luma plane (CV_8UC1); color input is converted first
+     * @return FrameQuality (valid=false for images smaller than 3x3)
+     */
+    static FrameQuality analyze(const cv::Mat& src);
+
+    // Tile grid for local statistics
+    static constexpr int TILES_X = 8;
+    static constexpr int TILES_Y = 8;
+
+    // Saturated luma (same level as GlareMap)
+    static constexpr int GLARE_LEVEL = 240;
+
+    // Luma below this counts as underexposed
+    static constexpr int DARK_LEVEL = 32;
+};
+
+} // namespace idverify
+
+#endif // QUALITY_KERNEL_H
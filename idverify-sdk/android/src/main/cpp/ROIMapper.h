@@ -28,6 +28,17 @@ enum class ROIType : int {
     EXPIRY = 7     // Expiry date field (back, from MRZ)
 };
 
+// Number of ROIType values (for per-ROI lookup tables)
+constexpr int ROI_TYPE_COUNT = 8;
+
+/**
+ * Side of the card an ROI type is read from
+ * @return true for back-side types (MRZ, EXPIRY)
+ */
+constexpr bool isBackSideROI(ROIType type) {
+    return type == ROIType::MRZ || type == ROIType::EXPIRY;
+}
+
 /**
  * ROI Region definition
  * All values are normalized percentages (0.0 - 1.0)
@@ -0,0 +1,297 @@
+#include "ScanSession.h"
+#include "Metrics.h"
+#include "VisionProcessor.h"
+#include <algorithm>
+#include <chrono>
+#include <android/log.h>
+
+#define TAG "ScanSession"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
+
+using namespace cv;
+using namespace std;
+
+namespace idverify {
+
+ScanSession::ScanSession(const SessionConfig& config)
+    : config_(config),
+      frameRing_(config.ringFrames),
+      mrzFusion_(config.mrzFusionFrames, config.mrzUpsample),
+      mrzVotes_(config.mrzVoteDecay),
+      governor_(config.governor),
+      cancelRequested_(false),
+      capture_(config.capture),
+      cascadeMemo_(config.memoMaxDistance, config.memoMaxHits),
+      ocrMemo_(config.memoMaxDistance, config.memoMaxHits),
+      memoBackSide_(false),
+      nextFrameId_(1),
+      resetSinceRecorded_(false) {
+    governor_.setBaseSettings(config.pipeline);
+    captured_.score = 0.0f;
+    captured_.frameId = 0;
+    captured_.found = false;
+}
+
+uint64_t ScanSession::addFrame(const Mat& warpedCard, bool isBackSide, float sourceScale) {
+    if (warpedCard.empty()) {
+        LOGE("addFrame: Empty input");
+        return 0;
+    }
+    
+    uint64_t frameId = nextFrameId_++;
+    frameRing_.push(warpedCard, isBackSide, sourceScale, frameId);
+    
+    if (isBackSide) {
+        mrzFusion_.addFrame(VisionProcessor::cropROI(warpedCard, BackROI::MRZ));
+    }
+    
+    return frameId;
+}
+
+BestROI ScanSession::bestROI(ROIType type) const {
+    return frameRing_.bestROI(type);
+}
+
+CascadeResult ScanSession::processFrame(const Mat& frame, bool isBackSide, bool* skipped) {
+    if (!recorder_.isOpen()) {
+        return runFrame(frame, isBackSide, skipped);
+    }
+    
+    // Level and memo state before the frame, so a replay can pin them
+    FrameDecision decision;
+    decision.governorLevel = static_cast<uint8_t>(governor_.level());
+    decision.flags = isBackSide ? FrameDecision::FLAG_BACK_SIDE : 0;
+    if (resetSinceRecorded_) decision.flags |= FrameDecision::FLAG_SESSION_RESET;
+    resetSinceRecorded_ = false;
+    uint64_t memoHits = cascadeMemo_.stats().hits;
+    
+    bool wasSkipped = false;
+    CascadeResult result = runFrame(frame, isBackSide, &wasSkipped);
+    if (skipped != nullptr) *skipped = wasSkipped;
+    
+    decision.result = static_cast<int8_t>(FrameDecision::resultCode(result, wasSkipped));
+    decision.memoHit = cascadeMemo_.stats().hits != memoHits ? 1 : 0;
+    decision.totalMs = result.totalMs;
+    int64_t timestampUs = chrono::duration_cast<chrono::microseconds>(
+            chrono::steady_clock::now() - recordStart_).count();
+    if (!recorder_.write(frame, timestampUs, decision)) {
+        LOGD("processFrame: Recording full or failed, closing");
+        recorder_.close();
+    }
+    return result;
+}
+
+bool ScanSession::startRecording(const string& path, RecordFormat format, int maxFrames) {
+    if (!recorder_.open(path, format, maxFrames)) {
+        return false;
+    }
+    recordStart_ = chrono::steady_clock::now();
+    resetSinceRecorded_ = false;
+    LOGD("startRecording: %s (max %d frames)", path.c_str(), maxFrames);
+    return true;
+}
+
+int ScanSession::stopRecording() {
+    return recorder_.close();
+}
+
+CascadeResult ScanSession::runFrame(const Mat& frame, bool isBackSide, bool* skipped) {
+    if (!governor_.shouldProcess()) {
+        if (skipped != nullptr) *skipped = true;
+        CascadeResult result;
+        result.passed = false;
+        result.rejectedAt = CascadeStage::PRESENCE;
+        result.corners.detected = false;
+        result.corners.confidence = 0.0f;
+        result.motion = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0, false};
+        result.blurScore = 0.0f;
+        result.textGlare = 0.0f;
+        result.stageMs.fill(0.0f);
+        result.totalMs = 0.0f;
+        result.status = ProcessStatus::OK;
+        return result;
+    }
+    if (skipped != nullptr) *skipped = false;
+    Metrics::instance().increment(MetricCounter::FRAMES);
+    
+    // Near-identical to the last processed frame: reuse its result (not re-added to the ring)
+    auto start = chrono::steady_clock::now();
+    selectMemoSide(isBackSide);
+    uint64_t hash = FrameHash::compute(frame);
+    if (const CascadeResult* cached = cascadeMemo_.lookup(hash)) {
+        Metrics::instance().increment(MetricCounter::MEMO_HITS);
+        CascadeResult result = *cached;
+        // Keep the motion reference current, or the next miss sees all drift since the cached frame as one step
+        result.motion = stability_.update(frame);
+        result.stageMs.fill(0.0f);
+        result.totalMs = chrono::duration<float, milli>(chrono::steady_clock::now() - start).count();
+        // Not recorded by the governor: near-zero hits would pull its average under budget
+        return result;
+    }
+    
+    armToken();
+    CascadeResult result = cascade_.run(frame, isBackSide, stability_, governor_.settings(), lastCorners_,
+                                        &cancelToken_);
+    governor_.recordFrame(result.totalMs, result.stageMs);
+    
+    // Motion rejections depend on the previous frame, not on this one
+    if (result.status == ProcessStatus::OK && result.rejectedAt != CascadeStage::QUALITY) {
+        cascadeMemo_.store(hash, result);
+    }
+    
+    // Stopped frames say nothing about where the card is
+    if (result.status == ProcessStatus::OK) {
+        if (result.corners.detected) {
+            lastCorners_ = result.corners.corners;
+        } else if (result.stageMs[static_cast<int>(CascadeStage::DETECTION)] > 0.0f) {
+            lastCorners_.clear();
+        }
+    }
+    
+    if (result.passed && !result.warped.empty()) {
+        // Source pixels per warped pixel, from the longest card edge
+        vector<Point2f> c = VisionProcessor::orderCorners(result.corners.corners);
+        float edge = 0.0f;
+        for (size_t i = 0; i < c.size(); ++i) {
+            edge = max(edge, static_cast<float>(norm(c[(i + 1) % c.size()] - c[i])));
+        }
+        float sourceScale = edge / static_cast<float>(max(result.warped.cols, result.warped.rows));
+        addFrame(result.warped, isBackSide, sourceScale);
+    }
+    
+    return result;
+}
+
+ProcessedFrame ScanSession::processForOCR(const Mat& frame) {
+    if (!governor_.shouldProcess()) {
+        ProcessedFrame skipped;
+        skipped.cardDetected = false;
+        skipped.perspectiveConfidence = 0.0f;
+        skipped.glareScore = 1.0f;
+        skipped.cardWidth = 0;
+        skipped.cardHeight = 0;
+        skipped.status = ProcessStatus::OK;
+        return skipped;
+    }
+    
+    Metrics::instance().increment(MetricCounter::FRAMES);
+    auto start = chrono::steady_clock::now();
+    uint64_t hash = FrameHash::compute(frame);
+    const ProcessedFrame* cached = ocrMemo_.lookup(hash);
+    
+    ProcessedFrame result;
+    if (cached != nullptr) {
+        // Hits are left out of the governor's latency history
+        Metrics::instance().increment(MetricCounter::MEMO_HITS);
+        result = *cached;
+    } else {
+        armToken();
+        result = VisionProcessor::processForOCR(frame, governor_.settings(), lastCorners_, &cancelToken_);
+        if (result.status == ProcessStatus::OK) {
+            ocrMemo_.store(hash, result);
+        }
+        float totalMs = chrono::duration<float, milli>(chrono::steady_clock::now() - start).count();
+        
+        // Only the total is known on this path
+        array<float, CASCADE_STAGE_COUNT> stageMs;
+        stageMs.fill(0.0f);
+        governor_.recordFrame(totalMs, stageMs);
+    }
+    
+    // As in runFrame: stopped frames say nothing about where the card is
+    if (result.status == ProcessStatus::OK) {
+        if (result.cardDetected) {
+            lastCorners_ = result.corners;
+        } else {
+            lastCorners_.clear();
+        }
+    }
+    
+    return result;
+}
+
+CaptureEvent ScanSession::captureStep(const Mat& frame, bool isBackSide, double timestampMs) {
+    CaptureEvent idle;
+    idle.state = capture_.state();
+    idle.previous = idle.state;
+    idle.changed = false;
+    idle.hint = CaptureHint::NONE;
+    
+    if (capture_.state() == CaptureState::CAPTURED) {
+        return idle;
+    }
+    
+    bool skipped = false;
+    uint64_t memoHits = cascadeMemo_.stats().hits;
+    CascadeResult result = processFrame(frame, isBackSide, &skipped);
+    if (skipped || result.status != ProcessStatus::OK) {
+        return idle;
+    }
+    
+    CaptureMetrics metrics = CaptureController::fromCascade(result, frameRing_.latestTextScore());
+    metrics.memoHit = cascadeMemo_.stats().hits != memoHits;
+    CaptureEvent event = capture_.update(metrics, timestampMs);
+    
+    if (event.changed && event.state == CaptureState::CAPTURED) {
+        captured_ = frameRing_.bestFrame(isBackSide);
+        LOGD("captureStep: Captured frame %llu (score %.2f)",
+             static_cast<unsigned long long>(captured_.frameId), captured_.score);
+    }
+    
+    return event;
+}
+
+StabilityResult ScanSession::updateStability(const Mat& frame) {
+    return stability_.update(frame);
+}
+
+FusionResult ScanSession::fuseMRZ() const {
+    return mrzFusion_.fuse();
+}
+
+const MRZConsensusResult& ScanSession::voteMRZ(const string& line1, const string& line2,
+                                               const string& line3, float confidence) {
+    return mrzVotes_.add(line1, line2, line3, confidence);
+}
+
+const MRZConsensusResult& ScanSession::voteMRZ(const MRZReadResult& read) {
+    return mrzVotes_.add(read);
+}
+
+void ScanSession::selectMemoSide(bool isBackSide) {
+    if (isBackSide != memoBackSide_) {
+        cascadeMemo_.invalidate();
+        memoBackSide_ = isBackSide;
+    }
+}
+
+void ScanSession::armToken() {
+    cancelToken_.reset();
+    cancelToken_.setDeadlineAfterMs(config_.frameDeadlineMs);
+    // Checked after the reset: a cancel() racing with it is either wiped and re-applied here or lands after
+    if (cancelRequested_.load()) cancelToken_.cancel();
+}
+
+void ScanSession::reset() {
+    frameRing_.reset();
+    mrzFusion_.reset();
+    mrzVotes_.reset();
+    stability_.reset();
+    cascade_.resetStats();
+    governor_.reset();
+    lastCorners_.clear();
+    capture_.reset();
+    cascadeMemo_.invalidate();
+    cascadeMemo_.resetStats();
+    ocrMemo_.invalidate();
+    ocrMemo_.resetStats();
+    captured_.card.release();
+    captured_.score = 0.0f;
+    captured_.frameId = 0;
+    captured_.found = false;
+    cancelRequested_.store(false);
+    resetSinceRecorded_ = recorder_.isOpen();
+}
+
+} // namespace idverify
@@ -0,0 +1,236 @@
+#ifndef SCAN_SESSION_H
+#define SCAN_SESSION_H
+
+#include <opencv2/core.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "CaptureController.h"
+#include "FrameCascade.h"
+#include "FrameHash.h"
+#include "FrameRecord.h"
+#include "FrameRing.h"
+#include "LatencyGovernor.h"
+#include "MRZConsensus.h"
+#include "MRZFusion.h"
+#include "StabilityEngine.h"
+
+namespace idverify {
+
+/**
+ * Session configuration (fixed for the lifetime of a ScanSession)
+ */
+struct SessionConfig {
+    int mrzFusionFrames = 5;     // MRZ crops kept for multi-frame fusion
+    bool mrzUpsample = true;     // Fuse MRZ onto a 2x grid
+    int ringFrames = 8;          // Warped cards kept for best-ROI selection (K)
+    GovernorConfig governor;     // Per-frame latency budget and hysteresis
+    PipelineSettings pipeline;   // Governor level-0 settings (device profile)
+    float frameDeadlineMs = 0.0f;  // Per-frame deadline for processFrame/processForOCR (0 = none)
+    CaptureConfig capture;       // Auto-capture hysteresis and dwell
+    int memoMaxDistance = 4;     // Frame-hash bits for reusing the last result (-1 = off)
+    int memoMaxHits = 15;        // Consecutive reuses before a forced recompute
+    float mrzVoteDecay = 0.9f;   // Weight kept by earlier MRZ votes on each new read
+};
+
+/**
+ * ScanSession - Native state that lives across frames of one scan
+ *
+ * Static VisionProcessor functions stay stateless; anything that needs
+ * history (previous frames, buffered crops) is owned here. One session
+ * per scanning screen, driven from the single analysis thread; only
+ * cancel() may be called from other threads.
+ */
+class ScanSession {
+public:
+    explicit ScanSession(const SessionConfig& config = SessionConfig());
+    
+    /**
+     * Feed a warped card into the best-frame ring
+     * Back-side frames also buffer their MRZ band for fusion
+     * @param warpedCard 856x540 warped card image
+     * @param isBackSide True for back-side frames
+     * @param sourceScale Source pixels per warped pixel (card width / 856)
+     * @return Session frame id assigned to this frame
+     */
+    uint64_t addFrame(const cv::Mat& warpedCard, bool isBackSide, float sourceScale = 1.0f);
+    
+    /**
+     * Best crop of a field across the last K frames (no rescoring)
+     * @param type ROI type
+     * @return BestROI (found=false if no matching frame buffered)
+     */
+    BestROI bestROI(ROIType type) const;
+    
+    /**
+     * Run a camera frame through the quality cascade under the latency governor
+     * Frames that pass every stage are added to the ring (and MRZ fusion);
+     * frames whose hash is close to the last processed one reuse its result
+     * @param frame BGR camera frame
+     * @param isBackSide True when scanning the back side
+     * @param skipped Set to true if the governor skipped this frame
+     * @return CascadeResult (rejectedAt tells which stage dropped the frame)
+     */
+    CascadeResult processFrame(const cv::Mat& frame, bool isBackSide, bool* skipped = nullptr);
+    
+    /**
+     * Full OCR preprocessing (processForOCR) with governed settings and tracking
+     * @param frame BGR camera frame
+     * @return ProcessedFrame (cardDetected=false also when the frame was skipped);
+     *         images may be shared with the frame-hash memo, treat them as read-only
+     */
+    ProcessedFrame processForOCR(const cv::Mat& frame);
+    
+    /**
+     * Auto-capture step: cascade + capture state machine in one call
+     * Once CAPTURED, frames are no longer processed until reset(); memo hits
+     * advance the dwell time but do not count toward minDwellFrames
+     * @param frame BGR camera frame
+     * @param isBackSide True when scanning the back side
+     * @param timestampMs Camera timestamp of the frame (monotonic), so dwell
+     *                    time follows capture time and replays deterministically
+     * @return CaptureEvent (changed=false for skipped or cancelled frames)
+     */
+    CaptureEvent captureStep(const cv::Mat& frame, bool isBackSide, double timestampMs);
+    
+    /**
+     * Frame chosen when the controller reached CAPTURED
+     * @return BestFrame (found=false before capture)
+     */
+    const BestFrame& capturedFrame() const { return captured_; }
+    
+    void configureCapture(const CaptureConfig& config) { capture_.configure(config); }
+    
+    // Frame-hash memo counters of processFrame / processForOCR
+    const MemoStats& cascadeMemoStats() const { return cascadeMemo_.stats(); }
+    const MemoStats& ocrMemoStats() const { return ocrMemo_.stats(); }
+    CaptureState captureState() const { return capture_.state(); }
+    
+    LatencyGovernor& governor() { return governor_; }
+    
+    /**
+     * Stop the frame currently being processed and every later one (safe from any thread)
+     * Sticky: a cancel that lands between frames still stops the next frame;
+     * only resume() or reset() lets frames run again
+     */
+    void cancel() {
+        cancelRequested_.store(true);
+        cancelToken_.cancel();
+    }
+    
+    /**
+     * Clear a cancel() so frames are processed again (history is kept)
+     */
+    void resume() { cancelRequested_.store(false); }
+    
+    /**
+     * Change the per-frame deadline (0 = none)
+     */
+    void setFrameDeadline(float ms) { config_.frameDeadlineMs = ms; }
+    
+    /**
+     * Replace cascade order / thresholds
+     * @return false if the stage order was invalid (default order kept)
+     */
+    bool configureCascade(const CascadeConfig& config) { return cascade_.configure(config); }
+    
+    const CascadeStats& cascadeStats() const { return cascade_.stats(); }
+    
+    /**
+     * Estimate camera motion against the previous camera frame
+     * @param frame Raw camera frame (any size/format)
+     * @return StabilityResult (valid=false on the first frame)
+     */
+    StabilityResult updateStability(const cv::Mat& frame);
+    
+    /**
+     * Fuse buffered MRZ crops into one binarized MRZ image
+     * @return FusionResult (valid=false if nothing buffered)
+     */
+    FusionResult fuseMRZ() const;
+    
+    /**
+     * Vote one frame's MRZ text into the session consensus
+     * @param confidence Recognizer confidence of the read (0-1)
+     * @return Current consensus (accepted once all four check digits hold)
+     */
+    const MRZConsensusResult& voteMRZ(const std::string& line1, const std::string& line2,
+                                      const std::string& line3, float confidence = 1.0f);
+    
+    /**
+     * Vote a native MRZReader read into the session consensus
+     */
+    const MRZConsensusResult& voteMRZ(const MRZReadResult& read);
+    
+    const MRZConsensusResult& mrzConsensus() const { return mrzVotes_.result(); }
+    
+    /**
+     * Clear all per-session history (e.g. card flipped or screen restarted)
+     */
+    void reset();
+    
+    const SessionConfig& config() const { return config_; }
+    
+    /**
+     * Record every processFrame input and decision to a .idvr file
+     * Off by default; recordings hold raw card images, so only enable for
+     * explicit debugging sessions and delete the file after use
+     * @param path Output file (truncated)
+     * @param format Stored pixel layout (RGBA8/BGR8 for bit-exact replay)
+     * @param maxFrames Recording stops silently after this many frames
+     * @return false if the file cannot be created
+     */
+    bool startRecording(const std::string& path, RecordFormat format = RecordFormat::Y8,
+                        int maxFrames = 300);
+    
+    /**
+     * Finish the recording started by startRecording()
+     * @return Frames recorded (-1 if not recording or the file could not be finalized)
+     */
+    int stopRecording();
+    
+    bool isRecording() const { return recorder_.isOpen(); }
+    
+private:
+    /**
+     * processFrame without recording
+     */
+    CascadeResult runFrame(const cv::Mat& frame, bool isBackSide, bool* skipped);
+    
+
+    /**
+     * Clear the token and start the per-frame deadline (stays cancelled after cancel())
+     */
+    void armToken();
+    
+    /**
+     * Drop the memoized cascade result when the scanned side changes
+     */
+    void selectMemoSide(bool isBackSide);
+    
+    SessionConfig config_;
+    FrameRing frameRing_;
+    MRZFusion mrzFusion_;
+    MRZConsensus mrzVotes_;                // Per-character MRZ votes across frames
+    StabilityEngine stability_;
+    FrameCascade cascade_;
+    LatencyGovernor governor_;
+    std::vector<cv::Point> lastCorners_;   // Last detected quad, for tracking
+    CancellationToken cancelToken_;        // Re-armed per frame
+    std::atomic<bool> cancelRequested_;    // Sticky cancel(), re-applied to every armed token
+    CaptureController capture_;
+    BestFrame captured_;                   // Filled on CAPTURED
+    HashMemo<CascadeResult> cascadeMemo_;  // Last cascade result by frame hash
+    HashMemo<ProcessedFrame> ocrMemo_;     // Last processForOCR result by frame hash
+    bool memoBackSide_;                    // Side the memoized cascade result belongs to
+    uint64_t nextFrameId_;
+    FrameRecorder recorder_;               // Open only while recording
+    std::chrono::steady_clock::time_point recordStart_;
+    bool resetSinceRecorded_;              // Flag the next recorded frame
+};
+
+} // namespace idverify
+
+#endif // SCAN_SESSION_H
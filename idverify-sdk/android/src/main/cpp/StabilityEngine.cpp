@@ -0,0 +1,121 @@
+#include "StabilityEngine.h"
+#include <opencv2/imgproc.hpp>
+#include <opencv2/video/tracking.hpp>
+#include <opencv2/calib3d.hpp>
+#include <cmath>
+#include <android/log.h>
+
+#define TAG "StabilityEngine"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
+
+using namespace cv;
+using namespace std;
+
+namespace idverify {
+
+namespace {
+
+constexpr int MAX_FEATURES = 60;
+constexpr int MIN_TRACKS = 8;
+constexpr double RANSAC_THRESHOLD = 1.0;  // Analysis-level px
+
+}
+
+StabilityEngine::StabilityEngine() : scale_(1.0f) {}
+
+StabilityResult StabilityEngine::update(const Mat& frame) {
+    StabilityResult result = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0, false};
+
+    if (frame.empty()) {
+        LOGE("update: Empty frame");
+        return result;
+    }
+
+    // Downscale first, then convert: the full-res frame is read exactly once
+    scale_ = static_cast<float>(frame.cols) / ANALYSIS_WIDTH;
+    int height = max(1, cvRound(frame.rows / scale_));
+    resize(frame, small_, Size(ANALYSIS_WIDTH, height), 0, 0, INTER_AREA);
+    if (small_.channels() == 3 || small_.channels() == 4) {
+        cvtColor(small_, currGray_, small_.channels() == 4 ? COLOR_BGRA2GRAY : COLOR_BGR2GRAY);
+    } else {
+        small_.copyTo(currGray_);
+    }
+
+    if (prevGray_.empty() || prevGray_.size() != currGray_.size()) {
+        swap(prevGray_, currGray_);
+        goodFeaturesToTrack(prevGray_, prevPoints_, MAX_FEATURES, 0.01, 6);
+        return result;
+    }
+
+    double dx = 0.0, dy = 0.0, angle = 0.0;
+    bool estimated = false;
+
+    // 1. Sparse LK flow + RANSAC similarity (translation + rotation)
+    if (static_cast<int>(prevPoints_.size()) >= MIN_TRACKS) {
+        vector<Point2f> currPoints;
+        vector<uchar> status;
+        vector<float> err;
+        calcOpticalFlowPyrLK(prevGray_, currGray_, prevPoints_, currPoints, status, err,
+                             Size(15, 15), 2);
+
+        vector<Point2f> from, to;
+        for (size_t i = 0; i < status.size(); ++i) {
+            if (status[i]) {
+                from.push_back(prevPoints_[i]);
+                to.push_back(currPoints[i]);
+            }
+        }
+
+        if (static_cast<int>(from.size()) >= MIN_TRACKS) {
+            vector<uchar> inliers;
+            Mat M = estimateAffinePartial2D(from, to, inliers, RANSAC, RANSAC_THRESHOLD);
+            int inlierCount = countNonZero(inliers);
+            if (!M.empty() && inlierCount >= MIN_TRACKS) {
+                dx = M.at<double>(0, 2);
+                dy = M.at<double>(1, 2);
+                angle = atan2(M.at<double>(1, 0), M.at<double>(0, 0));
+                result.trackedPoints = inlierCount;
+                estimated = true;
+            }
+        }
+    }
+
+    // 2. Fallback: phase correlation (translation only)
+    if (!estimated) {
+        Mat prevF, currF;
+        prevGray_.convertTo(prevF, CV_32F);
+        currGray_.convertTo(currF, CV_32F);
+        Point2d shift = phaseCorrelate(prevF, currF);
+        dx = shift.x;
+        dy = shift.y;
+    }
+
+    // Report in full-frame pixels; rotation contributes its arc at the frame edge
+    const double radius = 0.5 * ANALYSIS_WIDTH;
+    const double translation = sqrt(dx * dx + dy * dy);
+    const double motion = (translation + fabs(angle) * radius) * scale_;
+
+    result.dx = static_cast<float>(dx * scale_);
+    result.dy = static_cast<float>(dy * scale_);
+    result.rotationDeg = static_cast<float>(angle * 180.0 / CV_PI);
+    result.motionPx = static_cast<float>(motion);
+    result.stability = HALF_STABILITY_PX / (HALF_STABILITY_PX + result.motionPx);
+    result.valid = true;
+
+    // Retain this level for the next frame
+    swap(prevGray_, currGray_);
+    goodFeaturesToTrack(prevGray_, prevPoints_, MAX_FEATURES, 0.01, 6);
+
+    LOGD("update: motion=%.2fpx (dx=%.2f, dy=%.2f, rot=%.2fdeg, tracks=%d)",
+         result.motionPx, result.dx, result.dy, result.rotationDeg, result.trackedPoints);
+
+    return result;
+}
+
+void StabilityEngine::reset() {
+    prevGray_.release();
+    prevPoints_.clear();
+}
+
+} // namespace idverify
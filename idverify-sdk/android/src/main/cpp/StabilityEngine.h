@@ -0,0 +1,63 @@
+#ifndef STABILITY_ENGINE_H
+#define STABILITY_ENGINE_H
+
+#include <opencv2/core.hpp>
+#include <vector>
+
+namespace idverify {
+
+/**
+ * Global inter-frame motion estimate
+ */
+struct StabilityResult {
+    float dx;              // Translation X in full-frame pixels per frame
+    float dy;              // Translation Y in full-frame pixels per frame
+    float rotationDeg;     // In-plane rotation in degrees per frame
+    float motionPx;        // |translation| + rotation arc at frame edge, full-frame px/frame
+    float stability;       // 0-1, 1 = no motion (for UI; gate on motionPx)
+    int trackedPoints;     // LK inliers (0 when phase correlation fallback was used)
+    bool valid;            // False on the first frame after reset
+};
+
+/**
+ * StabilityEngine - Camera-motion estimate from a small luma level
+ *
+ * Keeps only a ~160 px wide luma image of the previous frame. Global
+ * translation and rotation come from sparse LK optical flow with a
+ * RANSAC similarity fit; phase correlation is the fallback for textureless
+ * frames. Both are insensitive to global brightness changes, so lighting
+ * flicker no longer reads as shake the way a mean absdiff did.
+ */
+class StabilityEngine {
+public:
+    StabilityEngine();
+
+    /**
+     * Estimate motion between the previous and this frame, then retain this one
+     * @param frame Camera frame (gray, BGR or RGBA)
+     * @return StabilityResult (valid=false for the first frame)
+     */
+    StabilityResult update(const cv::Mat& frame);
+
+    /**
+     * Forget the previous frame
+     */
+    void reset();
+
+    // Width of the retained luma level
+    static constexpr int ANALYSIS_WIDTH = 160;
+
+    // Motion (full-frame px/frame) at which stability reaches 0.5
+    static constexpr float HALF_STABILITY_PX = 8.0f;
+
+private:
+    cv::Mat prevGray_;                    // Previous analysis-level luma
+    std::vector<cv::Point2f> prevPoints_; // Features detected on prevGray_
+    cv::Mat currGray_;                    // Reused buffers
+    cv::Mat small_;
+    float scale_;                         // Full-frame px per analysis px
+};
+
+} // namespace idverify
+
+#endif // STABILITY_ENGINE_H
@@ -0,0 +1,187 @@
+#include "Trace.h"
+#include "Metrics.h"
+#include <cinttypes>
+#include <cstdio>
+#include <android/log.h>
+
+#ifdef __ANDROID__
+#include <android/trace.h>
+#else
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#endif
+
+#define TAG "Trace"
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
+
+using namespace std;
+
+namespace idverify {
+
+namespace {
+
+using Clock = chrono::steady_clock;
+
+atomic<uint64_t> gNextFrame(1);
+thread_local uint64_t tCurrentFrame = 0;
+
+#ifndef __ANDROID__
+/**
+ * One complete ("ph":"X") event
+ */
+struct HostEvent {
+    const char* name;
+    uint64_t frameId;
+    const char* argNames[Trace::MAX_ARGS];
+    int64_t argValues[Trace::MAX_ARGS];
+    int argCount;
+    int64_t tsUs;
+    int64_t durUs;
+    uint32_t tid;
+};
+
+mutex gEventMutex;
+vector<HostEvent> gEvents;
+Clock::time_point gEpoch = Clock::now();
+
+uint32_t threadId() {
+    static thread_local uint32_t tid =
+            static_cast<uint32_t>(hash<thread::id>()(this_thread::get_id()) & 0x7fffffff);
+    return tid;
+}
+#endif
+
+}
+
+atomic<bool> Trace::enabled_(false);
+
+void Trace::setEnabled(bool enabled) {
+    enabled_.store(enabled, memory_order_relaxed);
+    LOGD("setEnabled: %d", enabled ? 1 : 0);
+}
+
+uint64_t Trace::beginFrame() {
+    tCurrentFrame = gNextFrame.fetch_add(1, memory_order_relaxed);
+    return tCurrentFrame;
+}
+
+uint64_t Trace::currentFrame() {
+    return tCurrentFrame;
+}
+
+void Trace::emit(const char* name, uint64_t frameId,
+                 const char* const* argNames, const int64_t* argValues, int argCount,
+                 Clock::time_point start, Clock::time_point end) {
+#ifdef __ANDROID__
+    // ATrace sections are emitted live by TraceSpan
+    (void) name; (void) frameId; (void) argNames; (void) argValues; (void) argCount;
+    (void) start; (void) end;
+#else
+    HostEvent e;
+    e.name = name;
+    e.frameId = frameId;
+    e.argCount = argCount;
+    for (int i = 0; i < argCount; ++i) {
+        e.argNames[i] = argNames[i];
+        e.argValues[i] = argValues[i];
+    }
+    e.tsUs = chrono::duration_cast<chrono::microseconds>(start - gEpoch).count();
+    e.durUs = chrono::duration_cast<chrono::microseconds>(end - start).count();
+    e.tid = threadId();
+
+    lock_guard<mutex> lock(gEventMutex);
+    if (gEvents.size() < MAX_EVENTS) {
+        gEvents.push_back(e);
+    }
+#endif
+}
+
+bool Trace::writeJson(const string& path) {
+#ifdef __ANDROID__
+    (void) path;
+    return false;
+#else
+    vector<HostEvent> events;
+    {
+        lock_guard<mutex> lock(gEventMutex);
+        events.swap(gEvents);
+    }
+
+    ofstream out(path, ios::trunc);
+    if (!out) {
+        LOGE("writeJson: Cannot open %s", path.c_str());
+        return false;
+    }
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    for (size_t i = 0; i < events.size(); ++i) {
+        const HostEvent& e = events[i];
+        out << "{\"name\":\"" << e.name << "\",\"cat\":\"idverify\",\"ph\":\"X\""
+            << ",\"ts\":" << e.tsUs << ",\"dur\":" << e.durUs
+            << ",\"pid\":1,\"tid\":" << e.tid
+            << ",\"args\":{\"frame\":" << e.frameId;
+        for (int a = 0; a < e.argCount; ++a) {
+            out << ",\"" << e.argNames[a] << "\":" << e.argValues[a];
+        }
+        out << "}}" << (i + 1 < events.size() ? ",\n" : "\n");
+    }
+    out << "]}\n";
+    return static_cast<bool>(out);
+#endif
+}
+
+void Trace::clear() {
+#ifndef __ANDROID__
+    lock_guard<mutex> lock(gEventMutex);
+    gEvents.clear();
+#endif
+}
+
+// ==================== TraceSpan ====================
+
+TraceSpan::TraceSpan(const char* name, const char* key1, int64_t value1,
+                     const char* key2, int64_t value2)
+    : name_(name), active_(Trace::enabled() && !Metrics::threadPaused()), argCount_(0), frameId_(0) {
+    if (!active_) return;
+
+    frameId_ = tCurrentFrame;
+    if (key1 != nullptr) {
+        argNames_[argCount_] = key1;
+        argValues_[argCount_++] = value1;
+    }
+    if (key2 != nullptr) {
+        argNames_[argCount_] = key2;
+        argValues_[argCount_++] = value2;
+    }
+
+#ifdef __ANDROID__
+    if (!ATrace_isEnabled()) {
+        active_ = false;
+        return;
+    }
+    // Section names carry the tags: "warpToID1 frame=42 interp=2"
+    char label[128];
+    int n = snprintf(label, sizeof(label), "%s frame=%" PRIu64, name_, frameId_);
+    for (int i = 0; i < argCount_ && n > 0 && n < static_cast<int>(sizeof(label)); ++i) {
+        n += snprintf(label + n, sizeof(label) - n, " %s=%" PRId64, argNames_[i], argValues_[i]);
+    }
+    ATrace_beginSection(label);
+#else
+    start_ = Clock::now();
+#endif
+}
+
+TraceSpan::~TraceSpan() {
+    if (!active_) return;
+#ifdef __ANDROID__
+    ATrace_endSection();
+#else
+    Trace::emit(name_, frameId_, argNames_, argValues_, argCount_, start_, Clock::now());
+#endif
+}
+
+} // namespace idverify
@@ -0,0 +1,101 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace idverify {
+
+/**
+ * Trace - Runtime-switchable timeline tracing
+ *
+ * On Android spans become ATrace sections (visible in Perfetto/systrace
+ * with the "app" category). On a Linux host they are buffered in memory
+ * and written as Chrome/Perfetto JSON ("traceEvents", complete events).
+ * Spans carry the current frame id and up to MAX_ARGS integer arguments
+ * (stage parameters such as pyramid level or denoise tier).
+ */
+class Trace {
+public:
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+    static void setEnabled(bool enabled);
+
+    /**
+     * Start a new frame on the calling thread; later spans are tagged with it
+     * @return The new frame id
+     */
+    static uint64_t beginFrame();
+
+    /**
+     * Frame id spans on this thread are tagged with (0 = none)
+     */
+    static uint64_t currentFrame();
+
+    /**
+     * Write buffered host events as Chrome/Perfetto JSON and clear the buffer
+     * No-op returning false on Android (events go to ATrace)
+     * @param path Output .json path
+     */
+    static bool writeJson(const std::string& path);
+
+    /**
+     * Drop buffered host events
+     */
+    static void clear();
+
+    static constexpr int MAX_ARGS = 2;
+
+    // Host buffer limit; older events are kept, newer ones dropped
+    static constexpr size_t MAX_EVENTS = 1 << 18;
+
+private:
+    friend class TraceSpan;
+
+    static void emit(const char* name, uint64_t frameId,
+                     const char* const* argNames, const int64_t* argValues, int argCount,
+                     std::chrono::steady_clock::time_point start,
+                     std::chrono::steady_clock::time_point end);
+
+    static std::atomic<bool> enabled_;
+};
+
+/**
+ * TraceSpan - Scoped trace section
+ *
+ * When tracing is disabled (or the thread is in an InstrumentationPause)
+ * the constructor is one relaxed load and the span does nothing else.
+ *
+ *   TraceSpan span("findCardCorners", "level", pyramidLevel);
+ */
+class TraceSpan {
+public:
+    /**
+     * @param name Static string (not copied)
+     * @param key1 Optional argument name (static string)
+     * @param value1 Argument value
+     * @param key2 Optional second argument name (static string)
+     * @param value2 Second argument value
+     */
+    explicit TraceSpan(const char* name,
+                       const char* key1 = nullptr, int64_t value1 = 0,
+                       const char* key2 = nullptr, int64_t value2 = 0);
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name_;
+    bool active_;
+    int argCount_;
+    uint64_t frameId_;
+    const char* argNames_[Trace::MAX_ARGS];
+    int64_t argValues_[Trace::MAX_ARGS];
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace idverify
+
+#endif // TRACE_H
@@ -1,4 +1,11 @@
 #include "VisionProcessor.h"
+#include "GlareMap.h"
+#include "MRZDecoder.h"
+#include "MRZLocator.h"
+#include "MRZParser.h"
+#include "QualityKernel.h"
+#include "Metrics.h"
+#include "Trace.h"
 #include <opencv2/imgproc.hpp>
 #include <opencv2/calib3d.hpp>
 #include <opencv2/photo.hpp>
@@ -18,20 +25,45 @@ namespace idverify {
 // ==================== VisionProcessor Implementation ====================
 
 ProcessedFrame VisionProcessor::processForOCR(const Mat& inputRGB) {
+    return processForOCR(inputRGB, PipelineSettings());
+}
+
+ProcessedFrame VisionProcessor::processForOCR(const Mat& inputRGB, const PipelineSettings& settings,
+                                              const vector<Point>& previousCorners,
+                                              const CancellationToken* token) {
     ProcessedFrame result;
     result.cardDetected = false;
     result.perspectiveConfidence = 0.0f;
     result.glareScore = 1.0f;
     result.cardWidth = 0;
     result.cardHeight = 0;
+    result.status = ProcessStatus::OK;
+    
+    TraceSpan span("processForOCR", "level", settings.detectionPyramidLevel,
+                   "denoise", static_cast<int>(settings.denoise));
     
     if (inputRGB.empty()) {
         LOGE("processForOCR: Empty input image");
         return result;
     }
     
-    // Step 1: Find card corners
-    CornerResult corners = findCardCorners(inputRGB);
+    // Step 1: Find card corners (near the previous quad first when tracking)
+    CornerResult corners;
+    corners.detected = false;
+    if (settings.useTracking && previousCorners.size() == 4) {
+        corners = trackCardCorners(inputRGB, previousCorners, settings.detectionPyramidLevel, token);
+    }
+    if (!corners.detected && corners.status == ProcessStatus::OK) {
+        corners = findCardCorners(inputRGB, settings.detectionPyramidLevel, token);
+    }
+    
+    // A quad found before the stop is not trusted: the best contour may not have been seen
+    if (corners.status != ProcessStatus::OK) {
+        LOGD("processForOCR: Stopped during detection (%d)", static_cast<int>(corners.status));
+        Metrics::instance().increment(MetricCounter::CANCELLED);
+        result.status = corners.status;
+        return result;
+    }
     
     if (!corners.detected) {
         LOGD("processForOCR: Card not detected");
@@ -39,29 +71,46 @@ ProcessedFrame VisionProcessor::processForOCR(const Mat& inputRGB) {
     }
     
     result.cardDetected = true;
+    result.corners = corners.corners;
     result.perspectiveConfidence = corners.confidence;
     
-    // Step 2: Check glare before processing
-    result.glareScore = detectGlare(inputRGB);
-    
-    // Step 3: Warp to ID-1 standard
-    Mat warped = warpToID1(inputRGB, corners.corners);
+    // Step 2: Warp to ID-1 standard
+    result.status = CancellationToken::statusOf(token);
+    if (result.status != ProcessStatus::OK) {
+        Metrics::instance().increment(MetricCounter::CANCELLED);
+        return result;
+    }
+    Mat warped = warpToID1(inputRGB, corners.corners, settings.warpInterpolation);
     
     if (warped.empty()) {
         LOGE("processForOCR: Warp failed");
         result.cardDetected = false;
+        result.corners.clear();
         return result;
     }
     
+    // Step 3: Glare on the card only (background highlights are ignored)
+    result.glareScore = GlareMap::compute(warped, false).cardGlare;
+    
     result.normalized = warped.clone();
     result.cardWidth = warped.cols;
     result.cardHeight = warped.rows;
     
     // Step 4: Binarize for OCR (hologram removal)
-    result.binarized = binarizeForOCR(warped);
+    result.binarized = binarizeForOCR(warped, settings.denoise, token, &result.status);
+    if (result.status != ProcessStatus::OK) {
+        LOGD("processForOCR: Stopped during binarization (%d)", static_cast<int>(result.status));
+        Metrics::instance().increment(MetricCounter::CANCELLED);
+        return result;
+    }
     
     // Step 5: Extract MRZ region
-    result.mrzRegion = extractMRZRegion(warped);
+    result.mrzRegion = extractMRZRegion(warped, settings.denoise, token, &result.status);
+    if (result.status != ProcessStatus::OK) {
+        LOGD("processForOCR: Stopped during MRZ extraction (%d)", static_cast<int>(result.status));
+        Metrics::instance().increment(MetricCounter::CANCELLED);
+        return result;
+    }
     
     LOGD("processForOCR: Success, confidence=%.2f, glare=%.2f", 
          result.perspectiveConfidence, result.glareScore);
@@ -70,15 +119,21 @@ ProcessedFrame VisionProcessor::processForOCR(const Mat& inputRGB) {
 }
 
 CornerResult VisionProcessor::findCardCorners(const Mat& src) {
+    StageTimer timer(MetricStage::DETECT);
+    TraceSpan span("findCardCorners", "level", 0);
+    return detectCorners(src, nullptr);
+}
+
+CornerResult VisionProcessor::detectCorners(const Mat& src, const CancellationToken* token) {
     CornerResult result;
     result.detected = false;
     result.confidence = 0.0f;
     
     if (src.empty()) {
-        LOGE("DEBUG_VISION: Empty src");
+        LOGD("DEBUG_VISION: Empty src");
         return result;
     }
-    LOGE("DEBUG_VISION: Processing frame %dx%d", src.cols, src.rows);
+    LOGD("DEBUG_VISION: Processing frame %dx%d", src.cols, src.rows);
     
     Mat gray, blurred, edged;
     
@@ -92,6 +147,10 @@ CornerResult VisionProcessor::findCardCorners(const Mat& src) {
     // Apply Gaussian blur to reduce noise
     GaussianBlur(gray, blurred, Size(5, 5), 0);
     
+    if ((result.status = CancellationToken::statusOf(token)) != ProcessStatus::OK) {
+        return result;
+    }
+    
     // Edge detection with adaptive thresholds
     double median = 0;
     {
@@ -102,22 +161,30 @@ CornerResult VisionProcessor::findCardCorners(const Mat& src) {
     }
     double lower = 30.0; // max(0.0, 0.66 * median);
     double upper = 100.0; // min(255.0, 1.33 * median);
-    LOGE("DEBUG_VISION: Canny thresholds %.1f, %.1f", lower, upper);
+    LOGD("DEBUG_VISION: Canny thresholds %.1f, %.1f", lower, upper);
     Canny(blurred, edged, lower, upper);
     
     // Dilate to close gaps
     Mat kernel = getStructuringElement(MORPH_RECT, Size(3, 3));
     dilate(edged, edged, kernel, Point(-1, -1), 2);
     
+    if ((result.status = CancellationToken::statusOf(token)) != ProcessStatus::OK) {
+        return result;
+    }
+    
     // Find contours (RETR_LIST for better back-side compatibility)
     vector<vector<Point>> contours;
     findContours(edged, contours, RETR_LIST, CHAIN_APPROX_SIMPLE);
     
+    if ((result.status = CancellationToken::statusOf(token)) != ProcessStatus::OK) {
+        return result;
+    }
+    
     if (contours.empty()) {
-        LOGE("DEBUG_VISION: No contours found");
+        LOGD("DEBUG_VISION: No contours found");
         return result;
     }
-    LOGE("DEBUG_VISION: Found %zu contours", contours.size());
+    LOGD("DEBUG_VISION: Found %zu contours", contours.size());
     
     // Filter and find best quadrilateral
     // Back to 5% for better back-side detection
@@ -125,13 +192,20 @@ CornerResult VisionProcessor::findCardCorners(const Mat& src) {
     vector<Point> bestApprox;
     double bestScore = 0;
     
-    for (const auto& contour : contours) {
+    for (size_t i = 0; i < contours.size(); ++i) {
+        const auto& contour = contours[i];
+        
+        // Poll every 64 contours; the quad found so far is returned with the status
+        if ((i & 63) == 63 && (result.status = CancellationToken::statusOf(token)) != ProcessStatus::OK) {
+            break;
+        }
+        
         double area = contourArea(contour);
         
         // Skip too small contours
         // SKip too small contours
         if (area < minArea) {
-             // LOGE("DEBUG_VISION: Skip small contour area=%.0f < %.0f", area, minArea);
+             // LOGD("DEBUG_VISION: Skip small contour area=%.0f < %.0f", area, minArea);
              continue;
         }
         
@@ -149,12 +223,12 @@ CornerResult VisionProcessor::findCardCorners(const Mat& src) {
         // Calculate aspect ratio
         float aspectRatio = calculateAspectRatio(approx);
         
-        LOGE("DEBUG_VISION: Contour area=%.0f, ratio=%.2f", area, aspectRatio);
+        LOGD("DEBUG_VISION: Contour area=%.0f, ratio=%.2f", area, aspectRatio);
 
         // ID-1 aspect ratio is ~1.5858 (Landscape) or ~0.63 (Portrait)
         // Accept ALMOST ANYTHING for debugging
         if (aspectRatio < 0.2f || aspectRatio > 5.0f) {
-             LOGE("DEBUG_VISION: Reject ratio %.2f", aspectRatio);
+             LOGD("DEBUG_VISION: Reject ratio %.2f", aspectRatio);
              continue;
         }
         
@@ -170,13 +244,14 @@ CornerResult VisionProcessor::findCardCorners(const Mat& src) {
             // If it fills 50% of screen -> 1.0 confidence
             result.confidence = std::min(1.0, area / (src.rows * src.cols * 0.5));
             
-            LOGE("DEBUG_VISION: New best candidate! Area=%.0f, Conf=%.2f", area, result.confidence);
+            LOGD("DEBUG_VISION: New best candidate! Area=%.0f, Conf=%.2f", area, result.confidence);
         }
     }
     
     if (bestApprox.size() == 4) {
         result.corners = bestApprox;
         result.detected = true;
+        Metrics::instance().increment(MetricCounter::DETECTIONS);
         
         LOGD("findCardCorners: Found with confidence %.2f", result.confidence);
     }
@@ -184,7 +259,82 @@ CornerResult VisionProcessor::findCardCorners(const Mat& src) {
     return result;
 }
 
-Mat VisionProcessor::warpToID1(const Mat& src, const vector<Point>& corners) {
+CornerResult VisionProcessor::findCardCorners(const Mat& src, int pyramidLevel,
+                                              const CancellationToken* token) {
+    StageTimer timer(MetricStage::DETECT);
+    TraceSpan span("findCardCorners", "level", pyramidLevel, "width", src.cols);
+    return detectOnPyramid(src, pyramidLevel, token);
+}
+
+CornerResult VisionProcessor::detectOnPyramid(const Mat& src, int pyramidLevel, const CancellationToken* token) {
+    if (pyramidLevel <= 0 || src.empty()) {
+        return detectCorners(src, token);
+    }
+    
+    // Contours of an ID card survive several pyramid levels; detection cost drops ~4x per level
+    Mat level = src;
+    for (int i = 0; i < pyramidLevel && level.cols >= 160 && level.rows >= 160; ++i) {
+        pyrDown(level, level);
+    }
+    
+    CornerResult result = detectCorners(level, token);
+    
+    // Map corners back to source coordinates
+    double sx = static_cast<double>(src.cols) / level.cols;
+    double sy = static_cast<double>(src.rows) / level.rows;
+    for (auto& p : result.corners) {
+        p.x = cvRound(p.x * sx);
+        p.y = cvRound(p.y * sy);
+    }
+    
+    return result;
+}
+
+CornerResult VisionProcessor::trackCardCorners(const Mat& src, const vector<Point>& previousCorners,
+                                               int pyramidLevel, const CancellationToken* token) {
+    // Timed as DETECT like full detection, so the two can be compared per frame
+    StageTimer timer(MetricStage::DETECT);
+    TraceSpan span("trackCardCorners", "level", pyramidLevel, "width", src.cols);
+    CornerResult result;
+    result.detected = false;
+    result.confidence = 0.0f;
+    
+    if (src.empty() || previousCorners.size() != 4) {
+        return result;
+    }
+    
+    // Search window: previous quad's bounding box grown by 20% per side
+    Rect box = boundingRect(previousCorners);
+    int growX = box.width / 5;
+    int growY = box.height / 5;
+    Rect window(box.x - growX, box.y - growY, box.width + 2 * growX, box.height + 2 * growY);
+    window &= Rect(0, 0, src.cols, src.rows);
+    if (window.width < 32 || window.height < 32) {
+        return result;
+    }
+    
+    result = detectOnPyramid(src(window), pyramidLevel, token);
+    if (!result.detected) {
+        if (result.status == ProcessStatus::OK) {
+            Metrics::instance().increment(MetricCounter::TRACKER_LOSSES);
+        }
+        return result;
+    }
+    
+    for (auto& p : result.corners) {
+        p += window.tl();
+    }
+    
+    // Confidence relative to the full frame, as in findCardCorners
+    double area = contourArea(result.corners);
+    result.confidence = static_cast<float>(std::min(1.0, area / (src.rows * src.cols * 0.5)));
+    
+    return result;
+}
+
+Mat VisionProcessor::warpToID1(const Mat& src, const vector<Point>& corners, int interpolation) {
+    StageTimer timer(MetricStage::WARP);
+    TraceSpan span("warpToID1", "interp", interpolation);
     if (corners.size() != 4 || src.empty()) {
         return Mat();
     }
@@ -209,9 +359,9 @@ Mat VisionProcessor::warpToID1(const Mat& src, const vector<Point>& corners) {
         // Portrait Detected -> Swap dimensions
         dstWidth = TARGET_HEIGHT;
         dstHeight = TARGET_WIDTH;
-        LOGE("DEBUG_VISION: Portrait orientation detected. Warping to %dx%d", dstWidth, dstHeight);
+        LOGD("DEBUG_VISION: Portrait orientation detected. Warping to %dx%d", dstWidth, dstHeight);
     } else {
-        LOGE("DEBUG_VISION: Landscape orientation detected. Warping to %dx%d", dstWidth, dstHeight);
+        LOGD("DEBUG_VISION: Landscape orientation detected. Warping to %dx%d", dstWidth, dstHeight);
     }
 
     // Destination points for ID-1 format
@@ -223,7 +373,7 @@ Mat VisionProcessor::warpToID1(const Mat& src, const vector<Point>& corners) {
     };
     
     // Log ordered corners for debugging (TL, TR, BR, BL)
-    LOGE("DEBUG_VISION: Corners: (%.1f,%.1f), (%.1f,%.1f), (%.1f,%.1f), (%.1f,%.1f)",
+    LOGD("DEBUG_VISION: Corners: (%.1f,%.1f), (%.1f,%.1f), (%.1f,%.1f), (%.1f,%.1f)",
          orderedCorners[0].x, orderedCorners[0].y,
          orderedCorners[1].x, orderedCorners[1].y,
          orderedCorners[2].x, orderedCorners[2].y,
@@ -232,14 +382,18 @@ Mat VisionProcessor::warpToID1(const Mat& src, const vector<Point>& corners) {
     // Calculate perspective transform
     Mat M = getPerspectiveTransform(orderedCorners, dstPoints);
     
-    // Apply warp with High Quality Interpolation (Cubic)
+    // Apply warp (High Quality Cubic interpolation by default)
     Mat warped;
-    warpPerspective(src, warped, M, Size(dstWidth, dstHeight), INTER_CUBIC);
+    warpPerspective(src, warped, M, Size(dstWidth, dstHeight), interpolation);
     
     return warped;
 }
 
-Mat VisionProcessor::binarizeForOCR(const Mat& src) {
+Mat VisionProcessor::binarizeForOCR(const Mat& src, DenoiseTier denoise,
+                                    const CancellationToken* token, ProcessStatus* status) {
+    StageTimer timer(MetricStage::BINARIZE);
+    TraceSpan span("binarizeForOCR", "denoise", static_cast<int>(denoise), "rows", src.rows);
+    if (status != nullptr) *status = ProcessStatus::OK;
     if (src.empty()) {
         return Mat();
     }
@@ -262,7 +416,29 @@ Mat VisionProcessor::binarizeForOCR(const Mat& src) {
     
     // Denoise to remove hologram patterns
     Mat denoised;
-    fastNlMeansDenoising(enhanced, denoised, 10, 7, 21);
+    switch (denoise) {
+        case DenoiseTier::NLM:
+            if (token == nullptr) {
+                fastNlMeansDenoising(enhanced, denoised, 10, 7, 21);
+            } else if (!denoiseNLMStrips(enhanced, denoised, token)) {
+                if (status != nullptr) *status = token->status();
+                return Mat();
+            }
+            break;
+        case DenoiseTier::GAUSSIAN:
+            GaussianBlur(enhanced, denoised, Size(5, 5), 0);
+            break;
+        case DenoiseTier::NONE:
+        default:
+            denoised = enhanced;
+            break;
+    }
+    
+    ProcessStatus current = CancellationToken::statusOf(token);
+    if (current != ProcessStatus::OK) {
+        if (status != nullptr) *status = current;
+        return Mat();
+    }
     
     // Adaptive thresholding for text extraction
     // Block size 15, C=10 works well for OCR-B font on ID cards
@@ -282,7 +458,9 @@ Mat VisionProcessor::binarizeForOCR(const Mat& src) {
     return cleaned;
 }
 
-Mat VisionProcessor::extractMRZRegion(const Mat& src) {
+Mat VisionProcessor::extractMRZRegion(const Mat& src, DenoiseTier denoise,
+                                      const CancellationToken* token, ProcessStatus* status) {
+    if (status != nullptr) *status = ProcessStatus::OK;
     if (src.empty()) {
         return Mat();
     }
@@ -297,7 +475,28 @@ Mat VisionProcessor::extractMRZRegion(const Mat& src) {
     
     // Apply specific binarization for MRZ
     // MRZ uses OCR-B font which has specific characteristics
-    return binarizeForOCR(mrzRegion);
+    return binarizeForOCR(mrzRegion, denoise, token, status);
+}
+
+bool VisionProcessor::denoiseNLMStrips(const Mat& src, Mat& dst, const CancellationToken* token) {
+    // Search window 21 + template 7: output rows depend on +-13 input rows
+    const int margin = 21 / 2 + 7 / 2;
+    dst.create(src.size(), src.type());
+    
+    Mat strip;
+    for (int y = 0; y < src.rows; y += NLM_STRIP_ROWS) {
+        if (CancellationToken::statusOf(token) != ProcessStatus::OK) {
+            return false;
+        }
+        
+        int rows = std::min(NLM_STRIP_ROWS, src.rows - y);
+        int top = std::max(0, y - margin);
+        int bottom = std::min(src.rows, y + rows + margin);
+        
+        fastNlMeansDenoising(src.rowRange(top, bottom), strip, 10, 7, 21);
+        strip.rowRange(y - top, y - top + rows).copyTo(dst.rowRange(y, y + rows));
+    }
+    return true;
 }
 
 float VisionProcessor::detectGlare(const Mat& src, const Mat& mask) {
@@ -392,6 +591,40 @@ Mat VisionProcessor::extractROI(const Mat& warpedCard, ROIType type, bool isBack
     // Get ROI region definition
     ROIRegion region = getROIRegion(type, isBackSide);
     
+    Mat roi = cropROI(warpedCard, region).clone();
+    
+    LOGD("extractROI: type=%d, size=%dx%d", static_cast<int>(type), roi.cols, roi.rows);
+    
+    return preprocessROI(roi, type, isBackSide);
+}
+
+Mat VisionProcessor::preprocessROI(const Mat& roi, ROIType type, bool isBackSide) {
+    StageTimer timer(MetricStage::ROI);
+    TraceSpan span("preprocessROI", "type", static_cast<int>(type));
+    if (roi.empty()) {
+        return Mat();
+    }
+    
+    // Skip binarization for photo region
+    if (type == ROIType::PHOTO) {
+        return roi;
+    }
+    
+    // Advanced preprocessing for MRZ to improve OCR accuracy
+    // (leveled first: residual warp tilt smears the lines across rows)
+    if (type == ROIType::MRZ) {
+        return binarizeMRZ(MRZLocator::locate(roi, 1, false).deskewed);
+    }
+    
+    // Apply region-specific preprocessing
+    return binarizeROI(roi, getROIRegion(type, isBackSide));
+}
+
+Mat VisionProcessor::cropROI(const Mat& warpedCard, const ROIRegion& region) {
+    if (warpedCard.empty()) {
+        return Mat();
+    }
+    
     // Calculate pixel coordinates from percentages
     int x = static_cast<int>(region.x * warpedCard.cols);
     int y = static_cast<int>(region.y * warpedCard.rows);
@@ -404,43 +637,41 @@ Mat VisionProcessor::extractROI(const Mat& warpedCard, ROIType type, bool isBack
     w = max(1, min(w, warpedCard.cols - x));
     h = max(1, min(h, warpedCard.rows - y));
     
-    Rect roiRect(x, y, w, h);
-    Mat roi = warpedCard(roiRect).clone();
-    
-    LOGD("extractROI: type=%d, rect=(%d,%d,%d,%d)", static_cast<int>(type), x, y, w, h);
-    
-    // Skip binarization for photo region
-    if (type == ROIType::PHOTO) {
-        return roi;
+    return warpedCard(Rect(x, y, w, h));
+}
+
+Mat VisionProcessor::binarizeMRZ(const Mat& mrz, int scale) {
+    if (mrz.empty()) {
+        return Mat();
     }
     
-    // Advanced preprocessing for MRZ to improve OCR accuracy
-    if (type == ROIType::MRZ) {
-        Mat gray;
-        if (roi.channels() == 3 || roi.channels() == 4) {
-            cvtColor(roi, gray, roi.channels() == 4 ? COLOR_BGRA2GRAY : COLOR_BGR2GRAY);
-        } else {
-            gray = roi.clone();
-        }
-        
-        // 1. Gaussian Blur (Light): Removes high-freq noise without destroying structure
-        // Safer than Bilateral for thin characters like <
-        Mat blurred;
-        GaussianBlur(gray, blurred, Size(3, 3), 0);
-        
-        // 2. Adaptive Threshold (Local) optimized for MRZ
-        // Block 13: Local enough for thin chars
-        // C 10: High contrast requirement (removes background noise)
-        Mat binary;
-        adaptiveThreshold(blurred, binary, 255, 
-            ADAPTIVE_THRESH_GAUSSIAN_C, THRESH_BINARY, 
-            13, 10);
-            
-        return binary;
+    Mat gray;
+    if (mrz.channels() == 3 || mrz.channels() == 4) {
+        cvtColor(mrz, gray, mrz.channels() == 4 ? COLOR_BGRA2GRAY : COLOR_BGR2GRAY);
+    } else {
+        gray = mrz;
     }
     
-    // Apply region-specific preprocessing
-    return binarizeROI(roi, region);
+    scale = max(1, scale);
+    
+    // 1. Gaussian Blur (Light): Removes high-freq noise without destroying structure
+    // Safer than Bilateral for thin characters like <
+    Mat blurred;
+    int kernel = 3 * scale;
+    if (kernel % 2 == 0) kernel++;
+    GaussianBlur(gray, blurred, Size(kernel, kernel), 0);
+    
+    // 2. Adaptive Threshold (Local) optimized for MRZ
+    // Block 13: Local enough for thin chars (scaled with resolution)
+    // C 10: High contrast requirement (removes background noise)
+    int blockSize = 13 * scale;
+    if (blockSize % 2 == 0) blockSize++;
+    Mat binary;
+    adaptiveThreshold(blurred, binary, 255, 
+        ADAPTIVE_THRESH_GAUSSIAN_C, THRESH_BINARY, 
+        blockSize, 10);
+        
+    return binary;
 }
 
 Mat VisionProcessor::binarizeROI(const Mat& roi, const ROIRegion& region) {
@@ -497,35 +728,16 @@ float VisionProcessor::calculateBlurScore(const Mat& src) {
         return 0.0f;
     }
     
-    Mat gray;
-    if (src.channels() == 3 || src.channels() == 4) {
-        cvtColor(src, gray, src.channels() == 4 ? COLOR_BGRA2GRAY : COLOR_BGR2GRAY);
-    } else {
-        gray = src.clone();
-    }
-    
-    // Calculate Laplacian
-    Mat laplacian;
-    Laplacian(gray, laplacian, CV_64F);
-    
-    // Calculate variance of Laplacian
-    Scalar mean, stddev;
-    meanStdDev(laplacian, mean, stddev);
-    
-    double variance = stddev[0] * stddev[0];
+    // Integer Laplacian variance from the fused quality kernel
+    // (no CV_64F Laplacian image is allocated)
+    FrameQuality quality = QualityKernel::analyze(src);
     
     // Score: Higher variance = sharper image
     // Typically variance is low (<10) for blurry, >100 for very sharp
-    // Scale it to be somewhat compatible with our 0-100 expectation
-    // We'll cap at 100 for simplicity in UI
-    double scaledVariance = variance * 20.0;
-    
-    // Clamp to 0-100 range
-    float score = static_cast<float>(min(100.0, scaledVariance));
-    
-    LOGD("calculateBlurScore: raw=%.2f, scaled=%.2f", variance, scaledVariance);
+    // Scaled by 20 and clamped to 0-100 for the UI
+    LOGD("calculateBlurScore: raw=%.2f, scaled=%.2f", quality.laplacianVariance, quality.blurScore);
     
-    return score;
+    return quality.blurScore;
 }
 
 float VisionProcessor::calculateStability(const Mat& current, const Mat& previous) {
@@ -577,109 +789,34 @@ float VisionProcessor::calculateStability(const Mat& current, const Mat& previou
 
 // ==================== MRZValidator Implementation ====================
 
-const int MRZValidator::WEIGHTS[3] = {7, 3, 1};
-
 ValidationScore MRZValidator::validateWithScore(
     const string& line1Raw,
     const string& line2Raw,
     const string& line3Raw
 ) {
-    ValidationScore score = {0, 0, 0, 0, 0, false, false, false, false, "", "", ""};
-    
-    // Apply OCR error corrections
-    string line1 = correctOCRErrors(line1Raw);
-    string line2 = correctOCRErrors(line2Raw);
-    string line3 = correctOCRErrors(line3Raw);
-    
-    score.correctedLine1 = line1;
-    score.correctedLine2 = line2;
-    score.correctedLine3 = line3;
-    
-    // Pad lines to 30 chars
-    line1.resize(30, '<');
-    line2.resize(30, '<');
-    line3.resize(30, '<');
-    
-    // 1. Document Number Check (Line 1: positions 5-13, check at 14)
-    // Format: I<TUR[DOCNUM9][CHK]<<<<<<<<<<<<<<
-    if (line1.length() >= 15) {
-        string docNum = line1.substr(5, 9);
-        char docNumCheck = line1[14];
-        
-        if (validateCheckDigit(docNum, docNumCheck)) {
-            score.docNumValid = true;
-            score.docNumScore = 15;
-            LOGD("MRZ DocNum valid: %s check=%c", docNum.c_str(), docNumCheck);
-        } else {
-            LOGD("MRZ DocNum INVALID: %s check=%c, expected=%d", 
-                 docNum.c_str(), docNumCheck, calculateChecksum(docNum));
-        }
-
-        // TCKK Special: Line 1 positions 16-26 contain TCKN
-        if (line1.length() >= 27) {
-            string tckn = line1.substr(16, 11);
-            if (validateTCKN(tckn)) {
-                LOGD("MRZ Line 1: VALID TCKN found: %s", tckn.c_str());
-                // This could add to confidence or be used as fallback
-            }
-        }
-    }
-    
-    // 2. Birth Date Check (Line 2: positions 0-5, check at 6)
-    // Format: [DOB6][CHK][SEX][EXP6][CHK]TUR[TCKN11][CHK]
-    if (line2.length() >= 7) {
-        string dob = line2.substr(0, 6);
-        char dobCheck = line2[6];
-        
-        if (validateCheckDigit(dob, dobCheck)) {
-            score.dobValid = true;
-            score.dobScore = 15;
-            LOGD("MRZ DOB valid: %s check=%c", dob.c_str(), dobCheck);
-        } else {
-            LOGD("MRZ DOB INVALID: %s check=%c, expected=%d", 
-                 dob.c_str(), dobCheck, calculateChecksum(dob));
-        }
-    }
-    
-    // 3. Expiry Date Check (Line 2: positions 8-13, check at 14)
-    if (line2.length() >= 15) {
-        string expiry = line2.substr(8, 6);
-        char expiryCheck = line2[14];
-        
-        if (validateCheckDigit(expiry, expiryCheck)) {
-            score.expiryValid = true;
-            score.expiryScore = 15;
-            LOGD("MRZ Expiry valid: %s check=%c", expiry.c_str(), expiryCheck);
-        } else {
-            LOGD("MRZ Expiry INVALID: %s check=%c, expected=%d", 
-                 expiry.c_str(), expiryCheck, calculateChecksum(expiry));
-        }
-    }
-    
-    // 4. Composite Check (Line 2, position 29)
-    // Composite = line1[5-29] + line2[0-6] + line2[8-14] + line2[18-28]
-    if (line1.length() >= 30 && line2.length() >= 30) {
-        string compositeData;
-        compositeData += line1.substr(5, 25);   // Doc number area
-        compositeData += line2.substr(0, 7);    // DOB + check
-        compositeData += line2.substr(8, 7);    // Expiry + check
-        compositeData += line2.substr(18, 11);  // Optional data (TCKN area)
-        
-        char compositeCheck = line2[29];
-        
-        if (validateCheckDigit(compositeData, compositeCheck)) {
-            score.compositeValid = true;
-            score.compositeScore = 15;
-            LOGD("MRZ Composite valid, check=%c", compositeCheck);
-        } else {
-            LOGD("MRZ Composite INVALID, check=%c, expected=%d", 
-                 compositeCheck, calculateChecksum(compositeData));
-        }
-    }
-    
-    // Calculate total score
-    score.totalScore = score.docNumScore + score.dobScore + 
-                       score.expiryScore + score.compositeScore;
+    StageTimer timer(MetricStage::VALIDATE);
+    TraceSpan span("validateMRZ");
+    ValidationScore score = {0, 0, 0, 0, 0, false, false, false, false, "", "", "", 0};
+    
+    // Cheapest reading that passes the check digits (per-field correction if none does)
+    MRZDecodeResult decoded = MRZDecoder::decode(line1Raw, line2Raw, line3Raw);
+    
+    // Document number (line 1), birth and expiry dates (line 2) and the composite check (line 2, 29)
+    MRZFields fields = MRZParser::parse(decoded.lines[0], decoded.lines[1], decoded.lines[2]);
+    score.docNumValid = fields.docNumValid;
+    score.dobValid = fields.dobValid;
+    score.expiryValid = fields.expiryValid;
+    score.compositeValid = fields.compositeValid;
+    score.docNumScore = fields.docNumValid ? 15 : 0;
+    score.dobScore = fields.dobValid ? 15 : 0;
+    score.expiryScore = fields.expiryValid ? 15 : 0;
+    score.compositeScore = fields.compositeValid ? 15 : 0;
+    score.totalScore = fields.score;
+    
+    score.correctedLine1 = std::move(decoded.lines[0]);
+    score.correctedLine2 = std::move(decoded.lines[1]);
+    score.correctedLine3 = std::move(decoded.lines[2]);
+    score.corrections = decoded.edits;
     
     LOGD("MRZ Validation: total=%d (doc=%d, dob=%d, exp=%d, comp=%d)",
          score.totalScore, score.docNumScore, score.dobScore,
@@ -688,94 +825,20 @@ ValidationScore MRZValidator::validateWithScore(
     return score;
 }
 
-string MRZValidator::correctOCRErrors(const string& line) {
-    string corrected;
-    corrected.reserve(line.length());
-    
-    for (char c : line) {
-        // Convert to uppercase first
-        char upper = static_cast<char>(toupper(static_cast<unsigned char>(c)));
-        
-        // Common OCR errors in MRZ (OCR-B font)
-        switch (upper) {
-            case 'O': corrected += '0'; break;  // O -> 0
-            case 'I': corrected += '1'; break;  // I -> 1
-            case 'S': corrected += '5'; break;  // S -> 5 (in numeric context)
-            case 'B': corrected += '8'; break;  // B -> 8 (in numeric context)
-            case 'G': corrected += '6'; break;  // G -> 6
-            case 'D': corrected += '0'; break;  // D -> 0
-            case 'Q': corrected += '0'; break;  // Q -> 0
-            case 'Z': corrected += '2'; break;  // Z -> 2
-            case ' ': corrected += '<'; break;  // Space -> filler
-            case '.': corrected += '<'; break;  // Dot -> filler
-            default:
-                // Keep valid MRZ characters
-                if ((upper >= 'A' && upper <= 'Z') || 
-                    (upper >= '0' && upper <= '9') || 
-                    upper == '<') {
-                    corrected += upper;
-                } else {
-                    // Unknown char becomes filler
-                    corrected += '<';
-                }
-                break;
-        }
-    }
-    
-    return corrected;
+string MRZValidator::correctOCRErrors(const string& line, int lineIndex) {
+    return MRZDecoder::correctLine(line, lineIndex);
 }
 
 bool MRZValidator::validateTCKN(const string& tckn) {
-    if (tckn.length() != 11 || tckn[0] == '0') return false;
-
-    int odds = 0, evens = 0, sum10 = 0;
-    for (int i = 0; i < 9; i++) {
-        if (!isdigit(tckn[i])) return false;
-        int digit = tckn[i] - '0';
-        if (i % 2 == 0) odds += digit; // 1, 3, 5, 7, 9. haneler (0-index: 0,2,4,6,8)
-        else evens += digit;           // 2, 4, 6, 8. haneler (0-index: 1,3,5,7)
-        sum10 += digit;
-    }
-
-    int digit10 = ((odds * 7) - evens) % 10;
-    if (digit10 < 0) digit10 += 10;
-    
-    if (digit10 != (tckn[9] - '0')) return false;
-
-    sum10 += digit10;
-    int digit11 = sum10 % 10;
-
-    bool valid = (digit11 == (tckn[10] - '0'));
-    if (valid) {
-        LOGD("validateTCKN: %s is VALID", tckn.c_str());
-    } else {
-        LOGD("validateTCKN: %s is INVALID (d10=%d, d11=%d)", tckn.c_str(), digit10, digit11);
-    }
-    return valid;
+    return MRZParser::validTCKN(tckn);
 }
 
 int MRZValidator::charToValue(char c) {
-    if (c >= '0' && c <= '9') return c - '0';
-    if (c >= 'A' && c <= 'Z') return c - 'A' + 10;
-    if (c == '<') return 0;
-    return 0;  // Default for invalid chars
+    return MRZParser::charValue(c);
 }
 
 int MRZValidator::calculateChecksum(const string& data) {
-    int sum = 0;
-    for (size_t i = 0; i < data.length(); ++i) {
-        int value = charToValue(data[i]);
-        int weight = WEIGHTS[i % 3];
-        sum += value * weight;
-    }
-    return sum % 10;
-}
-
-bool MRZValidator::validateCheckDigit(const string& data, char checkDigit) {
-    if (!isdigit(checkDigit)) return false;
-    int expected = calculateChecksum(data);
-    int actual = checkDigit - '0';
-    return expected == actual;
+    return MRZParser::checksum(data);
 }
 
 } // namespace idverify
@@ -5,6 +5,7 @@
 #include <vector>
 #include <string>
 #include "ROIMapper.h"
+#include "CancellationToken.h"
 
 namespace idverify {
 
@@ -16,10 +17,12 @@ struct ProcessedFrame {
     cv::Mat binarized;           // Adaptive threshold applied for OCR
     cv::Mat mrzRegion;           // Bottom 25-30% cropped for MRZ
     bool cardDetected;           // True if 4 corners found
+    std::vector<cv::Point> corners;  // Detected quad in input pixels (empty if !cardDetected)
     float perspectiveConfidence; // 0-1, how confident we are about corners
-    float glareScore;            // 0-1, lower is better (less glare)
+    float glareScore;            // 0-1, glare on the card area only, lower is better
     int cardWidth;               // Detected card width in pixels
     int cardHeight;              // Detected card height in pixels
+    ProcessStatus status;        // Not OK if cancelled; images filled so far are kept
 };
 
 /**
@@ -38,6 +41,7 @@ struct ValidationScore {
     std::string correctedLine1;
     std::string correctedLine2;
     std::string correctedLine3;
+    int corrections;     // Characters changed by checksum-constrained decoding
 };
 
 /**
@@ -47,6 +51,28 @@ struct CornerResult {
     std::vector<cv::Point> corners;  // 4 corners if found
     float confidence;                 // 0-1 detection confidence
     bool detected;                    // True if valid quadrilateral found
+    ProcessStatus status = ProcessStatus::OK;  // Not OK if stopped early (best quad so far)
+};
+
+/**
+ * Denoise strength used before OCR binarization
+ */
+enum class DenoiseTier : int {
+    NLM = 0,       // fastNlMeansDenoising (best hologram removal, slowest)
+    GAUSSIAN = 1,  // 5x5 Gaussian blur
+    NONE = 2       // No denoising
+};
+
+/**
+ * Cost/quality knobs of the vision pipeline
+ * Defaults reproduce the original fixed pipeline
+ */
+struct PipelineSettings {
+    int detectionPyramidLevel = 0;        // findCardCorners runs on src / 2^level
+    DenoiseTier denoise = DenoiseTier::NLM;
+    int warpInterpolation = 2;            // cv::INTER_CUBIC
+    bool useTracking = false;             // Search near the previous quad before full detection
+    int frameSkip = 0;                    // Process 1 of every (frameSkip + 1) frames
 };
 
 // ID-1 standard dimensions (scaled up for quality)
@@ -81,6 +107,18 @@ public:
      */
     static ProcessedFrame processForOCR(const cv::Mat& inputRGB);
     
+    /**
+     * Process a camera frame for OCR with explicit cost settings
+     * @param inputRGB BGR input image from camera
+     * @param settings Detection level, denoise tier, warp interpolation
+     * @param previousCorners Last known quad (used when settings.useTracking)
+     * @param token Optional cancellation token / deadline, polled between and inside stages
+     * @return ProcessedFrame with all processed images (partial if status != OK)
+     */
+    static ProcessedFrame processForOCR(const cv::Mat& inputRGB, const PipelineSettings& settings,
+                                        const std::vector<cv::Point>& previousCorners = {},
+                                        const CancellationToken* token = nullptr);
+    
     /**
      * Find card corners with confidence score
      * @param src Input image
@@ -88,28 +126,61 @@ public:
      */
     static CornerResult findCardCorners(const cv::Mat& src);
     
+    /**
+     * Find card corners on a downscaled pyramid level
+     * @param src Input image
+     * @param pyramidLevel Detection runs on src / 2^level; corners are in src coordinates
+     * @param token Optional cancellation token, polled between stages and contours
+     * @return CornerResult with corners and confidence
+     */
+    static CornerResult findCardCorners(const cv::Mat& src, int pyramidLevel,
+                                        const CancellationToken* token = nullptr);
+    
+    /**
+     * Search for the card only around its previous position
+     * @param src Input image
+     * @param previousCorners Quad from the previous frame
+     * @param pyramidLevel Pyramid level used inside the search window
+     * @param token Optional cancellation token
+     * @return CornerResult (detected=false if the card left the window)
+     */
+    static CornerResult trackCardCorners(const cv::Mat& src, const std::vector<cv::Point>& previousCorners,
+                                         int pyramidLevel = 0, const CancellationToken* token = nullptr);
+    
     /**
      * Warp image to ID-1 standard dimensions (856x540)
      * @param src Source image
      * @param corners 4 corner points (TL, TR, BR, BL order)
+     * @param interpolation cv::InterpolationFlags value (default INTER_CUBIC)
      * @return Warped image or empty Mat if failed
      */
-    static cv::Mat warpToID1(const cv::Mat& src, const std::vector<cv::Point>& corners);
+    static cv::Mat warpToID1(const cv::Mat& src, const std::vector<cv::Point>& corners,
+                             int interpolation = 2);
     
     /**
      * Apply adaptive binarization for OCR
      * Removes hologram glare and enhances text
      * @param src Input image (grayscale or color)
-     * @return Binarized image
+     * @param denoise Denoise tier applied before thresholding
+     * @param token Optional cancellation token (NLM then runs in row strips)
+     * @param status Optional output status
+     * @return Binarized image (empty if cancelled)
      */
-    static cv::Mat binarizeForOCR(const cv::Mat& src);
+    static cv::Mat binarizeForOCR(const cv::Mat& src, DenoiseTier denoise = DenoiseTier::NLM,
+                                  const CancellationToken* token = nullptr,
+                                  ProcessStatus* status = nullptr);
     
     /**
      * Extract MRZ region (bottom 25-30%)
      * @param src Normalized card image
-     * @return Cropped MRZ region
+     * @param denoise Denoise tier applied before thresholding
+     * @param token Optional cancellation token
+     * @param status Optional output status
+     * @return Cropped MRZ region (empty if cancelled)
      */
-    static cv::Mat extractMRZRegion(const cv::Mat& src);
+    static cv::Mat extractMRZRegion(const cv::Mat& src, DenoiseTier denoise = DenoiseTier::NLM,
+                                    const CancellationToken* token = nullptr,
+                                    ProcessStatus* status = nullptr);
     
     /**
      * Detect glare level in image
@@ -136,6 +207,31 @@ public:
      */
     static cv::Mat extractROI(const cv::Mat& warpedCard, ROIType type, bool isBackSide = false);
     
+    /**
+     * Apply ROI-type-specific OCR preprocessing to an already cropped ROI
+     * @param roi Cropped ROI (see cropROI)
+     * @param type ROI type
+     * @param isBackSide True if processing back side
+     * @return Preprocessed ROI (PHOTO is returned unchanged)
+     */
+    static cv::Mat preprocessROI(const cv::Mat& roi, ROIType type, bool isBackSide = false);
+    
+    /**
+     * Crop ROI from warped card without any preprocessing
+     * @param warpedCard 856x540 warped card image
+     * @param region ROIRegion with normalized coordinates
+     * @return Clamped view into warpedCard (not a copy)
+     */
+    static cv::Mat cropROI(const cv::Mat& warpedCard, const ROIRegion& region);
+    
+    /**
+     * Binarize MRZ crop for OCR-B text
+     * @param mrz Grayscale or color MRZ crop
+     * @param scale Resolution factor vs. the 856x540 card (2 for 2x upsampled input)
+     * @return Binarized image
+     */
+    static cv::Mat binarizeMRZ(const cv::Mat& mrz, int scale = 1);
+    
     /**
      * Binarize ROI with region-specific parameters
      * @param roi Cropped ROI image
@@ -159,7 +255,6 @@ public:
      */
     static float calculateStability(const cv::Mat& current, const cv::Mat& previous);
     
-private:
     /**
      * Order corners as TL, TR, BR, BL
      * @param corners Unordered corners
@@ -167,6 +262,28 @@ private:
      */
     static std::vector<cv::Point2f> orderCorners(const std::vector<cv::Point>& corners);
     
+    // Rows per NLM strip when denoising under a cancellation token
+    static constexpr int NLM_STRIP_ROWS = 128;
+    
+private:    
+    /**
+     * Corner detection on one image, polling the token between stages
+     */
+    static CornerResult detectCorners(const cv::Mat& src, const CancellationToken* token);
+    
+    /**
+     * detectCorners on src / 2^level, corners mapped back to src (not timed)
+     */
+    static CornerResult detectOnPyramid(const cv::Mat& src, int pyramidLevel, const CancellationToken* token);
+    
+    /**
+     * fastNlMeansDenoising in row strips with a token check between strips
+     * Strips overlap by the search + template radius, so output matches the
+     * single call
+     * @return false if stopped (dst is then incomplete)
+     */
+    static bool denoiseNLMStrips(const cv::Mat& src, cv::Mat& dst, const CancellationToken* token);
+    
     /**
      * Calculate aspect ratio of quadrilateral
      * @param corners 4 corners
@@ -182,6 +299,8 @@ class MRZValidator {
 public:
     /**
      * Validate MRZ with detailed scoring
+     * Lines are first decoded to the cheapest checksum-consistent reading (MRZDecoder),
+     * then checked by MRZParser. For already clean lines in tight loops, call MRZParser directly
      * @param line1 First MRZ line (30 chars)
      * @param line2 Second MRZ line (30 chars)  
      * @param line3 Third MRZ line (30 chars)
@@ -194,11 +313,13 @@ public:
     );
     
     /**
-     * Correct common OCR errors in MRZ
+     * Correct common OCR errors in one MRZ line by field class
+     * (letters in dates become digits, digits in names become letters; TUR and names are kept)
      * @param line MRZ line with potential errors
-     * @return Corrected line
+     * @param lineIndex 0-2 (TD1 line)
+     * @return Corrected 30-char line (no checksum search, see MRZDecoder)
      */
-    static std::string correctOCRErrors(const std::string& line);
+    static std::string correctOCRErrors(const std::string& line, int lineIndex);
     
     /**
      * Validate TCKN (Turkish ID number) algorithm
@@ -207,10 +328,6 @@ public:
      */
     static bool validateTCKN(const std::string& tckn);
     
-private:
-    // ICAO 7-3-1 weights
-    static const int WEIGHTS[3];
-    
     /**
      * Convert MRZ character to numeric value
      * 0-9 -> 0-9, A-Z -> 10-35, < -> 0
@@ -223,14 +340,6 @@ private:
      * @return Check digit 0-9
      */
     static int calculateChecksum(const std::string& data);
-    
-    /**
-     * Validate single check digit
-     * @param data Data to validate
-     * @param checkDigit Expected check character
-     * @return true if valid
-     */
-    static bool validateCheckDigit(const std::string& data, char checkDigit);
 };
 
 } // namespace idverify
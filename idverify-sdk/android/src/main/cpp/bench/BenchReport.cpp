@@ -0,0 +1,260 @@
+#include "BenchReport.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+
+namespace idverify {
+
+namespace {
+
+const char* STAGE_NAMES[METRIC_STAGE_COUNT] = {
+    "INGEST", "DETECT", "WARP", "BINARIZE", "ROI", "VALIDATE", "MRZ_READ"
+};
+
+void writeLatency(ostream& out, const char* name, const LatencySummary& s, bool last) {
+    out << "    \"" << name << "\": {\"count\": " << s.count << fixed << setprecision(4)
+        << ", \"meanMs\": " << s.meanMs << ", \"p50Ms\": " << s.p50Ms
+        << ", \"p95Ms\": " << s.p95Ms << ", \"p99Ms\": " << s.p99Ms << (last ? "}\n" : "},\n");
+}
+
+// One "name": value line of an object
+void writeNumber(ostream& out, const char* indent, const char* name, double value, int precision, bool last) {
+    out << indent << '"' << name << "\": " << fixed << setprecision(precision) << value << (last ? "\n" : ",\n");
+}
+
+string escape(const string& s) {
+    string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+/**
+ * Minimal JSON reader: keeps numbers, skips strings/bools/null
+ */
+class NumberReader {
+public:
+    NumberReader(const string& text, map<string, double>& numbers) : s_(text), pos_(0), numbers_(numbers) {}
+
+    bool parse() {
+        if (!value("")) return false;
+        skipSpace();
+        return pos_ == s_.size();
+    }
+
+private:
+    void skipSpace() {
+        while (pos_ < s_.size() && isspace(static_cast<unsigned char>(s_[pos_]))) pos_++;
+    }
+
+    bool readString(std::string* out) {
+        if (pos_ >= s_.size() || s_[pos_] != '"') return false;
+        pos_++;
+        while (pos_ < s_.size() && s_[pos_] != '"') {
+            if (s_[pos_] == '\\') pos_++;
+            if (out != nullptr && pos_ < s_.size()) *out += s_[pos_];
+            pos_++;
+        }
+        if (pos_ >= s_.size()) return false;
+        pos_++;
+        return true;
+    }
+
+    bool value(const std::string& path) {
+        skipSpace();
+        if (pos_ >= s_.size()) return false;
+        const char c = s_[pos_];
+        if (c == '{') {
+            pos_++;
+            skipSpace();
+            if (pos_ < s_.size() && s_[pos_] == '}') { pos_++; return true; }
+            while (true) {
+                skipSpace();
+                std::string key;
+                if (!readString(&key)) return false;
+                skipSpace();
+                if (pos_ >= s_.size() || s_[pos_++] != ':') return false;
+                if (!value(path.empty() ? key : path + "." + key)) return false;
+                skipSpace();
+                if (pos_ < s_.size() && s_[pos_] == ',') { pos_++; continue; }
+                if (pos_ < s_.size() && s_[pos_] == '}') { pos_++; return true; }
+                return false;
+            }
+        }
+        if (c == '[') {
+            pos_++;
+            skipSpace();
+            if (pos_ < s_.size() && s_[pos_] == ']') { pos_++; return true; }
+            for (int i = 0;; ++i) {
+                if (!value(path + "." + to_string(i))) return false;
+                skipSpace();
+                if (pos_ < s_.size() && s_[pos_] == ',') { pos_++; continue; }
+                if (pos_ < s_.size() && s_[pos_] == ']') { pos_++; return true; }
+                return false;
+            }
+        }
+        if (c == '"') {
+            return readString(nullptr);
+        }
+        for (const char* word : { "true", "false", "null" }) {
+            const size_t n = strlen(word);
+            if (s_.compare(pos_, n, word) == 0) { pos_ += n; return true; }
+        }
+        const char* begin = s_.c_str() + pos_;
+        char* end = nullptr;
+        double v = strtod(begin, &end);
+        if (end == begin) return false;
+        pos_ += static_cast<size_t>(end - begin);
+        numbers_[path] = v;
+        return true;
+    }
+
+    const std::string& s_;
+    size_t pos_;
+    map<std::string, double>& numbers_;
+};
+
+bool endsWith(const string& s, const char* suffix) {
+    const size_t n = strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+}
+
+// ==================== Summaries ====================
+
+LatencySummary summarize(const AtomicHistogram& histogram) {
+    LatencySummary s;
+    s.count = histogram.count();
+    if (s.count == 0) return s;
+    s.meanMs = histogram.sumUs() / 1000.0 / s.count;
+    s.p50Ms = histogram.percentileUs(0.50) / 1000.0;
+    s.p95Ms = histogram.percentileUs(0.95) / 1000.0;
+    s.p99Ms = histogram.percentileUs(0.99) / 1000.0;
+    return s;
+}
+
+LatencySummary summarize(vector<double>& latenciesMs) {
+    LatencySummary s;
+    s.count = latenciesMs.size();
+    if (latenciesMs.empty()) return s;
+    sort(latenciesMs.begin(), latenciesMs.end());
+
+    double sum = 0.0;
+    for (double v : latenciesMs) sum += v;
+    s.meanMs = sum / latenciesMs.size();
+
+    // Nearest rank
+    auto rank = [&](double p) {
+        size_t i = static_cast<size_t>(ceil(p * latenciesMs.size()));
+        return latenciesMs[std::min(latenciesMs.size() - 1, i > 0 ? i - 1 : 0)];
+    };
+    s.p50Ms = rank(0.50);
+    s.p95Ms = rank(0.95);
+    s.p99Ms = rank(0.99);
+    return s;
+}
+
+// ==================== JSON ====================
+
+bool writeReport(const BenchReport& r, const string& path) {
+    ostringstream out;
+    out << "{\n";
+    out << "  \"tool\": \"idverify-bench\",\n";
+    out << "  \"version\": 1,\n";
+    out << "  \"corpus\": \"" << escape(r.corpus) << "\",\n";
+    out << "  \"samples\": " << r.samples << ",\n";
+    out << "  \"loadFailures\": " << r.loadFailures << ",\n";
+    out << "  \"jobs\": " << r.jobs << ",\n";
+    writeNumber(out, "  ", "wallSeconds", r.wallSeconds, 3, false);
+    writeNumber(out, "  ", "framesPerSecond", r.framesPerSecond, 2, false);
+
+    out << "  \"accuracy\": {\n";
+    writeNumber(out, "    ", "detectionRate", r.detectionRate, 5, false);
+    writeNumber(out, "    ", "cornerAccuracy", r.cornerAccuracy, 5, false);
+    writeNumber(out, "    ", "meanCornerErrorPx", r.meanCornerErrorPx, 3, false);
+    writeNumber(out, "    ", "mrzReadRate", r.mrzReadRate, 5, false);
+    writeNumber(out, "    ", "mrzCharAccuracy", r.mrzCharAccuracy, 5, false);
+    writeNumber(out, "    ", "mrzChecksumPassRate", r.mrzChecksumPassRate, 5, false);
+    writeNumber(out, "    ", "mrzExactRate", r.mrzExactRate, 5, false);
+    writeNumber(out, "    ", "tcknValidRate", r.tcknValidRate, 5, true);
+    out << "  },\n";
+
+    out << "  \"latency\": {\n";
+    writeLatency(out, "total", r.total, false);
+    for (int i = 0; i < METRIC_STAGE_COUNT; ++i) {
+        writeLatency(out, STAGE_NAMES[i], r.stages[i], i == METRIC_STAGE_COUNT - 1);
+    }
+    out << "  }\n";
+    out << "}\n";
+
+    if (path == "-") {
+        fputs(out.str().c_str(), stdout);
+        return true;
+    }
+    ofstream file(path, ios::trunc);
+    if (!file) {
+        fprintf(stderr, "writeReport: cannot open %s\n", path.c_str());
+        return false;
+    }
+    file << out.str();
+    return static_cast<bool>(file);
+}
+
+bool readReportNumbers(const string& path, map<string, double>& numbers) {
+    ifstream in(path);
+    if (!in) {
+        fprintf(stderr, "readReportNumbers: cannot open %s\n", path.c_str());
+        return false;
+    }
+    stringstream text;
+    text << in.rdbuf();
+    const string json = text.str();
+
+    numbers.clear();
+    NumberReader reader(json, numbers);
+    if (!reader.parse()) {
+        fprintf(stderr, "readReportNumbers: %s is not valid JSON\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+// ==================== Compare ====================
+
+vector<Regression> compareReports(const map<string, double>& baseline,
+                                  const map<string, double>& current,
+                                  double latencyTolerance, double accuracyTolerance) {
+    vector<Regression> regressions;
+    for (const auto& entry : baseline) {
+        const string& key = entry.first;
+        auto it = current.find(key);
+        if (it == current.end()) continue;
+
+        const double before = entry.second;
+        const double after = it->second;
+        bool worse = false;
+        if (endsWith(key, "Rate") || endsWith(key, "Accuracy")) {
+            worse = after < before - accuracyTolerance;
+        } else if (endsWith(key, "Ms") || endsWith(key, "Px")) {
+            // Sub-0.05 ms stages are timer noise; compare absolute there
+            worse = after > std::max(before * (1.0 + latencyTolerance), before + 0.05);
+        }
+        if (worse) {
+            regressions.push_back({ key, before, after });
+        }
+    }
+    return regressions;
+}
+
+} // namespace idverify
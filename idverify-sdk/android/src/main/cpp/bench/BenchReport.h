@@ -0,0 +1,93 @@
+#ifndef BENCH_REPORT_H
+#define BENCH_REPORT_H
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "../Metrics.h"
+
+namespace idverify {
+
+/**
+ * Latency percentiles of one stage (or the whole frame)
+ */
+struct LatencySummary {
+    uint64_t count = 0;
+    double meanMs = 0.0;
+    double p50Ms = 0.0;
+    double p95Ms = 0.0;
+    double p99Ms = 0.0;
+};
+
+/**
+ * Result of one idverify-bench run over a corpus
+ */
+struct BenchReport {
+    std::string corpus;
+    uint64_t samples = 0;
+    uint64_t loadFailures = 0;
+    int jobs = 1;
+    double wallSeconds = 0.0;
+    double framesPerSecond = 0.0;
+
+    double detectionRate = 0.0;         // Card quad found
+    double cornerAccuracy = 0.0;        // Found within tolerance (samples with labeled corners)
+    double meanCornerErrorPx = 0.0;
+    double mrzReadRate = 0.0;           // MRZReader segmented 3x30 cells (back samples)
+    double mrzCharAccuracy = 0.0;       // Recognized characters equal to the label
+    double mrzChecksumPassRate = 0.0;   // validateWithScore on the decoded MRZ: all four check digits
+    double mrzExactRate = 0.0;          // Decoded MRZ equal to the label (all 90 characters)
+    double tcknValidRate = 0.0;         // MRZ TCKN valid and equal to the label (back samples)
+
+    LatencySummary total;                                   // Exact, per frame
+    std::array<LatencySummary, METRIC_STAGE_COUNT> stages;  // From Metrics histograms
+};
+
+/**
+ * Percentiles of a stage histogram (bucket resolution, <= 12.5%)
+ */
+LatencySummary summarize(const AtomicHistogram& histogram);
+
+/**
+ * Exact percentiles of per-frame latencies (sorts the vector)
+ */
+LatencySummary summarize(std::vector<double>& latenciesMs);
+
+/**
+ * Write the report as JSON
+ * @param path Output file, "-" for stdout
+ */
+bool writeReport(const BenchReport& report, const std::string& path);
+
+/**
+ * Read every number of a JSON report, keyed by dotted path
+ * ("accuracy.detectionRate", "latency.DETECT.p95Ms")
+ * @return false if the file is missing or not valid JSON
+ */
+bool readReportNumbers(const std::string& path, std::map<std::string, double>& numbers);
+
+/**
+ * One metric that got worse than its tolerance
+ */
+struct Regression {
+    std::string key;
+    double baseline;
+    double current;
+};
+
+/**
+ * Compare two reports read by readReportNumbers
+ *
+ * Keys ending in "Rate"/"Accuracy" must not drop by more than
+ * accuracyTolerance (absolute); keys ending in "Ms"/"Px" must not grow by
+ * more than latencyTolerance (relative). Other keys are informational.
+ */
+std::vector<Regression> compareReports(const std::map<std::string, double>& baseline,
+                                       const std::map<std::string, double>& current,
+                                       double latencyTolerance, double accuracyTolerance);
+
+} // namespace idverify
+
+#endif // BENCH_REPORT_H
@@ -0,0 +1,217 @@
+#include "Corpus.h"
+#include "SyntheticCard.h"
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+using namespace cv;
+using namespace std;
+
+namespace fs = std::filesystem;
+
+namespace idverify {
+
+namespace {
+
+bool isImage(const fs::path& path) {
+    string ext = path.extension().string();
+    transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return tolower(c); });
+    return ext == ".jpg" || ext == ".jpeg" || ext == ".png" || ext == ".bmp";
+}
+
+const char* FIELD_NAMES[ROI_TYPE_COUNT] = {
+    "TCKN", "SURNAME", "NAME", "MRZ", "PHOTO", "SERIAL", "BIRTHDATE", "EXPIRY"
+};
+
+bool parseQuad(const string& text, vector<Point>& quad) {
+    int v[8];
+    if (sscanf(text.c_str(), "%d,%d,%d,%d,%d,%d,%d,%d",
+               &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7]) != 8) {
+        return false;
+    }
+    quad.clear();
+    for (int i = 0; i < 4; ++i) {
+        quad.push_back(Point(v[2 * i], v[2 * i + 1]));
+    }
+    return true;
+}
+
+void formatQuad(ostream& out, const vector<Point>& quad) {
+    for (size_t i = 0; i < quad.size(); ++i) {
+        out << (i > 0 ? "," : "") << quad[i].x << "," << quad[i].y;
+    }
+}
+
+string trim(const string& s) {
+    size_t begin = s.find_first_not_of(" \t\r");
+    if (begin == string::npos) return "";
+    size_t end = s.find_last_not_of(" \t\r");
+    return s.substr(begin, end - begin + 1);
+}
+
+}
+
+// ==================== Labels ====================
+
+bool Corpus::parseLabel(const string& text, CorpusLabel& label) {
+    label = CorpusLabel();
+    istringstream in(text);
+    string line;
+    while (getline(in, line)) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#') continue;
+
+        size_t eq = line.find('=');
+        if (eq == string::npos) return false;
+        const string key = trim(line.substr(0, eq));
+        const string value = trim(line.substr(eq + 1));
+
+        if (key == "side") {
+            if (value != "front" && value != "back") return false;
+            label.isBackSide = (value == "back");
+        } else if (key == "tckn") {
+            label.tckn = value;
+        } else if (key == "mrz1" || key == "mrz2" || key == "mrz3") {
+            label.mrz[key[3] - '1'] = value;
+        } else if (key == "corners") {
+            if (!parseQuad(value, label.corners)) return false;
+        } else if (key == "field") {
+            size_t bar1 = value.find('|');
+            size_t bar2 = value.rfind('|');
+            if (bar1 == string::npos || bar2 == bar1) return false;
+            const string type = value.substr(0, bar1);
+            CorpusField field;
+            int index = static_cast<int>(find(FIELD_NAMES, FIELD_NAMES + ROI_TYPE_COUNT, type) - FIELD_NAMES);
+            if (index == ROI_TYPE_COUNT) return false;
+            field.type = static_cast<ROIType>(index);
+            field.text = value.substr(bar1 + 1, bar2 - bar1 - 1);
+            if (!parseQuad(value.substr(bar2 + 1), field.quad)) return false;
+            label.fields.push_back(field);
+        }
+    }
+    return true;
+}
+
+string Corpus::formatLabel(const CorpusLabel& label) {
+    ostringstream out;
+    out << "side=" << (label.isBackSide ? "back" : "front") << "\n";
+    if (!label.tckn.empty()) {
+        out << "tckn=" << label.tckn << "\n";
+    }
+    for (int i = 0; i < 3; ++i) {
+        if (!label.mrz[i].empty()) out << "mrz" << (i + 1) << "=" << label.mrz[i] << "\n";
+    }
+    if (label.corners.size() == 4) {
+        out << "corners=";
+        formatQuad(out, label.corners);
+        out << "\n";
+    }
+    for (const CorpusField& field : label.fields) {
+        out << "field=" << FIELD_NAMES[static_cast<int>(field.type)] << "|" << field.text << "|";
+        formatQuad(out, field.quad);
+        out << "\n";
+    }
+    return out.str();
+}
+
+// ==================== Corpus ====================
+
+unique_ptr<Corpus> Corpus::open(const string& path) {
+    if (path.compare(0, 6, "synth:") == 0) {
+        unsigned long long count = 0, seed = 1;
+        if (sscanf(path.c_str() + 6, "%llu:%llu", &count, &seed) < 1 || count == 0) {
+            fprintf(stderr, "Corpus: expected synth:COUNT[:SEED], got %s\n", path.c_str());
+            return nullptr;
+        }
+        return unique_ptr<Corpus>(new SyntheticCorpus(count, SynthConfig(), seed));
+    }
+
+    error_code ec;
+    if (fs::is_regular_file(path, ec) && FrameReplay::isRecording(path)) {
+        unique_ptr<Corpus> corpus(new PackedCorpus(path));
+        if (corpus->size() == 0) {
+            fprintf(stderr, "Corpus: %s is empty or unfinished\n", path.c_str());
+            return nullptr;
+        }
+        return corpus;
+    }
+    if (!fs::is_directory(path, ec)) {
+        fprintf(stderr, "Corpus: %s is not a directory or .idvr file\n", path.c_str());
+        return nullptr;
+    }
+    unique_ptr<Corpus> corpus(new DirectoryCorpus(path));
+    if (corpus->size() == 0) {
+        fprintf(stderr, "Corpus: no images in %s\n", path.c_str());
+        return nullptr;
+    }
+    return corpus;
+}
+
+// ==================== DirectoryCorpus ====================
+
+DirectoryCorpus::DirectoryCorpus(const string& path) {
+    error_code ec;
+    for (const auto& entry : fs::directory_iterator(path, ec)) {
+        if (entry.is_regular_file() && isImage(entry.path())) {
+            images_.push_back(entry.path().string());
+        }
+    }
+    sort(images_.begin(), images_.end());
+}
+
+bool DirectoryCorpus::load(size_t index, CorpusSample& sample) const {
+    if (index >= images_.size()) return false;
+
+    const fs::path image(images_[index]);
+    sample.name = image.filename().string();
+    sample.image = imread(image.string(), IMREAD_COLOR);
+    if (sample.image.empty()) return false;
+
+    sample.label = CorpusLabel();
+    fs::path labelPath = image;
+    labelPath.replace_extension(".txt");
+    ifstream in(labelPath);
+    if (in) {
+        stringstream text;
+        text << in.rdbuf();
+        if (!parseLabel(text.str(), sample.label)) {
+            fprintf(stderr, "Corpus: bad label %s\n", labelPath.string().c_str());
+        }
+    }
+    return true;
+}
+
+// ==================== PackedCorpus ====================
+
+PackedCorpus::PackedCorpus(const string& path) {
+    replay_.open(path);
+}
+
+bool PackedCorpus::load(size_t index, CorpusSample& sample) const {
+    RecordedFrame frame;
+    if (!replay_.frame(index, frame)) return false;
+
+    char name[32];
+    snprintf(name, sizeof(name), "frame_%07zu", index);
+    sample.name = name;
+    switch (replay_.format()) {
+        case RecordFormat::BGR8:  sample.image = frame.image; break;
+        case RecordFormat::RGBA8: cvtColor(frame.image, sample.image, COLOR_RGBA2BGR); break;
+        case RecordFormat::Y8:    cvtColor(frame.image, sample.image, COLOR_GRAY2BGR); break;
+    }
+
+    // Session recordings carry no label, only the scanned side
+    sample.label = CorpusLabel();
+    if (frame.annotationLength == 0) {
+        sample.label.isBackSide = (frame.decision.flags & FrameDecision::FLAG_BACK_SIDE) != 0;
+    } else if (!parseLabel(string(frame.annotation, frame.annotationLength), sample.label)) {
+        fprintf(stderr, "Corpus: bad label in frame %zu\n", index);
+    }
+    return true;
+}
+
+} // namespace idverify
@@ -0,0 +1,123 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <opencv2/core.hpp>
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../FrameRecord.h"
+#include "../ROIMapper.h"
+
+namespace idverify {
+
+/**
+ * Printed field with its text and position
+ */
+struct CorpusField {
+    ROIType type;
+    std::string text;
+    std::vector<cv::Point> quad;        // Text box in image pixels (TL, TR, BR, BL)
+};
+
+/**
+ * Ground truth of one corpus image (fields are empty when unlabeled)
+ */
+struct CorpusLabel {
+    bool isBackSide = false;
+    std::string tckn;                   // 11-digit T.C. Kimlik No (front field, back MRZ)
+    std::array<std::string, 3> mrz;     // Back: TD1 lines (30 chars each)
+    std::vector<cv::Point> corners;     // Card corners in image pixels (TL, TR, BR, BL)
+    std::vector<CorpusField> fields;    // Per-field ground truth (MRZ: one entry per line)
+
+    bool hasMRZ() const { return !mrz[0].empty() && !mrz[1].empty() && !mrz[2].empty(); }
+};
+
+/**
+ * One corpus image with its label
+ */
+struct CorpusSample {
+    std::string name;
+    cv::Mat image;      // BGR
+    CorpusLabel label;
+};
+
+/**
+ * Corpus - Indexed, read-only set of labeled card images
+ *
+ * load() must be safe to call from several threads at once.
+ */
+class Corpus {
+public:
+    virtual ~Corpus() = default;
+
+    virtual size_t size() const = 0;
+
+    /**
+     * Decode one sample
+     * @return false if the image cannot be read
+     */
+    virtual bool load(size_t index, CorpusSample& sample) const = 0;
+
+    /**
+     * Open a corpus directory, a packed .idvr file, or "synth:COUNT[:SEED]"
+     * for rendered cards
+     * @return nullptr if the path holds no images
+     */
+    static std::unique_ptr<Corpus> open(const std::string& path);
+
+    /**
+     * Parse a label file:
+     *   side=front|back
+     *   tckn=12345678901
+     *   mrz1=... / mrz2=... / mrz3=...
+     *   corners=x0,y0,x1,y1,x2,y2,x3,y3
+     *   field=TYPE|text|x0,y0,x1,y1,x2,y2,x3,y3   (repeated; TYPE as in ROIType)
+     * Unknown keys and '#' comments are ignored.
+     */
+    static bool parseLabel(const std::string& text, CorpusLabel& label);
+
+    /**
+     * Inverse of parseLabel
+     */
+    static std::string formatLabel(const CorpusLabel& label);
+};
+
+/**
+ * DirectoryCorpus - Images in a directory with sibling label files
+ *
+ * card_001.jpg is labeled by card_001.txt; images without a label file
+ * are kept (front side, no ground truth).
+ */
+class DirectoryCorpus : public Corpus {
+public:
+    explicit DirectoryCorpus(const std::string& path);
+
+    size_t size() const override { return images_.size(); }
+    bool load(size_t index, CorpusSample& sample) const override;
+
+private:
+    std::vector<std::string> images_;   // Sorted for run-to-run stable order
+};
+
+/**
+ * PackedCorpus - Frames of a memory-mapped .idvr recording (idverify-pack)
+ *
+ * No decoding at startup or per sample: BGR8 files are served as views of
+ * the mapping, Y8/RGBA8 frames are converted to BGR. Labels come from the
+ * per-frame annotation (Corpus label format).
+ */
+class PackedCorpus : public Corpus {
+public:
+    explicit PackedCorpus(const std::string& path);
+
+    size_t size() const override { return replay_.size(); }
+    bool load(size_t index, CorpusSample& sample) const override;
+
+private:
+    FrameReplay replay_;
+};
+
+} // namespace idverify
+
+#endif // CORPUS_H
@@ -0,0 +1,65 @@
+#include "MemoryStats.h"
+#include <cstdio>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace idverify {
+
+double MemorySample::fragmentation() const {
+    const uint64_t arena = inUseBytes - mmappedBytes + freeBytes;
+    return arena > 0 ? static_cast<double>(freeBytes) / arena : 0.0;
+}
+
+MemorySample sampleMemory() {
+    MemorySample s;
+
+#ifdef __linux__
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (statm != nullptr) {
+        unsigned long long size = 0, resident = 0;
+        if (fscanf(statm, "%llu %llu", &size, &resident) == 2) {
+            s.rssBytes = resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+            s.hasRss = true;
+        }
+        fclose(statm);
+    }
+#endif
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    s.mmappedBytes = info.hblkhd;
+    s.inUseBytes = info.uordblks + info.hblkhd;
+    s.freeBytes = info.fordblks;
+    s.heapBytes = info.arena + info.hblkhd;
+    s.hasAllocator = true;
+#endif
+
+    return s;
+}
+
+double trendSlope(const double* x, const double* y, int n) {
+    if (n < 2) return 0.0;
+
+    double mx = 0.0, my = 0.0;
+    for (int i = 0; i < n; ++i) {
+        mx += x[i];
+        my += y[i];
+    }
+    mx /= n;
+    my /= n;
+
+    double sxy = 0.0, sxx = 0.0;
+    for (int i = 0; i < n; ++i) {
+        sxy += (x[i] - mx) * (y[i] - my);
+        sxx += (x[i] - mx) * (x[i] - mx);
+    }
+    return sxx > 0.0 ? sxy / sxx : 0.0;
+}
+
+} // namespace idverify
@@ -0,0 +1,40 @@
+#ifndef MEMORY_STATS_H
+#define MEMORY_STATS_H
+
+#include <cstdint>
+
+namespace idverify {
+
+/**
+ * Process memory at one point in time
+ */
+struct MemorySample {
+    uint64_t rssBytes = 0;          // Resident set (/proc/self/statm)
+    uint64_t heapBytes = 0;         // Obtained from the OS by malloc (arenas + mmapped chunks)
+    uint64_t inUseBytes = 0;        // Allocated and not yet freed
+    uint64_t freeBytes = 0;         // Held by malloc in arenas but free
+    uint64_t mmappedBytes = 0;      // Large allocations served by mmap
+    bool hasRss = false;
+    bool hasAllocator = false;      // glibc mallinfo2 available
+
+    /**
+     * Free share of the malloc arenas (0 = dense, 1 = all holes)
+     * High values with flat in-use bytes mean the heap is fragmenting
+     */
+    double fragmentation() const;
+};
+
+/**
+ * Read RSS and allocator statistics of the current process
+ * Fields the platform does not expose stay 0 with has* = false
+ */
+MemorySample sampleMemory();
+
+/**
+ * Least-squares slope of y over x (0 for fewer than two points)
+ */
+double trendSlope(const double* x, const double* y, int n);
+
+} // namespace idverify
+
+#endif // MEMORY_STATS_H
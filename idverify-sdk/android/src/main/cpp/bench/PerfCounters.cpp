@@ -0,0 +1,133 @@
+#include "PerfCounters.h"
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace idverify {
+
+double PerfSample::ipc() const {
+    if (!has(PerfEvent::CYCLES) || !has(PerfEvent::INSTRUCTIONS) || get(PerfEvent::CYCLES) == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(get(PerfEvent::INSTRUCTIONS)) / get(PerfEvent::CYCLES);
+}
+
+PerfSample& PerfSample::operator+=(const PerfSample& other) {
+    for (int i = 0; i < PERF_EVENT_COUNT; ++i) {
+        values[i] += other.values[i];
+        valid[i] = valid[i] || other.valid[i];
+    }
+    return *this;
+}
+
+#ifdef __linux__
+
+namespace {
+
+int openEvent(uint32_t type, uint64_t config, int groupFd) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = (groupFd < 0) ? 1 : 0;   // Leader starts disabled, members follow it
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID |
+                       PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0));
+}
+
+constexpr uint64_t cacheConfig(uint64_t cache, uint64_t op, uint64_t result) {
+    return cache | (op << 8) | (result << 16);
+}
+
+}
+
+PerfCounters::PerfCounters() {
+    fds_.fill(-1);
+    ids_.fill(0);
+
+    const struct { uint32_t type; uint64_t config; } events[PERF_EVENT_COUNT] = {
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HW_CACHE, cacheConfig(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+                                          PERF_COUNT_HW_CACHE_RESULT_MISS) },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },   // Last-level cache on most PMUs
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES }
+    };
+
+    fds_[0] = openEvent(events[0].type, events[0].config, -1);
+    if (fds_[0] < 0) {
+        return;
+    }
+    for (int i = 0; i < PERF_EVENT_COUNT; ++i) {
+        if (i > 0) fds_[i] = openEvent(events[i].type, events[i].config, fds_[0]);
+        if (fds_[i] >= 0) ioctl(fds_[i], PERF_EVENT_IOC_ID, &ids_[i]);
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (int fd : fds_) {
+        if (fd >= 0) close(fd);
+    }
+}
+
+void PerfCounters::start() {
+    if (!available()) return;
+    ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+PerfSample PerfCounters::stop() {
+    PerfSample sample;
+    if (!available()) return sample;
+
+    ioctl(fds_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    // { nr, time_enabled, time_running, { value, id } x nr }
+    uint64_t buffer[3 + 2 * PERF_EVENT_COUNT];
+    ssize_t n = read(fds_[0], buffer, sizeof(buffer));
+    if (n < static_cast<ssize_t>(3 * sizeof(uint64_t))) return sample;
+
+    const uint64_t nr = buffer[0];
+    const uint64_t enabled = buffer[1];
+    const uint64_t running = buffer[2];
+    const double scale = (running > 0) ? static_cast<double>(enabled) / running : 0.0;
+
+    for (uint64_t k = 0; k < nr && k < PERF_EVENT_COUNT; ++k) {
+        const uint64_t value = buffer[3 + 2 * k];
+        const uint64_t id = buffer[4 + 2 * k];
+        for (int i = 0; i < PERF_EVENT_COUNT; ++i) {
+            if (fds_[i] >= 0 && ids_[i] == id) {
+                sample.values[i] = static_cast<uint64_t>(value * scale);
+                sample.valid[i] = true;
+            }
+        }
+    }
+    return sample;
+}
+
+#else
+
+PerfCounters::PerfCounters() {
+    fds_.fill(-1);
+    ids_.fill(0);
+}
+
+PerfCounters::~PerfCounters() {}
+
+void PerfCounters::start() {}
+
+PerfSample PerfCounters::stop() {
+    return PerfSample();
+}
+
+#endif
+
+} // namespace idverify
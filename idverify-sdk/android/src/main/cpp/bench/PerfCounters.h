@@ -0,0 +1,72 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <array>
+#include <cstdint>
+
+namespace idverify {
+
+/**
+ * Hardware events read around a measured region
+ */
+enum class PerfEvent : int {
+    CYCLES = 0,
+    INSTRUCTIONS = 1,
+    L1D_READ_MISSES = 2,
+    LLC_MISSES = 3,
+    BRANCH_MISSES = 4
+};
+
+constexpr int PERF_EVENT_COUNT = 5;
+
+/**
+ * Counter values of one measured region (scaled for multiplexing)
+ */
+struct PerfSample {
+    std::array<uint64_t, PERF_EVENT_COUNT> values{};
+    std::array<bool, PERF_EVENT_COUNT> valid{};   // Event could be opened
+
+    uint64_t get(PerfEvent e) const { return values[static_cast<int>(e)]; }
+    bool has(PerfEvent e) const { return valid[static_cast<int>(e)]; }
+
+    /**
+     * Instructions per cycle (0 if either counter is missing)
+     */
+    double ipc() const;
+
+    PerfSample& operator+=(const PerfSample& other);
+};
+
+/**
+ * PerfCounters - perf_event_open group for the calling thread (Linux only)
+ *
+ * Opens cycles, instructions, L1D read misses, LLC misses and branch
+ * misses as one group (user space only, so perf_event_paranoid <= 2 is
+ * enough). Events the PMU or VM does not expose are skipped and reported
+ * as invalid. Only the calling thread is counted: run OpenCV with
+ * setNumThreads(1) when attributing misses to a stage.
+ */
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    /**
+     * False if the group leader (cycles) could not be opened
+     */
+    bool available() const { return fds_[0] >= 0; }
+
+    void start();
+    PerfSample stop();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+private:
+    std::array<int, PERF_EVENT_COUNT> fds_;
+    std::array<uint64_t, PERF_EVENT_COUNT> ids_;
+};
+
+} // namespace idverify
+
+#endif // PERF_COUNTERS_H
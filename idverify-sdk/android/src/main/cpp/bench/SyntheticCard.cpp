@@ -0,0 +1,486 @@
+#include "SyntheticCard.h"
+#include "../VisionProcessor.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+using namespace cv;
+using namespace std;
+
+namespace idverify {
+
+namespace {
+
+// Extra rows/columns of precomputed layers, cropped at random offsets
+constexpr int MARGIN = 64;
+
+constexpr int BACKGROUND_COUNT = 4;
+constexpr int GRADIENT_DIRECTIONS = 8;
+const double NOISE_SIGMAS[] = { 2.0, 4.0, 7.0 };
+const int GLARE_SIZES[] = { 60, 120, 220 };
+
+// MRZ character pitch on the 856 px card (30 chars over MRZ_LINE width)
+constexpr int MRZ_PITCH = 27;
+
+const char* const SURNAMES[] = {
+    "YILMAZ", "KAYA", "DEMIR", "SAHIN", "CELIK", "YILDIZ", "YILDIRIM", "OZTURK", "AYDIN", "OZDEMIR",
+    "ARSLAN", "DOGAN", "KILIC", "ASLAN", "CETIN", "KARA", "KOC", "KURT", "OZKAN", "SIMSEK"
+};
+const char* const MALE_NAMES[] = {
+    "AHMET", "MEHMET", "MUSTAFA", "ALI", "HUSEYIN", "HASAN", "IBRAHIM", "BURAK", "EMRE", "CAN"
+};
+const char* const FEMALE_NAMES[] = {
+    "FATMA", "AYSE", "EMINE", "HATICE", "ZEYNEP", "ELIF", "MERVE", "DENIZ", "EDA", "SELIN"
+};
+
+// Serial letters, minus the ones most easily taken for digits (O I S B G D Q Z)
+const char SERIAL_LETTERS[] = "ACEFHJKLMNPRTUVWXY";
+
+template <typename T, size_t N>
+const T& pick(RNG& rng, const T (&items)[N]) {
+    return items[rng.uniform(0, static_cast<int>(N))];
+}
+
+Rect regionRect(const ROIRegion& r) {
+    return Rect(cvRound(r.x * TARGET_WIDTH), cvRound(r.y * TARGET_HEIGHT),
+                cvRound(r.width * TARGET_WIDTH), cvRound(r.height * TARGET_HEIGHT));
+}
+
+vector<Point> quadOf(const Rect& r) {
+    return { r.tl(), Point(r.br().x, r.y), r.br(), Point(r.x, r.br().y) };
+}
+
+void buildAtlas(CardSynthesizer::GlyphAtlas& atlas, int face, double scale, int thickness, int pitch) {
+    int baseline = 0;
+    Size probe = getTextSize("Ag|", face, scale, thickness, &baseline);
+    const int ascent = probe.height + thickness;
+    atlas.height = ascent + baseline + thickness;
+
+    for (int c = 32; c < 127; ++c) {
+        const string glyph(1, static_cast<char>(c));
+        int b = 0;
+        Size size = getTextSize(glyph, face, scale, thickness, &b);
+        const int width = pitch > 0 ? pitch : size.width + thickness + 2;
+        Mat mask = Mat::zeros(atlas.height, width, CV_8U);
+        const int x = pitch > 0 ? (pitch - size.width) / 2 : 1;
+        putText(mask, glyph, Point(x, ascent), face, scale, Scalar(255), thickness, LINE_AA);
+        atlas.masks[c] = mask;
+        atlas.advance[c] = width;
+    }
+}
+
+void drawGuilloche(Mat& card, const Scalar& color, RNG& rng) {
+    vector<Point> curve(TARGET_WIDTH / 4 + 1);
+    for (int i = 0; i < 28; ++i) {
+        const double base = i * TARGET_HEIGHT / 28.0;
+        const double amplitude = rng.uniform(6.0, 18.0);
+        const double freq = rng.uniform(0.008, 0.02);
+        const double phase = rng.uniform(0.0, CV_2PI);
+        for (size_t k = 0; k < curve.size(); ++k) {
+            const int x = static_cast<int>(k) * 4;
+            curve[k] = Point(x, cvRound(base + amplitude * sin(x * freq + phase)));
+        }
+        polylines(card, curve, false, color, 1, LINE_AA);
+    }
+}
+
+}
+
+// ==================== Construction ====================
+
+CardSynthesizer::CardSynthesizer(const SynthConfig& config, uint64_t seed)
+    : config_(config), seed_(seed) {
+    RNG rng(0x5EED0000 + seed);
+    const int W = config_.frameSize.width;
+    const int H = config_.frameSize.height;
+
+    buildAtlas(captionFont_, FONT_HERSHEY_SIMPLEX, 0.42, 1, 0);
+    buildAtlas(valueFont_, FONT_HERSHEY_SIMPLEX, 0.95, 2, 0);
+    buildAtlas(mrzFont_, FONT_HERSHEY_SIMPLEX, 0.95, 2, MRZ_PITCH);
+
+    // Front: pink/blue tint, guilloche, header, captions, photo placeholder
+    frontTemplate_ = Mat(TARGET_HEIGHT, TARGET_WIDTH, CV_8UC3, Scalar(226, 214, 232));
+    drawGuilloche(frontTemplate_, Scalar(206, 190, 216), rng);
+    putText(frontTemplate_, "TURKIYE CUMHURIYETI KIMLIK KARTI", Point(26, 42),
+            FONT_HERSHEY_SIMPLEX, 0.75, Scalar(70, 40, 150), 2, LINE_AA);
+    putText(frontTemplate_, "REPUBLIC OF TURKIYE IDENTITY CARD", Point(26, 68),
+            FONT_HERSHEY_SIMPLEX, 0.5, Scalar(70, 40, 150), 1, LINE_AA);
+    const pair<ROIRegion, const char*> captions[] = {
+        { FrontROI::TCKN, "T.C. Kimlik No / TR Identity No" },
+        { FrontROI::SURNAME, "Soyadi / Surname" },
+        { FrontROI::NAME, "Adi / Given Name(s)" },
+        { FrontROI::BIRTHDATE, "Dogum Tarihi / Date of Birth" },
+        { FrontROI::SERIAL, "Seri No / Document No" }
+    };
+    for (const auto& caption : captions) {
+        Rect r = regionRect(caption.first);
+        drawText(frontTemplate_, captionFont_, caption.second, Point(r.x + 4, r.y + 1), Scalar(90, 70, 110));
+    }
+    Rect photo = regionRect(FrontROI::PHOTO);
+    rectangle(frontTemplate_, photo, Scalar(150, 150, 156), FILLED);
+    ellipse(frontTemplate_, Point(photo.x + photo.width / 2, photo.y + photo.height * 2 / 5),
+            Size(photo.width / 4, photo.height / 5), 0, 0, 360, Scalar(95, 95, 105), FILLED, LINE_AA);
+    ellipse(frontTemplate_, Point(photo.x + photo.width / 2, photo.y + photo.height),
+            Size(photo.width * 2 / 5, photo.height / 3), 0, 180, 360, Scalar(95, 95, 105), FILLED, LINE_AA);
+
+    // Back: chip, barcode, notes block, light MRZ band
+    backTemplate_ = Mat(TARGET_HEIGHT, TARGET_WIDTH, CV_8UC3, Scalar(224, 222, 214));
+    drawGuilloche(backTemplate_, Scalar(204, 200, 190), rng);
+    Rect chip = regionRect(BackROI::CHIP_ZONE);
+    chip = Rect(chip.x + chip.width / 6, chip.y + chip.height / 6, chip.width * 2 / 3, chip.height * 2 / 3);
+    rectangle(backTemplate_, chip, Scalar(70, 165, 205), FILLED, LINE_AA);
+    line(backTemplate_, Point(chip.x, chip.y + chip.height / 2), Point(chip.br().x, chip.y + chip.height / 2),
+         Scalar(40, 110, 150), 2);
+    line(backTemplate_, Point(chip.x + chip.width / 2, chip.y), Point(chip.x + chip.width / 2, chip.br().y),
+         Scalar(40, 110, 150), 2);
+    Rect barcode = regionRect(BackROI::BARCODE);
+    for (int y = barcode.y; y < barcode.br().y;) {
+        const int bar = rng.uniform(1, 5);
+        rectangle(backTemplate_, Rect(barcode.x, y, barcode.width, bar), Scalar(30, 30, 30), FILLED);
+        y += bar + rng.uniform(1, 4);
+    }
+    const char* notes[] = { "ANNE ADI / MOTHER'S NAME", "BABA ADI / FATHER'S NAME",
+                            "VEREN MAKAM / ISSUING AUTHORITY", "T.C. ICISLERI BAKANLIGI" };
+    for (int i = 0; i < 4; ++i) {
+        putText(backTemplate_, notes[i], Point(TARGET_WIDTH / 4, 60 + i * 70),
+                FONT_HERSHEY_SIMPLEX, 0.6, Scalar(60, 60, 70), 1, LINE_AA);
+    }
+    rectangle(backTemplate_, regionRect(BackROI::MRZ), Scalar(238, 238, 236), FILLED);
+
+    // Hologram: rainbow rings and stripes, twice the zone size for random crops
+    Rect zone = regionRect(FrontROI::HOLOGRAM_ZONE);
+    Mat hsv(zone.height * 2, zone.width * 2, CV_8UC3);
+    for (int y = 0; y < hsv.rows; ++y) {
+        Vec3b* row = hsv.ptr<Vec3b>(y);
+        for (int x = 0; x < hsv.cols; ++x) {
+            const double ring = 18.0 * sin(hypot(x - hsv.cols / 2.0, y - hsv.rows / 2.0) * 0.15);
+            row[x] = Vec3b(static_cast<uchar>(static_cast<int>(x + y * 0.6 + ring + 180) % 180), 110, 255);
+        }
+    }
+    cvtColor(hsv, hologram_, COLOR_HSV2BGR);
+
+    // Backgrounds: tinted desk texture with paper/edge clutter
+    for (int i = 0; i < BACKGROUND_COUNT; ++i) {
+        Mat bg(H + MARGIN, W + MARGIN, CV_8UC3);
+        Scalar mean(rng.uniform(40, 170), rng.uniform(40, 170), rng.uniform(40, 170));
+        rng.fill(bg, RNG::NORMAL, mean, Scalar::all(22));
+        GaussianBlur(bg, bg, Size(9, 9), 0);
+        for (int k = 0; k < 6; ++k) {
+            Point a(rng.uniform(0, bg.cols), rng.uniform(0, bg.rows));
+            Point b(rng.uniform(0, bg.cols), rng.uniform(0, bg.rows));
+            Scalar color(rng.uniform(20, 250), rng.uniform(20, 250), rng.uniform(20, 250));
+            if (k % 2 == 0) {
+                rectangle(bg, a, b, color, FILLED, LINE_AA);
+            } else {
+                line(bg, a, b, color, rng.uniform(1, 4), LINE_AA);
+            }
+        }
+        GaussianBlur(bg, bg, Size(3, 3), 0);
+        backgrounds_.push_back(bg);
+    }
+
+    // Sensor noise split into saturating add/subtract layers
+    for (double sigma : NOISE_SIGMAS) {
+        Mat noise(H + MARGIN, W + MARGIN, CV_16SC3), positive, negative;
+        rng.fill(noise, RNG::NORMAL, Scalar::all(0), Scalar::all(sigma));
+        noise.convertTo(positive, CV_8U);
+        Mat(-noise).convertTo(negative, CV_8U);
+        noisePositive_.push_back(positive);
+        noiseNegative_.push_back(negative);
+    }
+
+    // Illumination falloff across the frame, one map per direction
+    for (int d = 0; d < GRADIENT_DIRECTIONS; ++d) {
+        const double angle = d * CV_2PI / GRADIENT_DIRECTIONS;
+        const double cx = cos(angle), cy = sin(angle);
+        const double extent = 0.5 * (abs(cx) * W + abs(cy) * H);
+        Mat gray(H, W, CV_8U);
+        for (int y = 0; y < H; ++y) {
+            uchar* row = gray.ptr<uchar>(y);
+            for (int x = 0; x < W; ++x) {
+                const double t = 0.5 + 0.5 * ((x - W / 2.0) * cx + (y - H / 2.0) * cy) / extent;
+                row[x] = saturate_cast<uchar>(255.0 * (1.0 - config_.gradientStrength * t));
+            }
+        }
+        Mat map;
+        cvtColor(gray, map, COLOR_GRAY2BGR);
+        gradients_.push_back(map);
+    }
+
+    // Specular spots
+    for (int size : GLARE_SIZES) {
+        Mat spot(size, size, CV_8U);
+        const double sigma = size / 5.0;
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                const double r2 = (x - size / 2.0) * (x - size / 2.0) + (y - size / 2.0) * (y - size / 2.0);
+                spot.at<uchar>(y, x) = saturate_cast<uchar>(255.0 * exp(-r2 / (2.0 * sigma * sigma)));
+            }
+        }
+        Mat sprite;
+        cvtColor(spot, sprite, COLOR_GRAY2BGR);
+        glareSprites_.push_back(sprite);
+    }
+}
+
+// ==================== Identity ====================
+
+string CardSynthesizer::randomTCKN(RNG& rng) {
+    int d[11];
+    d[0] = rng.uniform(1, 10);
+    for (int i = 1; i < 9; ++i) d[i] = rng.uniform(0, 10);
+    const int odds = d[0] + d[2] + d[4] + d[6] + d[8];
+    const int evens = d[1] + d[3] + d[5] + d[7];
+    d[9] = ((odds * 7 - evens) % 10 + 10) % 10;
+    int sum = 0;
+    for (int i = 0; i < 10; ++i) sum += d[i];
+    d[10] = sum % 10;
+
+    string tckn(11, '0');
+    for (int i = 0; i < 11; ++i) tckn[i] = static_cast<char>('0' + d[i]);
+    return tckn;
+}
+
+SynthIdentity CardSynthesizer::randomIdentity(RNG& rng) {
+    SynthIdentity id;
+    id.tckn = randomTCKN(rng);
+    id.sex = rng.uniform(0, 2) == 0 ? 'M' : 'F';
+    id.surname = pick(rng, SURNAMES);
+    id.name = id.sex == 'M' ? pick(rng, MALE_NAMES) : pick(rng, FEMALE_NAMES);
+
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%02d.%02d.%04d", rng.uniform(1, 29), rng.uniform(1, 13), rng.uniform(1950, 2008));
+    id.birthDate = buf;
+    snprintf(buf, sizeof(buf), "%02d%02d%02d", rng.uniform(26, 37), rng.uniform(1, 13), rng.uniform(1, 29));
+    id.expiry = buf;
+
+    const int letters = static_cast<int>(sizeof(SERIAL_LETTERS) - 1);
+    id.serial = string(1, SERIAL_LETTERS[rng.uniform(0, letters)]);
+    id.serial += to_string(rng.uniform(10, 100));
+    id.serial += SERIAL_LETTERS[rng.uniform(0, letters)];
+    snprintf(buf, sizeof(buf), "%05d", rng.uniform(0, 100000));
+    id.serial += buf;
+
+    id.mrz = buildMRZ(id);
+    return id;
+}
+
+array<string, 3> CardSynthesizer::buildMRZ(const SynthIdentity& id) {
+    auto check = [](const string& data) {
+        return static_cast<char>('0' + MRZValidator::calculateChecksum(data));
+    };
+
+    // Line 1: I<TUR + document number + check, TCKN in the optional data (16-26)
+    string line1 = "I<TUR" + id.serial + check(id.serial) + "<" + id.tckn;
+    line1.resize(30, '<');
+
+    // Line 2: DOB (YYMMDD from DD.MM.YYYY), sex, expiry, nationality, composite
+    const string dob = id.birthDate.substr(8, 2) + id.birthDate.substr(3, 2) + id.birthDate.substr(0, 2);
+    string line2 = dob + check(dob) + id.sex + id.expiry + check(id.expiry) + "TUR";
+    line2.resize(29, '<');
+    line2 += check(line1.substr(5, 25) + line2.substr(0, 7) + line2.substr(8, 7) + line2.substr(18, 11));
+
+    string line3 = id.surname + "<<" + id.name;
+    line3.resize(30, '<');
+    return { line1, line2, line3 };
+}
+
+// ==================== Rendering ====================
+
+Rect CardSynthesizer::drawText(Mat& card, const GlyphAtlas& atlas, const string& text,
+                               Point origin, const Scalar& ink) {
+    const Rect bounds(0, 0, card.cols, card.rows);
+    int x = origin.x;
+    for (char ch : text) {
+        int c = static_cast<unsigned char>(ch);
+        if (c >= 128 || atlas.masks[c].empty()) c = '?';
+        const Mat& mask = atlas.masks[c];
+        const Rect cell = Rect(x, origin.y, mask.cols, mask.rows) & bounds;
+        for (int y = cell.y; y < cell.br().y; ++y) {
+            const uchar* m = mask.ptr<uchar>(y - origin.y) + (cell.x - x);
+            uchar* d = card.ptr<uchar>(y) + 3 * cell.x;
+            for (int i = 0; i < cell.width; ++i, d += 3) {
+                if (m[i] == 0) continue;
+                for (int k = 0; k < 3; ++k) {
+                    d[k] = static_cast<uchar>(d[k] + (static_cast<int>(ink[k]) - d[k]) * m[i] / 255);
+                }
+            }
+        }
+        x += atlas.advance[c];
+    }
+    return Rect(origin.x, origin.y, x - origin.x, atlas.height);
+}
+
+void CardSynthesizer::renderCard(const SynthIdentity& id, bool isBackSide, RNG& rng,
+                                 Mat& card, vector<CorpusField>& fields) const {
+    const int shade = rng.uniform(-15, 16);
+    const Scalar ink(35 + shade, 30 + shade, 45 + shade);
+    fields.clear();
+
+    if (isBackSide) {
+        backTemplate_.copyTo(card);
+        const ROIRegion lines[3] = { BackROI::MRZ_LINE1, BackROI::MRZ_LINE2, BackROI::MRZ_LINE3 };
+        for (int i = 0; i < 3; ++i) {
+            Rect r = regionRect(lines[i]);
+            Point origin(r.x + (r.width - 30 * MRZ_PITCH) / 2, r.y + (r.height - mrzFont_.height) / 2);
+            Rect box = drawText(card, mrzFont_, id.mrz[i], origin, ink);
+            fields.push_back({ ROIType::MRZ, id.mrz[i], quadOf(box) });
+            if (i == 1) {
+                Rect expiry(origin.x + 8 * MRZ_PITCH, box.y, 6 * MRZ_PITCH, box.height);
+                fields.push_back({ ROIType::EXPIRY, id.expiry, quadOf(expiry) });
+            }
+        }
+        return;
+    }
+
+    frontTemplate_.copyTo(card);
+    const pair<ROIType, const string*> values[] = {
+        { ROIType::TCKN, &id.tckn },
+        { ROIType::SURNAME, &id.surname },
+        { ROIType::NAME, &id.name },
+        { ROIType::BIRTHDATE, &id.birthDate },
+        { ROIType::SERIAL, &id.serial }
+    };
+    for (const auto& value : values) {
+        Rect r = regionRect(getROIRegion(value.first, false));
+        Point origin(r.x + 4, r.br().y - valueFont_.height - 1);
+        Rect box = drawText(card, valueFont_, *value.second, origin, ink);
+        fields.push_back({ value.first, *value.second, quadOf(box) });
+    }
+    Rect photo = regionRect(FrontROI::PHOTO);
+    fields.push_back({ ROIType::PHOTO, "", quadOf(photo) });
+
+    if (rng.uniform(0.f, 1.f) < config_.hologramProbability) {
+        Rect zone = regionRect(FrontROI::HOLOGRAM_ZONE);
+        Rect crop(rng.uniform(0, hologram_.cols - zone.width), rng.uniform(0, hologram_.rows - zone.height),
+                  zone.width, zone.height);
+        Mat target = card(zone);
+        addWeighted(target, 0.72, hologram_(crop), 0.28, 0, target);
+    }
+}
+
+void CardSynthesizer::addEffects(Mat& frame, const Rect& cardBox, RNG& rng) const {
+    const Rect bounds(0, 0, frame.cols, frame.rows);
+
+    if (rng.uniform(0.f, 1.f) < config_.gradientProbability) {
+        multiply(frame, gradients_[rng.uniform(0, static_cast<int>(gradients_.size()))], frame, 1.0 / 255.0);
+    }
+
+    if (rng.uniform(0.f, 1.f) < config_.glareProbability) {
+        const Mat& sprite = glareSprites_[rng.uniform(0, static_cast<int>(glareSprites_.size()))];
+        Point center(rng.uniform(cardBox.x, cardBox.br().x), rng.uniform(cardBox.y, cardBox.br().y));
+        Rect spot(center.x - sprite.cols / 2, center.y - sprite.rows / 2, sprite.cols, sprite.rows);
+        Rect clipped = spot & bounds;
+        if (clipped.area() > 0) {
+            Mat target = frame(clipped);
+            add(target, sprite(clipped - spot.tl()), target);
+        }
+    }
+
+    if (rng.uniform(0.f, 1.f) < config_.blurProbability) {
+        const int k = rng.uniform(0, 2) == 0 ? 3 : 5;
+        Rect region = Rect(cardBox.x - 8, cardBox.y - 8, cardBox.width + 16, cardBox.height + 16) & bounds;
+        Mat target = frame(region);
+        GaussianBlur(target, target, Size(k, k), 0);
+    }
+
+    const int level = rng.uniform(0, static_cast<int>(noisePositive_.size()));
+    Rect crop(rng.uniform(0, MARGIN + 1), rng.uniform(0, MARGIN + 1), frame.cols, frame.rows);
+    add(frame, noisePositive_[level](crop), frame);
+    subtract(frame, noiseNegative_[level](crop), frame);
+}
+
+void CardSynthesizer::render(uint64_t index, CorpusSample& sample) const {
+    RNG rng((seed_ * 0x9E3779B97F4A7C15ULL) ^ ((index + 1) * 0xBF58476D1CE4E5B9ULL));
+    const int W = config_.frameSize.width;
+    const int H = config_.frameSize.height;
+
+    const bool isBackSide = rng.uniform(0.f, 1.f) < config_.backSideRatio;
+    const SynthIdentity id = randomIdentity(rng);
+
+    Mat card;
+    vector<CorpusField> fields;
+    renderCard(id, isBackSide, rng, card, fields);
+
+    // Background crop
+    const Mat& bg = backgrounds_[rng.uniform(0, static_cast<int>(backgrounds_.size()))];
+    bg(Rect(rng.uniform(0, MARGIN + 1), rng.uniform(0, MARGIN + 1), W, H)).copyTo(sample.image);
+    Mat& frame = sample.image;
+
+    // Pose: scale, rotation, centre that keeps the card inside, per-corner jitter
+    float cardW = W * rng.uniform(config_.minCardScale, config_.maxCardScale);
+    float cardH = cardW * TARGET_HEIGHT / TARGET_WIDTH;
+    if (cardH > H * 0.85f) {
+        cardH = H * 0.85f;
+        cardW = cardH * TARGET_WIDTH / TARGET_HEIGHT;
+    }
+    const double angle = rng.uniform(-config_.maxRotationDeg, config_.maxRotationDeg) * CV_PI / 180.0;
+    const float ca = static_cast<float>(cos(angle)), sa = static_cast<float>(sin(angle));
+    const float jitter = config_.maxPerspective * cardW;
+    const float rx = 0.5f * (abs(ca) * cardW + abs(sa) * cardH) + jitter;
+    const float ry = 0.5f * (abs(sa) * cardW + abs(ca) * cardH) + jitter;
+    const float cx = (W > 2 * rx) ? rng.uniform(rx, W - rx) : W * 0.5f;
+    const float cy = (H > 2 * ry) ? rng.uniform(ry, H - ry) : H * 0.5f;
+
+    const Point2f half[4] = {
+        Point2f(-cardW / 2, -cardH / 2), Point2f(cardW / 2, -cardH / 2),
+        Point2f(cardW / 2, cardH / 2), Point2f(-cardW / 2, cardH / 2)
+    };
+    Point2f src[4] = {
+        Point2f(0, 0), Point2f(TARGET_WIDTH - 1, 0),
+        Point2f(TARGET_WIDTH - 1, TARGET_HEIGHT - 1), Point2f(0, TARGET_HEIGHT - 1)
+    };
+    Point2f dst[4];
+    for (int i = 0; i < 4; ++i) {
+        dst[i] = Point2f(cx + half[i].x * ca - half[i].y * sa + rng.uniform(-jitter, jitter),
+                         cy + half[i].x * sa + half[i].y * ca + rng.uniform(-jitter, jitter));
+    }
+    Mat homography = getPerspectiveTransform(src, dst);
+
+    // Warp into the card's bounding box only
+    vector<Point2f> quad(dst, dst + 4);
+    Rect cardBox = boundingRect(quad) & Rect(0, 0, W, H);
+    Mat shift = (Mat_<double>(3, 3) << 1, 0, -cardBox.x, 0, 1, -cardBox.y, 0, 0, 1);
+    Mat target = frame(cardBox);
+    warpPerspective(card, target, shift * homography, cardBox.size(), INTER_LINEAR, BORDER_TRANSPARENT);
+
+    addEffects(frame, cardBox, rng);
+
+    // Ground truth in frame pixels (fields were laid out in card pixels)
+    CorpusLabel& label = sample.label;
+    label = CorpusLabel();
+    label.isBackSide = isBackSide;
+    label.tckn = id.tckn;
+    if (isBackSide) label.mrz = id.mrz;
+    for (const Point2f& p : quad) {
+        label.corners.push_back(Point(cvRound(p.x), cvRound(p.y)));
+    }
+    for (CorpusField& field : fields) {
+        vector<Point2f> cardQuad, frameQuad;
+        for (const Point& p : field.quad) cardQuad.push_back(Point2f(p));
+        perspectiveTransform(cardQuad, frameQuad, homography);
+        field.quad.clear();
+        for (const Point2f& p : frameQuad) {
+            field.quad.push_back(Point(cvRound(p.x), cvRound(p.y)));
+        }
+        label.fields.push_back(field);
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), "synth_%07llu", static_cast<unsigned long long>(index));
+    sample.name = name;
+}
+
+// ==================== SyntheticCorpus ====================
+
+SyntheticCorpus::SyntheticCorpus(size_t count, const SynthConfig& config, uint64_t seed)
+    : count_(count), synthesizer_(config, seed) {}
+
+bool SyntheticCorpus::load(size_t index, CorpusSample& sample) const {
+    if (index >= count_) return false;
+    synthesizer_.render(index, sample);
+    return true;
+}
+
+} // namespace idverify
@@ -0,0 +1,139 @@
+#ifndef SYNTHETIC_CARD_H
+#define SYNTHETIC_CARD_H
+
+#include <opencv2/core.hpp>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Corpus.h"
+
+namespace idverify {
+
+/**
+ * Capture conditions of rendered frames
+ */
+struct SynthConfig {
+    cv::Size frameSize = cv::Size(1280, 720);
+    float minCardScale = 0.45f;       // Card width / frame width
+    float maxCardScale = 0.80f;
+    float maxPerspective = 0.06f;     // Corner jitter as a fraction of card width
+    float maxRotationDeg = 8.0f;
+    float backSideRatio = 0.5f;       // Share of back-side (MRZ) frames
+    float blurProbability = 0.3f;     // 3x3 or 5x5 Gaussian defocus
+    float glareProbability = 0.3f;    // Specular spot over the card
+    float hologramProbability = 0.6f; // Rainbow overlay on the front hologram zone
+    float gradientProbability = 0.7f; // Directional illumination falloff
+    float gradientStrength = 0.45f;   // Darkest corner = 1 - strength
+};
+
+/**
+ * Identity printed on one synthetic card
+ */
+struct SynthIdentity {
+    std::string tckn;           // Valid per MRZValidator::validateTCKN
+    std::string surname;
+    std::string name;
+    std::string birthDate;      // DD.MM.YYYY (front)
+    std::string serial;         // Document number, 9 chars
+    std::string expiry;         // YYMMDD (MRZ)
+    char sex;                   // 'M' or 'F'
+    std::array<std::string, 3> mrz;  // TD1 lines with ICAO check digits
+};
+
+/**
+ * CardSynthesizer - Renders labeled TCKK frames for benchmark corpora
+ *
+ * Cards follow the FrontROI/BackROI layout on an 856x540 canvas and are
+ * composited onto textured backgrounds with random perspective, blur,
+ * sensor noise, glare spots, hologram overlays and illumination
+ * gradients. Everything that is expensive per pixel (backgrounds, noise,
+ * gradients, glyphs, sprites) is prepared once in the constructor; a frame
+ * is then a handful of copies, a bounding-box warp and saturating adds.
+ *
+ * render() is const and deterministic per (seed, index), so corpora are
+ * reproducible and can be rendered from many threads.
+ */
+class CardSynthesizer {
+public:
+    explicit CardSynthesizer(const SynthConfig& config = SynthConfig(), uint64_t seed = 1);
+
+    /**
+     * Render one frame with exact corner and field ground truth
+     * @param index Frame index (same index, same frame)
+     */
+    void render(uint64_t index, CorpusSample& sample) const;
+
+    /**
+     * Random 11-digit TCKN with valid check digits
+     */
+    static std::string randomTCKN(cv::RNG& rng);
+
+    /**
+     * Random identity with a matching TD1 MRZ
+     */
+    static SynthIdentity randomIdentity(cv::RNG& rng);
+
+    /**
+     * TD1 lines for an identity (check digits via MRZValidator)
+     */
+    static std::array<std::string, 3> buildMRZ(const SynthIdentity& identity);
+
+    /**
+     * Fixed-size glyph masks of one font (printable ASCII)
+     */
+    struct GlyphAtlas {
+        int height = 0;
+        std::array<cv::Mat, 128> masks;     // CV_8U coverage
+        std::array<int, 128> advance{};
+    };
+
+private:
+    /**
+     * Draw text at a top-left origin on the card
+     * @return Text box on the card
+     */
+    static cv::Rect drawText(cv::Mat& card, const GlyphAtlas& atlas, const std::string& text,
+                             cv::Point origin, const cv::Scalar& ink);
+
+    void renderCard(const SynthIdentity& identity, bool isBackSide, cv::RNG& rng,
+                    cv::Mat& card, std::vector<CorpusField>& fields) const;
+
+    void addEffects(cv::Mat& frame, const cv::Rect& cardBox, cv::RNG& rng) const;
+
+    SynthConfig config_;
+    uint64_t seed_;
+
+    GlyphAtlas captionFont_;    // Field captions
+    GlyphAtlas valueFont_;      // Front field values
+    GlyphAtlas mrzFont_;        // Fixed-pitch MRZ
+
+    cv::Mat frontTemplate_;     // Static print of each side (856x540 BGR)
+    cv::Mat backTemplate_;
+    cv::Mat hologram_;          // Front hologram zone overlay
+
+    std::vector<cv::Mat> backgrounds_;    // Frame + margin, cropped at random offsets
+    std::vector<cv::Mat> noisePositive_;  // Per noise level, frame + margin
+    std::vector<cv::Mat> noiseNegative_;
+    std::vector<cv::Mat> gradients_;      // Per direction, attenuation * 255
+    std::vector<cv::Mat> glareSprites_;   // Per spot size
+};
+
+/**
+ * SyntheticCorpus - Corpus of COUNT rendered frames ("synth:COUNT[:SEED]")
+ */
+class SyntheticCorpus : public Corpus {
+public:
+    SyntheticCorpus(size_t count, const SynthConfig& config, uint64_t seed);
+
+    size_t size() const override { return count_; }
+    bool load(size_t index, CorpusSample& sample) const override;
+
+private:
+    size_t count_;
+    CardSynthesizer synthesizer_;
+};
+
+} // namespace idverify
+
+#endif // SYNTHETIC_CARD_H
@@ -0,0 +1,397 @@
+/**
+ * idverify-bench - End-to-end corpus benchmark for the native pipeline
+ *
+ *   idverify-bench run <corpus> [--jobs N] [--out report.json]
+ *                               [--level 0-2] [--denoise nlm|gaussian|none]
+ *                               [--mrz-templates file]
+ *   idverify-bench train-mrz <corpus> <out-templates> [--min-samples 5]
+ *   idverify-bench compare <baseline.json> <current.json>
+ *                               [--latency-tolerance 0.10] [--accuracy-tolerance 0.005]
+ *
+ * run pushes every corpus image through detection, warp, glare, binarize,
+ * MRZ band and field ROIs (the processForOCR path plus ROI preprocessing),
+ * samples spread over N worker threads with OpenCV single-threaded inside
+ * each. Accuracy is scored against the corpus labels; per-stage latency
+ * comes from the process-wide Metrics histograms.
+ *
+ * Back sides are read with MRZReader and decoded with MRZDecoder. Without
+ * --mrz-templates the reader uses its built-in Hershey templates, the same
+ * font idverify-synth draws, so MRZ rates on synthetic corpora are then
+ * optimistic and say nothing about OCR-B cards. The MRZ rates score the
+ * recognized text (read rate, per-character accuracy of the raw read
+ * against the label, the validateWithScore pass rate and the exact-match
+ * rate of the decoded MRZ). The TCKN rate counts back sides
+ * whose decoded MRZ carries a valid TCKN equal to the label.
+ *
+ * train-mrz averages MRZ cells of labeled back sides (warped with the
+ * labeled corners) into a template file for --mrz-templates and
+ * NativeProcessor.loadMRZTemplates.
+ *
+ * compare exits with 1 when any accuracy rate drops or latency grows
+ * beyond the tolerances, so CI can gate on it.
+ */
+
+#include "BenchReport.h"
+#include "Corpus.h"
+#include "../DeviceProfile.h"
+#include "../GlareMap.h"
+#include "../MRZDecoder.h"
+#include "../MRZParser.h"
+#include "../MRZReader.h"
+#include "../Metrics.h"
+#include "../VisionProcessor.h"
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cv;
+using namespace std;
+using namespace idverify;
+
+namespace {
+
+using Clock = chrono::steady_clock;
+
+// Fields read from each side after the card is warped
+const ROIType FRONT_FIELDS[] = {
+    ROIType::TCKN, ROIType::SURNAME, ROIType::NAME, ROIType::BIRTHDATE, ROIType::SERIAL
+};
+
+/**
+ * Outcome of one sample
+ */
+struct SampleResult {
+    bool loaded = false;
+    bool detected = false;
+    bool hasCornerLabel = false;
+    float cornerErrorPx = 0.0f;     // Mean distance of ordered corners
+    bool hasMRZ = false;
+    bool mrzRead = false;
+    int mrzCharsCorrect = 0;
+    bool mrzValid = false;
+    bool mrzExact = false;
+    bool hasTCKN = false;
+    bool tcknValid = false;
+    double totalMs = 0.0;
+};
+
+struct RunOptions {
+    string corpus;
+    string out = "-";
+    int jobs = 0;
+    PipelineSettings settings;
+    string mrzTemplates;
+};
+
+float cornerError(const vector<Point>& detected, const vector<Point>& truth) {
+    vector<Point2f> a = VisionProcessor::orderCorners(detected);
+    vector<Point2f> b = VisionProcessor::orderCorners(truth);
+    float sum = 0.0f;
+    for (int i = 0; i < 4; ++i) {
+        sum += static_cast<float>(norm(a[i] - b[i]));
+    }
+    return sum / 4.0f;
+}
+
+/**
+ * Same stages as VisionProcessor::processForOCR, keeping the corners
+ */
+SampleResult runSample(const CorpusSample& sample, const PipelineSettings& settings, const MRZReader& reader) {
+    SampleResult r;
+    r.loaded = true;
+
+    // The JNI paths hand the pipeline BGR (bitmapToBGR), as the corpus decodes
+    const Mat& bgr = sample.image;
+    const CorpusLabel& label = sample.label;
+
+    MRZReadResult mrz;
+    mrz.found = false;
+    auto start = Clock::now();
+    CornerResult corners = VisionProcessor::findCardCorners(bgr, settings.detectionPyramidLevel);
+    if (corners.detected) {
+        Mat warped = VisionProcessor::warpToID1(bgr, corners.corners, settings.warpInterpolation);
+        if (!warped.empty()) {
+            r.detected = true;
+            GlareMap::compute(warped, label.isBackSide);
+            VisionProcessor::binarizeForOCR(warped, settings.denoise);
+            if (label.isBackSide) {
+                VisionProcessor::extractMRZRegion(warped, settings.denoise);
+                VisionProcessor::extractROI(warped, ROIType::MRZ, true);
+                mrz = reader.read(warped);
+            } else {
+                for (ROIType type : FRONT_FIELDS) {
+                    VisionProcessor::extractROI(warped, type, false);
+                }
+            }
+        }
+    }
+    MRZDecodeResult decoded;
+    MRZFields fields = {};
+    if (mrz.found) {
+        decoded = MRZDecoder::decode(mrz);
+        ValidationScore score = MRZValidator::validateWithScore(decoded.lines[0], decoded.lines[1], decoded.lines[2]);
+        r.mrzRead = true;
+        r.mrzValid = score.docNumValid && score.dobValid && score.expiryValid && score.compositeValid;
+        fields = MRZParser::parse(decoded.lines[0], decoded.lines[1], decoded.lines[2]);
+    }
+    r.totalMs = chrono::duration<double, milli>(Clock::now() - start).count();
+
+    if (label.hasMRZ()) {
+        r.hasMRZ = true;
+        for (int i = 0; i < MRZ_LINE_COUNT && mrz.found; ++i) {
+            for (int k = 0; k < MRZ_LINE_LENGTH && k < static_cast<int>(label.mrz[i].size()); ++k) {
+                r.mrzCharsCorrect += (mrz.lines[i][k] == label.mrz[i][k]) ? 1 : 0;
+            }
+        }
+        r.mrzExact = mrz.found && decoded.lines == label.mrz;
+    }
+
+    // TCKN as read from the MRZ: passes its own checks and matches the label
+    if (label.hasMRZ() && !label.tckn.empty()) {
+        r.hasTCKN = true;
+        r.tcknValid = mrz.found && fields.tcknValid && fields.tckn == label.tckn;
+    }
+    if (label.corners.size() == 4) {
+        r.hasCornerLabel = true;
+        if (r.detected) r.cornerErrorPx = cornerError(corners.corners, label.corners);
+    }
+    return r;
+}
+
+double rate(uint64_t hits, uint64_t total) {
+    return total > 0 ? static_cast<double>(hits) / total : 0.0;
+}
+
+int run(const RunOptions& options) {
+    unique_ptr<Corpus> corpus = Corpus::open(options.corpus);
+    if (!corpus) {
+        return 2;
+    }
+
+    const int jobs = options.jobs > 0 ? options.jobs : std::max(1u, thread::hardware_concurrency());
+    setNumThreads(1);   // Parallelism is across samples
+    Metrics::instance().setEnabled(true);
+    Metrics::instance().reset();
+
+    MRZReader reader;
+    if (!options.mrzTemplates.empty() && !reader.loadTemplates(options.mrzTemplates)) {
+        fprintf(stderr, "idverify-bench: cannot load MRZ templates %s\n", options.mrzTemplates.c_str());
+        return 2;
+    }
+    if (options.mrzTemplates.empty()) {
+        fprintf(stderr, "idverify-bench: built-in Hershey MRZ templates (the synthetic corpus font); "
+                        "MRZ rates are not OCR-B accuracy, pass --mrz-templates\n");
+    }
+
+    vector<SampleResult> results(corpus->size());
+    atomic<size_t> next(0);
+    auto wallStart = Clock::now();
+
+    vector<thread> workers;
+    for (int j = 0; j < jobs; ++j) {
+        workers.emplace_back([&] {
+            CorpusSample sample;
+            for (size_t i = next.fetch_add(1); i < results.size(); i = next.fetch_add(1)) {
+                if (corpus->load(i, sample)) {
+                    results[i] = runSample(sample, options.settings, reader);
+                } else {
+                    fprintf(stderr, "idverify-bench: cannot load sample %zu\n", i);
+                }
+            }
+        });
+    }
+    for (thread& t : workers) t.join();
+
+    BenchReport report;
+    report.corpus = options.corpus;
+    report.jobs = jobs;
+    report.wallSeconds = chrono::duration<double>(Clock::now() - wallStart).count();
+
+    uint64_t detected = 0, cornerLabeled = 0, cornerOk = 0, tckn = 0, tcknOk = 0;
+    uint64_t mrz = 0, mrzRead = 0, mrzChars = 0, mrzOk = 0, mrzExact = 0;
+    double cornerErrorSum = 0.0;
+    uint64_t cornerErrorCount = 0;
+    vector<double> totals;
+    for (const SampleResult& r : results) {
+        if (!r.loaded) {
+            report.loadFailures++;
+            continue;
+        }
+        report.samples++;
+        totals.push_back(r.totalMs);
+        detected += r.detected ? 1 : 0;
+        if (r.hasCornerLabel) {
+            cornerLabeled++;
+            if (r.detected) {
+                cornerErrorSum += r.cornerErrorPx;
+                cornerErrorCount++;
+                cornerOk += (r.cornerErrorPx <= DeviceCalibrator::CORNER_TOLERANCE_PX) ? 1 : 0;
+            }
+        }
+        if (r.hasMRZ) {
+            mrz++;
+            mrzRead += r.mrzRead ? 1 : 0;
+            mrzChars += r.mrzCharsCorrect;
+            mrzOk += r.mrzValid ? 1 : 0;
+            mrzExact += r.mrzExact ? 1 : 0;
+        }
+        tckn += r.hasTCKN ? 1 : 0;
+        tcknOk += r.tcknValid ? 1 : 0;
+    }
+
+    report.framesPerSecond = report.wallSeconds > 0.0 ? report.samples / report.wallSeconds : 0.0;
+    report.detectionRate = rate(detected, report.samples);
+    report.cornerAccuracy = rate(cornerOk, cornerLabeled);
+    report.meanCornerErrorPx = cornerErrorCount > 0 ? cornerErrorSum / cornerErrorCount : 0.0;
+    report.mrzReadRate = rate(mrzRead, mrz);
+    report.mrzCharAccuracy = rate(mrzChars, mrz * MRZ_LINE_COUNT * MRZ_LINE_LENGTH);
+    report.mrzChecksumPassRate = rate(mrzOk, mrz);
+    report.mrzExactRate = rate(mrzExact, mrz);
+    report.tcknValidRate = rate(tcknOk, tckn);
+    report.total = summarize(totals);
+    for (int i = 0; i < METRIC_STAGE_COUNT; ++i) {
+        report.stages[i] = summarize(Metrics::instance().histogram(static_cast<MetricStage>(i)));
+    }
+
+    fprintf(stderr, "idverify-bench: %llu samples, %.1f fps, detection %.2f%%, p95 %.2f ms\n",
+            static_cast<unsigned long long>(report.samples), report.framesPerSecond,
+            report.detectionRate * 100.0, report.total.p95Ms);
+    return writeReport(report, options.out) ? 0 : 2;
+}
+
+int trainMRZ(const string& corpusPath, const string& outPath, int minSamples) {
+    unique_ptr<Corpus> corpus = Corpus::open(corpusPath);
+    if (!corpus) {
+        return 2;
+    }
+
+    MRZReader reader;
+    CorpusSample sample;
+    size_t bands = 0, cells = 0;
+    for (size_t i = 0; i < corpus->size(); ++i) {
+        if (!corpus->load(i, sample)) continue;
+        const CorpusLabel& label = sample.label;
+        if (!label.isBackSide || !label.hasMRZ() || label.corners.size() != 4) continue;
+
+        // Labeled corners: the templates should not learn detection error
+        Mat warped = VisionProcessor::warpToID1(sample.image, label.corners);
+        if (warped.empty()) continue;
+        int learned = reader.learn(VisionProcessor::cropROI(warped, BackROI::MRZ), label.mrz);
+        bands += learned > 0 ? 1 : 0;
+        cells += learned;
+    }
+
+    const int replaced = reader.finishLearning(minSamples);
+    if (replaced == 0 || !reader.saveTemplates(outPath)) {
+        fprintf(stderr, "idverify-bench: no templates written (%zu bands segmented)\n", bands);
+        return 1;
+    }
+    fprintf(stderr, "idverify-bench: %d/%d templates from %zu cells in %zu bands -> %s\n",
+            replaced, MRZ_ALPHABET_SIZE, cells, bands, outPath.c_str());
+    return 0;
+}
+
+int compare(const string& baselinePath, const string& currentPath,
+            double latencyTolerance, double accuracyTolerance) {
+    map<string, double> baseline, current;
+    if (!readReportNumbers(baselinePath, baseline) || !readReportNumbers(currentPath, current)) {
+        return 2;
+    }
+
+    vector<Regression> regressions = compareReports(baseline, current, latencyTolerance, accuracyTolerance);
+    for (const Regression& r : regressions) {
+        printf("REGRESSION %-32s %12.4f -> %12.4f\n", r.key.c_str(), r.baseline, r.current);
+    }
+    if (regressions.empty()) {
+        printf("OK: no regressions (latency +%.0f%%, accuracy -%.3f)\n",
+               latencyTolerance * 100.0, accuracyTolerance);
+        return 0;
+    }
+    return 1;
+}
+
+void usage() {
+    fprintf(stderr,
+            "usage: idverify-bench run <corpus> [--jobs N] [--out report.json]\n"
+            "                          [--level 0-2] [--denoise nlm|gaussian|none] [--mrz-templates file]\n"
+            "       idverify-bench train-mrz <corpus> <out-templates> [--min-samples 5]\n"
+            "       idverify-bench compare <baseline.json> <current.json>\n"
+            "                          [--latency-tolerance 0.10] [--accuracy-tolerance 0.005]\n");
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        usage();
+        return 2;
+    }
+    const string mode = argv[1];
+
+    if (mode == "run") {
+        RunOptions options;
+        options.corpus = argv[2];
+        for (int i = 3; i < argc; ++i) {
+            const bool hasValue = i + 1 < argc;
+            if (strcmp(argv[i], "--jobs") == 0 && hasValue) {
+                options.jobs = atoi(argv[++i]);
+            } else if (strcmp(argv[i], "--out") == 0 && hasValue) {
+                options.out = argv[++i];
+            } else if (strcmp(argv[i], "--level") == 0 && hasValue) {
+                options.settings.detectionPyramidLevel = std::min(2, std::max(0, atoi(argv[++i])));
+            } else if (strcmp(argv[i], "--denoise") == 0 && hasValue) {
+                const string tier = argv[++i];
+                options.settings.denoise = tier == "none" ? DenoiseTier::NONE
+                                         : tier == "gaussian" ? DenoiseTier::GAUSSIAN : DenoiseTier::NLM;
+            } else if (strcmp(argv[i], "--mrz-templates") == 0 && hasValue) {
+                options.mrzTemplates = argv[++i];
+            } else {
+                usage();
+                return 2;
+            }
+        }
+        return run(options);
+    }
+
+    if (mode == "train-mrz" && argc >= 4) {
+        int minSamples = 5;
+        for (int i = 4; i < argc; ++i) {
+            if (strcmp(argv[i], "--min-samples") == 0 && i + 1 < argc) {
+                minSamples = atoi(argv[++i]);
+            } else {
+                usage();
+                return 2;
+            }
+        }
+        return trainMRZ(argv[2], argv[3], minSamples);
+    }
+
+    if (mode == "compare" && argc >= 4) {
+        double latencyTolerance = 0.10;
+        double accuracyTolerance = 0.005;
+        for (int i = 4; i < argc; ++i) {
+            const bool hasValue = i + 1 < argc;
+            if (strcmp(argv[i], "--latency-tolerance") == 0 && hasValue) {
+                latencyTolerance = atof(argv[++i]);
+            } else if (strcmp(argv[i], "--accuracy-tolerance") == 0 && hasValue) {
+                accuracyTolerance = atof(argv[++i]);
+            } else {
+                usage();
+                return 2;
+            }
+        }
+        return compare(argv[2], argv[3], latencyTolerance, accuracyTolerance);
+    }
+
+    usage();
+    return 2;
+}
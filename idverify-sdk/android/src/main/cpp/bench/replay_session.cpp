@@ -0,0 +1,165 @@
+/**
+ * idverify-replay - Feed a recorded session back through ScanSession
+ *
+ *   idverify-replay <recording.idvr> [--free-run] [--threads N] [--show N]
+ *
+ * Frames come straight from the mapping and go through processFrame in
+ * recorded order. By default the governor is pinned to the level recorded
+ * for every frame and there is no frame deadline, so the cascade sees the
+ * same settings and frame-skip pattern as on the device; each replayed
+ * decision is compared with the recorded one. --free-run lets the host
+ * governor adapt instead (latency profiling, decisions will diverge).
+ *
+ * Frames cancelled on the device (deadline or cancel()) cannot be
+ * reproduced and are counted separately. Results also depend on the
+ * session config; a session created with a calibrated device profile or
+ * custom cascade thresholds replays with the defaults here.
+ *
+ * Exits with 1 if any decision differs.
+ */
+
+#include "BenchReport.h"
+#include "../FrameRecord.h"
+#include "../Metrics.h"
+#include "../ScanSession.h"
+#include "../Trace.h"
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace cv;
+using namespace std;
+using namespace idverify;
+
+namespace {
+
+const char* RESULT_NAMES[] = {
+    "presence", "quality", "detection", "warp", "roi", "passed", "skipped", "cancelled"
+};
+
+const char* resultName(int code) {
+    return code >= 0 && code <= FrameDecision::CANCELLED ? RESULT_NAMES[code] : "none";
+}
+
+void usage() {
+    fprintf(stderr, "usage: idverify-replay <recording.idvr> [--free-run] [--threads N] [--show N]\n");
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage();
+        return 2;
+    }
+
+    bool freeRun = false;
+    int threads = 1;
+    int show = 20;
+    for (int i = 2; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--free-run") == 0) {
+            freeRun = true;
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--show") == 0 && hasValue) {
+            show = atoi(argv[++i]);
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    FrameReplay replay;
+    if (!replay.open(argv[1])) {
+        fprintf(stderr, "idverify-replay: %s is not a finished recording\n", argv[1]);
+        return 2;
+    }
+
+    setNumThreads(threads);
+    Metrics::instance().setEnabled(false);
+    Trace::setEnabled(false);
+
+    SessionConfig config;
+    config.frameDeadlineMs = 0.0f;
+    ScanSession session(config);
+
+    // counts[recorded][replayed]; index FrameDecision::CANCELLED + 1 = no decision
+    const int codes = FrameDecision::CANCELLED + 2;
+    vector<vector<size_t>> counts(codes, vector<size_t>(codes, 0));
+    vector<double> recordedMs, replayedMs;
+    size_t mismatches = 0, deviceCancelled = 0;
+
+    Mat bgr;
+    RecordedFrame frame;
+    for (size_t i = 0; i < replay.size(); ++i) {
+        replay.frame(i, frame);
+        switch (replay.format()) {
+            case RecordFormat::BGR8:  bgr = frame.image; break;
+            case RecordFormat::RGBA8: cvtColor(frame.image, bgr, COLOR_RGBA2BGR); break;
+            case RecordFormat::Y8:    cvtColor(frame.image, bgr, COLOR_GRAY2BGR); break;
+        }
+
+        const FrameDecision& recorded = frame.decision;
+        if (recorded.flags & FrameDecision::FLAG_SESSION_RESET) {
+            session.reset();
+        }
+        if (!freeRun) {
+            session.governor().setLevel(recorded.governorLevel);
+        }
+
+        bool skipped = false;
+        CascadeResult result = session.processFrame(bgr, (recorded.flags & FrameDecision::FLAG_BACK_SIDE) != 0,
+                                                    &skipped);
+        const int code = FrameDecision::resultCode(result, skipped);
+        const int from = recorded.result >= 0 && recorded.result <= FrameDecision::CANCELLED
+                         ? recorded.result : codes - 1;
+        counts[from][code]++;
+
+        if (!skipped) replayedMs.push_back(result.totalMs);
+        if (recorded.result >= 0 && recorded.result != FrameDecision::SKIPPED) {
+            recordedMs.push_back(recorded.totalMs);
+        }
+
+        if (recorded.result == FrameDecision::CANCELLED) {
+            deviceCancelled++;
+        } else if (recorded.result >= 0 && recorded.result != code) {
+            if (static_cast<int>(mismatches) < show) {
+                fprintf(stderr, "frame %zu (t=%.3f s, level %d%s): recorded %s, replayed %s\n",
+                        i, frame.timestampUs / 1e6, recorded.governorLevel,
+                        recorded.memoHit ? ", memo" : "", resultName(recorded.result), resultName(code));
+            }
+            mismatches++;
+        }
+    }
+
+    printf("frames          %zu (%s)\n", replay.size(),
+           replay.format() == RecordFormat::Y8 ? "Y8" : replay.format() == RecordFormat::RGBA8 ? "RGBA8" : "BGR8");
+    printf("mismatches      %zu\n", mismatches);
+    printf("device-cancel   %zu (not reproducible)\n", deviceCancelled);
+
+    printf("\n%-10s", "rec\\rep");
+    for (int c = 0; c < codes - 1; ++c) printf(" %9.9s", RESULT_NAMES[c]);
+    printf("\n");
+    for (int r = 0; r < codes; ++r) {
+        size_t row = 0;
+        for (size_t n : counts[r]) row += n;
+        if (row == 0) continue;
+        printf("%-10s", r < codes - 1 ? RESULT_NAMES[r] : "none");
+        for (int c = 0; c < codes - 1; ++c) printf(" %9zu", counts[r][c]);
+        printf("\n");
+    }
+
+    LatencySummary device = summarize(recordedMs);
+    LatencySummary host = summarize(replayedMs);
+    printf("\n%-8s %8s %8s %8s %8s\n", "latency", "mean", "p50", "p95", "p99");
+    printf("%-8s %8.2f %8.2f %8.2f %8.2f\n", "device", device.meanMs, device.p50Ms, device.p95Ms, device.p99Ms);
+    printf("%-8s %8.2f %8.2f %8.2f %8.2f\n", "replay", host.meanMs, host.p50Ms, host.p95Ms, host.p99Ms);
+
+    return (!freeRun && mismatches > 0) ? 1 : 0;
+}
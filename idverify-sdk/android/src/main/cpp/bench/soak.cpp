@@ -0,0 +1,317 @@
+/**
+ * idverify-soak - Long-run memory and latency soak of the native pipeline
+ *
+ *   idverify-soak [source] [--frames 100000] [--window 5000] [--warmup 10000]
+ *                 [--pool 64] [--hold 8] [--session-frames 900] [--ocr-every 4]
+ *                 [--threads 1] [--csv soak.csv]
+ *                 [--max-rss-growth-mb 16] [--max-heap-growth-mb 8]
+ *                 [--max-fragmentation 0.75] [--max-latency-drift 0.25]
+ *
+ * source is anything Corpus::open accepts (default synth:256); a session
+ * recording (.idvr) replays a real kiosk stream. Up to --pool samples are
+ * loaded once and played as a camera stream: each is held for --hold
+ * frames with a 0-3 px tremor (views, no copies) so stability, tracking
+ * and the frame-hash memo see realistic input. Every frame goes through
+ * ScanSession::processFrame, every --ocr-every-th also through
+ * processForOCR; passing frames read the best ROIs and fuse the MRZ, and
+ * the session is reset every --session-frames frames like a kiosk between
+ * customers.
+ *
+ * Each window logs RSS, malloc in-use/free bytes (glibc mallinfo2), arena
+ * fragmentation and per-stage p50/p95. After --warmup frames, growth is
+ * the least-squares trend over the remaining windows extrapolated across
+ * them, so one noisy window does not fail a run. Exits with 1 when RSS or
+ * heap growth, peak fragmentation or the relative p50 drift exceeds its
+ * limit.
+ *
+ * The JNI layer (Bitmap locking, per-call Mats) is not part of the host
+ * build; run the same stream on a device to cover it.
+ */
+
+#include "BenchReport.h"
+#include "Corpus.h"
+#include "MemoryStats.h"
+#include "../ScanSession.h"
+#include "../Trace.h"
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace cv;
+using namespace std;
+using namespace idverify;
+
+namespace {
+
+using Clock = chrono::steady_clock;
+
+const char* STAGE_NAMES[CASCADE_STAGE_COUNT] = { "presence", "quality", "detection", "warp", "roi" };
+
+// Hand tremor offsets (px) cycled while a sample is held
+const Point TREMOR[] = { Point(0, 0), Point(1, 0), Point(1, 1), Point(2, 1), Point(3, 2), Point(2, 3),
+                         Point(1, 2), Point(0, 1) };
+const int TREMOR_MARGIN = 3;
+
+/**
+ * Measurements of one window of frames
+ */
+struct Window {
+    size_t endFrame = 0;
+    double seconds = 0.0;
+    MemorySample memory;
+    LatencySummary total;
+    array<LatencySummary, CASCADE_STAGE_COUNT> stages;
+    size_t passed = 0;
+};
+
+struct Limits {
+    double rssGrowthMB = 16.0;
+    double heapGrowthMB = 8.0;
+    double fragmentation = 0.75;
+    double latencyDrift = 0.25;     // Relative change of p50 frame latency
+};
+
+void usage() {
+    fprintf(stderr,
+            "usage: idverify-soak [source] [--frames N] [--window N] [--warmup N] [--pool N] [--hold N]\n"
+            "                     [--session-frames N] [--ocr-every N] [--threads N] [--csv FILE]\n"
+            "                     [--max-rss-growth-mb MB] [--max-heap-growth-mb MB]\n"
+            "                     [--max-fragmentation F] [--max-latency-drift R]\n");
+}
+
+double mb(double bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
+void writeCsvHeader(FILE* csv) {
+    fprintf(csv, "frame,seconds,rss_mb,heap_mb,in_use_mb,free_mb,fragmentation,passed,total_p50_ms,total_p95_ms");
+    for (const char* name : STAGE_NAMES) fprintf(csv, ",%s_p50_ms,%s_p95_ms", name, name);
+    fprintf(csv, "\n");
+}
+
+void writeCsvRow(FILE* csv, const Window& w) {
+    fprintf(csv, "%zu,%.3f,%.2f,%.2f,%.2f,%.2f,%.4f,%zu,%.3f,%.3f", w.endFrame, w.seconds,
+            mb(w.memory.rssBytes), mb(w.memory.heapBytes), mb(w.memory.inUseBytes), mb(w.memory.freeBytes),
+            w.memory.fragmentation(), w.passed, w.total.p50Ms, w.total.p95Ms);
+    for (const LatencySummary& s : w.stages) fprintf(csv, ",%.3f,%.3f", s.p50Ms, s.p95Ms);
+    fprintf(csv, "\n");
+    fflush(csv);
+}
+
+/**
+ * Trend of a window value over the measured span (last - first end frame)
+ */
+template <typename F>
+double trendGrowth(const vector<Window>& windows, F value) {
+    vector<double> x, y;
+    for (const Window& w : windows) {
+        x.push_back(static_cast<double>(w.endFrame));
+        y.push_back(value(w));
+    }
+    const double span = x.back() - x.front();
+    return trendSlope(x.data(), y.data(), static_cast<int>(x.size())) * span;
+}
+
+}
+
+int main(int argc, char** argv) {
+    string source = "synth:256";
+    size_t frames = 100000, window = 5000, warmup = 10000, poolSize = 64;
+    int hold = 8, sessionFrames = 900, ocrEvery = 4, threads = 1;
+    string csvPath;
+    Limits limits;
+
+    int first = 1;
+    if (argc > 1 && strncmp(argv[1], "--", 2) != 0) {
+        source = argv[1];
+        first = 2;
+    }
+    for (int i = first; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (!hasValue) {
+            usage();
+            return 2;
+        }
+        const char* arg = argv[i];
+        const char* value = argv[++i];
+        if (strcmp(arg, "--frames") == 0) frames = strtoull(value, nullptr, 10);
+        else if (strcmp(arg, "--window") == 0) window = strtoull(value, nullptr, 10);
+        else if (strcmp(arg, "--warmup") == 0) warmup = strtoull(value, nullptr, 10);
+        else if (strcmp(arg, "--pool") == 0) poolSize = strtoull(value, nullptr, 10);
+        else if (strcmp(arg, "--hold") == 0) hold = atoi(value);
+        else if (strcmp(arg, "--session-frames") == 0) sessionFrames = atoi(value);
+        else if (strcmp(arg, "--ocr-every") == 0) ocrEvery = atoi(value);
+        else if (strcmp(arg, "--threads") == 0) threads = atoi(value);
+        else if (strcmp(arg, "--csv") == 0) csvPath = value;
+        else if (strcmp(arg, "--max-rss-growth-mb") == 0) limits.rssGrowthMB = atof(value);
+        else if (strcmp(arg, "--max-heap-growth-mb") == 0) limits.heapGrowthMB = atof(value);
+        else if (strcmp(arg, "--max-fragmentation") == 0) limits.fragmentation = atof(value);
+        else if (strcmp(arg, "--max-latency-drift") == 0) limits.latencyDrift = atof(value);
+        else {
+            usage();
+            return 2;
+        }
+    }
+    if (frames == 0 || window == 0 || poolSize == 0 || hold <= 0) {
+        usage();
+        return 2;
+    }
+
+    unique_ptr<Corpus> corpus = Corpus::open(source);
+    if (!corpus) return 2;
+
+    vector<CorpusSample> pool;
+    for (size_t i = 0; i < corpus->size() && pool.size() < poolSize; ++i) {
+        CorpusSample sample;
+        if (corpus->load(i, sample) &&
+            sample.image.cols > 2 * TREMOR_MARGIN && sample.image.rows > 2 * TREMOR_MARGIN) {
+            pool.push_back(sample);
+        }
+    }
+    if (pool.empty()) {
+        fprintf(stderr, "idverify-soak: no usable frames in %s\n", source.c_str());
+        return 2;
+    }
+
+    FILE* csv = nullptr;
+    if (!csvPath.empty()) {
+        csv = fopen(csvPath.c_str(), "w");
+        if (csv == nullptr) {
+            fprintf(stderr, "idverify-soak: cannot write %s\n", csvPath.c_str());
+            return 2;
+        }
+        writeCsvHeader(csv);
+    }
+
+    setNumThreads(threads);
+    Trace::setEnabled(false);
+
+    ScanSession session;
+    vector<Window> windows;
+    vector<double> totalMs;
+    array<vector<double>, CASCADE_STAGE_COUNT> stageMs;
+    totalMs.reserve(window);
+    for (vector<double>& v : stageMs) v.reserve(window);
+    size_t passed = 0;
+
+    fprintf(stderr, "idverify-soak: %zu frames from %s (%zu pooled), window %zu, warmup %zu\n",
+            frames, source.c_str(), pool.size(), window, warmup);
+
+    const auto start = Clock::now();
+    for (size_t i = 0; i < frames; ++i) {
+        if (sessionFrames > 0 && i > 0 && i % sessionFrames == 0) {
+            session.reset();
+        }
+
+        const CorpusSample& sample = pool[(i / hold) % pool.size()];
+        const Point& d = TREMOR[i % (sizeof(TREMOR) / sizeof(TREMOR[0]))];
+        const Mat frame = sample.image(Rect(d.x, d.y, sample.image.cols - TREMOR_MARGIN,
+                                            sample.image.rows - TREMOR_MARGIN));
+        const bool isBackSide = sample.label.isBackSide;
+
+        bool skipped = false;
+        CascadeResult result = session.processFrame(frame, isBackSide, &skipped);
+        if (!skipped) {
+            totalMs.push_back(result.totalMs);
+            for (int s = 0; s < CASCADE_STAGE_COUNT; ++s) {
+                if (result.stageMs[s] > 0.0f) stageMs[s].push_back(result.stageMs[s]);
+            }
+        }
+        if (result.passed) {
+            passed++;
+            if (isBackSide) {
+                session.bestROI(ROIType::MRZ);
+                session.fuseMRZ();
+            } else {
+                session.bestROI(ROIType::TCKN);
+                session.bestROI(ROIType::SURNAME);
+            }
+        }
+        if (ocrEvery > 0 && i % ocrEvery == 0) {
+            session.processForOCR(frame);
+        }
+
+        if ((i + 1) % window == 0 || i + 1 == frames) {
+            Window w;
+            w.endFrame = i + 1;
+            w.seconds = chrono::duration<double>(Clock::now() - start).count();
+            w.memory = sampleMemory();
+            w.total = summarize(totalMs);
+            for (int s = 0; s < CASCADE_STAGE_COUNT; ++s) w.stages[s] = summarize(stageMs[s]);
+            w.passed = passed;
+            windows.push_back(w);
+
+            fprintf(stderr, "%9zu  %7.1fs  rss %7.1f MB  in-use %7.1f MB  free %6.1f MB  frag %.2f  "
+                    "p50 %6.2f ms  p95 %6.2f ms  passed %zu\n",
+                    w.endFrame, w.seconds, mb(w.memory.rssBytes), mb(w.memory.inUseBytes),
+                    mb(w.memory.freeBytes), w.memory.fragmentation(), w.total.p50Ms, w.total.p95Ms, w.passed);
+            if (csv != nullptr) writeCsvRow(csv, w);
+
+            totalMs.clear();
+            for (vector<double>& v : stageMs) v.clear();
+            passed = 0;
+        }
+    }
+    if (csv != nullptr) fclose(csv);
+
+    // Trend over the windows after warmup
+    vector<Window> measured;
+    for (const Window& w : windows) {
+        if (w.endFrame > warmup) measured.push_back(w);
+    }
+    if (measured.size() < 2) {
+        fprintf(stderr, "idverify-soak: fewer than two windows after warmup, no verdict\n");
+        return 2;
+    }
+
+    const MemorySample& mem = measured.front().memory;
+    const double rssGrowth = trendGrowth(measured, [](const Window& w) { return mb(w.memory.rssBytes); });
+    const double heapGrowth = trendGrowth(measured, [](const Window& w) { return mb(w.memory.inUseBytes); });
+    double peakFragmentation = 0.0;
+    for (const Window& w : measured) peakFragmentation = std::max(peakFragmentation, w.memory.fragmentation());
+    const double baseP50 = measured.front().total.p50Ms;
+    const double latencyGrowth = trendGrowth(measured, [](const Window& w) { return w.total.p50Ms; });
+    const double latencyDrift = baseP50 > 0.0 ? latencyGrowth / baseP50 : 0.0;
+
+    printf("frames            %zu (%zu measured after warmup)\n", frames,
+           measured.back().endFrame - measured.front().endFrame);
+    printf("rss growth        %+.2f MB (limit %.1f)%s\n", rssGrowth, limits.rssGrowthMB,
+           mem.hasRss ? "" : " [unavailable]");
+    printf("heap growth       %+.2f MB (limit %.1f)%s\n", heapGrowth, limits.heapGrowthMB,
+           mem.hasAllocator ? "" : " [unavailable]");
+    printf("fragmentation     %.3f peak (limit %.2f)\n", peakFragmentation, limits.fragmentation);
+    printf("p50 latency drift %+.1f%% from %.2f ms (limit %.0f%%)\n", 100.0 * latencyDrift, baseP50,
+           100.0 * limits.latencyDrift);
+    printf("\n%-10s %10s %10s %10s %10s\n", "stage", "p50 first", "p50 last", "p95 first", "p95 last");
+    for (int s = 0; s < CASCADE_STAGE_COUNT; ++s) {
+        printf("%-10s %10.3f %10.3f %10.3f %10.3f\n", STAGE_NAMES[s],
+               measured.front().stages[s].p50Ms, measured.back().stages[s].p50Ms,
+               measured.front().stages[s].p95Ms, measured.back().stages[s].p95Ms);
+    }
+
+    bool failed = false;
+    if (mem.hasRss && rssGrowth > limits.rssGrowthMB) {
+        fprintf(stderr, "FAIL: RSS grew %.2f MB\n", rssGrowth);
+        failed = true;
+    }
+    if (mem.hasAllocator && heapGrowth > limits.heapGrowthMB) {
+        fprintf(stderr, "FAIL: malloc in-use grew %.2f MB\n", heapGrowth);
+        failed = true;
+    }
+    if (mem.hasAllocator && peakFragmentation > limits.fragmentation) {
+        fprintf(stderr, "FAIL: arena fragmentation reached %.3f\n", peakFragmentation);
+        failed = true;
+    }
+    if (latencyDrift > limits.latencyDrift) {
+        fprintf(stderr, "FAIL: p50 latency drifted %+.1f%%\n", 100.0 * latencyDrift);
+        failed = true;
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,190 @@
+/**
+ * stage_perf - Hardware counters per VisionProcessor stage (Linux host)
+ *
+ * Runs each stage on DeviceCalibrator synthetic frames at several camera
+ * resolutions and reports, per call: wall time, IPC, and L1D / LLC /
+ * branch misses per pixel. High misses-per-pixel with low IPC points at a
+ * memory-bound stage; high IPC with flat misses at a compute-bound one.
+ *
+ *   stage_perf [--iterations N] [--threads N] [--csv]
+ *
+ * Counters follow the calling thread only, so OpenCV runs single-threaded
+ * unless --threads is given (misses in worker threads are then not counted).
+ */
+
+#include "PerfCounters.h"
+#include "../DeviceProfile.h"
+#include "../GlareMap.h"
+#include "../QualityKernel.h"
+#include "../VisionProcessor.h"
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace cv;
+using namespace std;
+using namespace idverify;
+
+namespace {
+
+struct Resolution {
+    const char* name;
+    int width;
+    int height;
+};
+
+const Resolution RESOLUTIONS[] = {
+    { "640x360", 640, 360 },
+    { "1280x720", 1280, 720 },
+    { "1920x1080", 1920, 1080 }
+};
+
+struct Options {
+    int iterations = 20;
+    int threads = 1;
+    bool csv = false;
+};
+
+struct StageResult {
+    double ms;          // Mean wall time per call
+    PerfSample total;   // Counters summed over all calls
+};
+
+StageResult measure(PerfCounters& counters, int iterations, const function<void()>& stage) {
+    stage();    // Warm caches and OpenCV's lazy allocations
+
+    StageResult result;
+    result.ms = 0.0;
+    for (int i = 0; i < iterations; ++i) {
+        auto start = chrono::steady_clock::now();
+        counters.start();
+        stage();
+        result.total += counters.stop();
+        result.ms += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+    result.ms /= iterations;
+    return result;
+}
+
+double perPixel(const StageResult& r, PerfEvent e, int iterations, double pixels) {
+    if (!r.total.has(e)) return -1.0;
+    return static_cast<double>(r.total.get(e)) / iterations / pixels;
+}
+
+void printHeader(bool csv) {
+    if (csv) {
+        printf("resolution,stage,ms,ipc,l1d_miss_per_px,llc_miss_per_px,branch_miss_per_px\n");
+    } else {
+        printf("%-10s %-22s %9s %6s %12s %12s %12s\n",
+               "res", "stage", "ms", "IPC", "L1D/px", "LLC/px", "brmiss/px");
+    }
+}
+
+void printRow(bool csv, const char* resolution, const string& stage,
+              const StageResult& r, int iterations, double pixels) {
+    const double l1 = perPixel(r, PerfEvent::L1D_READ_MISSES, iterations, pixels);
+    const double llc = perPixel(r, PerfEvent::LLC_MISSES, iterations, pixels);
+    const double br = perPixel(r, PerfEvent::BRANCH_MISSES, iterations, pixels);
+    if (csv) {
+        printf("%s,%s,%.4f,%.3f,%.5f,%.5f,%.5f\n",
+               resolution, stage.c_str(), r.ms, r.total.ipc(), l1, llc, br);
+    } else {
+        printf("%-10s %-22s %9.3f %6.2f %12.5f %12.5f %12.5f\n",
+               resolution, stage.c_str(), r.ms, r.total.ipc(), l1, llc, br);
+    }
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            options.iterations = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--csv") == 0) {
+            options.csv = true;
+        } else {
+            fprintf(stderr, "usage: %s [--iterations N] [--threads N] [--csv]\n", argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 2;
+    }
+    setNumThreads(options.threads);
+
+    PerfCounters counters;
+    if (!counters.available()) {
+        fprintf(stderr, "perf_event_open unavailable (check /proc/sys/kernel/perf_event_paranoid); "
+                        "reporting wall time only\n");
+    }
+
+    // Back-side synthetic frame: carries both text blocks and an MRZ band
+    vector<Point> baseCorners;
+    const Mat base = DeviceCalibrator::syntheticFrame(1, baseCorners);
+    const double cardPixels = static_cast<double>(TARGET_WIDTH) * TARGET_HEIGHT;
+    const int n = options.iterations;
+
+    printHeader(options.csv);
+
+    for (const Resolution& res : RESOLUTIONS) {
+        Mat frame;
+        resize(base, frame, Size(res.width, res.height), 0, 0, INTER_AREA);
+        const float sx = static_cast<float>(res.width) / base.cols;
+        const float sy = static_cast<float>(res.height) / base.rows;
+        vector<Point> corners;
+        for (const Point& p : baseCorners) {
+            corners.push_back(Point(cvRound(p.x * sx), cvRound(p.y * sy)));
+        }
+        const double framePixels = static_cast<double>(res.width) * res.height;
+
+        // Frame-sized stages (per input pixel)
+        for (int level = 0; level <= 2; ++level) {
+            StageResult r = measure(counters, n, [&] { VisionProcessor::findCardCorners(frame, level); });
+            printRow(options.csv, res.name, "findCardCorners/L" + to_string(level), r, n, framePixels);
+        }
+        printRow(options.csv, res.name, "calculateBlurScore",
+                 measure(counters, n, [&] { VisionProcessor::calculateBlurScore(frame); }), n, framePixels);
+        printRow(options.csv, res.name, "detectGlare",
+                 measure(counters, n, [&] { VisionProcessor::detectGlare(frame); }), n, framePixels);
+        printRow(options.csv, res.name, "QualityKernel",
+                 measure(counters, n, [&] { QualityKernel::analyze(frame); }), n, framePixels);
+
+        // Warp (per output pixel: the gather is driven by the card raster)
+        printRow(options.csv, res.name, "warpToID1/linear",
+                 measure(counters, n, [&] { VisionProcessor::warpToID1(frame, corners, INTER_LINEAR); }),
+                 n, cardPixels);
+        printRow(options.csv, res.name, "warpToID1/cubic",
+                 measure(counters, n, [&] { VisionProcessor::warpToID1(frame, corners, INTER_CUBIC); }),
+                 n, cardPixels);
+
+        // Card-sized stages (per card pixel)
+        const Mat warped = VisionProcessor::warpToID1(frame, corners, INTER_CUBIC);
+        const char* tierNames[] = { "nlm", "gaussian", "none" };
+        for (int tier = 0; tier < 3; ++tier) {
+            const DenoiseTier d = static_cast<DenoiseTier>(tier);
+            // NLM dominates run time; a few calls are enough to read its counters
+            const int calls = (d == DenoiseTier::NLM) ? std::max(1, n / 5) : n;
+            StageResult r = measure(counters, calls, [&] { VisionProcessor::binarizeForOCR(warped, d); });
+            printRow(options.csv, res.name, string("binarizeForOCR/") + tierNames[tier], r, calls, cardPixels);
+        }
+        printRow(options.csv, res.name, "extractMRZRegion",
+                 measure(counters, n, [&] { VisionProcessor::extractMRZRegion(warped, DenoiseTier::GAUSSIAN); }),
+                 n, cardPixels);
+        printRow(options.csv, res.name, "GlareMap",
+                 measure(counters, n, [&] { GlareMap::compute(warped, true); }), n, cardPixels);
+    }
+    return 0;
+}
@@ -0,0 +1,343 @@
+/**
+ * vision_bench - Google Benchmark suite for the vision core (Linux host)
+ *
+ * Every public VisionProcessor stage at 360p / 720p / 1080p camera
+ * resolution, plus MRZ parsing/validation and a hold-still session sequence for
+ * the frame-hash memo. Inputs are DeviceCalibrator synthetic frames
+ * (seeded, identical every run), OpenCV runs single-threaded and metrics
+ * and tracing are off, so numbers are comparable between runs and
+ * machines with the same CPU. items_per_second is input pixels per second.
+ *
+ *   vision_bench --benchmark_repetitions=5 --benchmark_report_aggregates_only=true
+ *
+ * IDVERIFY_BENCH_THREADS=N lets OpenCV use N threads instead.
+ */
+
+#include "../DeviceProfile.h"
+#include "../FrameHash.h"
+#include "../Metrics.h"
+#include "../MRZConsensus.h"
+#include "../MRZReader.h"
+#include "../MRZLocator.h"
+#include "../MRZParser.h"
+#include "../ScanSession.h"
+#include "../Trace.h"
+#include "../VisionProcessor.h"
+#include <benchmark/benchmark.h>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace cv;
+using namespace std;
+using namespace idverify;
+
+namespace {
+
+struct Resolution {
+    const char* name;
+    int width;
+    int height;
+};
+
+const Resolution RESOLUTIONS[] = {
+    { "640x360", 640, 360 },
+    { "1280x720", 1280, 720 },
+    { "1920x1080", 1920, 1080 }
+};
+
+constexpr int RESOLUTION_COUNT = 3;
+
+/**
+ * Synthetic camera frame at one resolution, with its warped card
+ */
+struct Fixture {
+    Mat frame;                  // BGR camera frame
+    Mat moved;                  // Same frame shifted by (2, 1) px
+    vector<Point> corners;      // Ground-truth card corners
+    Mat warped;                 // 856x540 cubic warp
+};
+
+const Fixture& fixture(int resolution, bool isBackSide) {
+    static Fixture cache[RESOLUTION_COUNT][2];
+    Fixture& f = cache[resolution][isBackSide ? 1 : 0];
+    if (!f.frame.empty()) {
+        return f;
+    }
+
+    const Resolution& res = RESOLUTIONS[resolution];
+    vector<Point> baseCorners;
+    Mat base = DeviceCalibrator::syntheticFrame(isBackSide ? 1 : 0, baseCorners);
+    resize(base, f.frame, Size(res.width, res.height), 0, 0, INTER_AREA);
+
+    const float sx = static_cast<float>(res.width) / base.cols;
+    const float sy = static_cast<float>(res.height) / base.rows;
+    for (const Point& p : baseCorners) {
+        f.corners.push_back(Point(cvRound(p.x * sx), cvRound(p.y * sy)));
+    }
+
+    Mat shift = (Mat_<double>(2, 3) << 1, 0, 2, 0, 1, 1);
+    warpAffine(f.frame, f.moved, shift, f.frame.size(), INTER_LINEAR, BORDER_REPLICATE);
+    f.warped = VisionProcessor::warpToID1(f.frame, f.corners, INTER_CUBIC);
+    return f;
+}
+
+void setPixels(benchmark::State& state, const Mat& input) {
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(input.total()));
+}
+
+// TD1 MRZ with valid check digits, and the same lines with typical OCR confusions
+const char* MRZ_LINES[2][3] = {
+    { "I<TURA12C345672<10000000146<<<", "9001158M3106202TUR<<<<<<<<<<<8", "YILMAZ<<AHMET<<<<<<<<<<<<<<<<<" },
+    { "I<TURA1ZC345672<1OOOOOOO146<<<", "9OO1158M31O62O2TUR<<<<<<<<<<<8", "YILMAZ<<AHMET<<<<<<<<<<<<<<<<<" }
+};
+
+}
+
+// ==================== Frame Stages ====================
+
+// Args: resolution, pyramid level
+static void BM_FindCardCorners(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), false);
+    const int level = static_cast<int>(state.range(1));
+    bool detected = false;
+    for (auto _ : state) {
+        CornerResult r = VisionProcessor::findCardCorners(f.frame, level);
+        detected = r.detected;
+        benchmark::DoNotOptimize(r);
+    }
+    setPixels(state, f.frame);
+    state.counters["detected"] = detected ? 1 : 0;
+    state.SetLabel(RESOLUTIONS[state.range(0)].name);
+}
+BENCHMARK(BM_FindCardCorners)->ArgsProduct({ { 0, 1, 2 }, { 0, 1, 2 } })->Unit(benchmark::kMillisecond);
+
+// Args: resolution, interpolation (INTER_LINEAR / INTER_CUBIC)
+static void BM_WarpToID1(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), false);
+    const int interpolation = static_cast<int>(state.range(1));
+    for (auto _ : state) {
+        Mat warped = VisionProcessor::warpToID1(f.frame, f.corners, interpolation);
+        benchmark::DoNotOptimize(warped.data);
+    }
+    setPixels(state, f.frame);
+    state.SetLabel(RESOLUTIONS[state.range(0)].name);
+}
+BENCHMARK(BM_WarpToID1)
+    ->ArgsProduct({ { 0, 1, 2 }, { INTER_LINEAR, INTER_CUBIC } })
+    ->Unit(benchmark::kMillisecond);
+
+// Args: resolution
+static void BM_DetectGlare(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), false);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(VisionProcessor::detectGlare(f.frame));
+    }
+    setPixels(state, f.frame);
+    state.SetLabel(RESOLUTIONS[state.range(0)].name);
+}
+BENCHMARK(BM_DetectGlare)->DenseRange(0, 2)->Unit(benchmark::kMillisecond);
+
+// Args: resolution
+static void BM_CalculateBlurScore(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), false);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(VisionProcessor::calculateBlurScore(f.frame));
+    }
+    setPixels(state, f.frame);
+    state.SetLabel(RESOLUTIONS[state.range(0)].name);
+}
+BENCHMARK(BM_CalculateBlurScore)->DenseRange(0, 2)->Unit(benchmark::kMillisecond);
+
+// Args: resolution
+static void BM_CalculateStability(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), false);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(VisionProcessor::calculateStability(f.moved, f.frame));
+    }
+    setPixels(state, f.frame);
+    state.SetLabel(RESOLUTIONS[state.range(0)].name);
+}
+BENCHMARK(BM_CalculateStability)->DenseRange(0, 2)->Unit(benchmark::kMillisecond);
+
+// ==================== Card Stages ====================
+
+// Args: resolution (of the frame the card was warped from), DenoiseTier
+static void BM_BinarizeForOCR(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), true);
+    const DenoiseTier denoise = static_cast<DenoiseTier>(state.range(1));
+    for (auto _ : state) {
+        Mat binary = VisionProcessor::binarizeForOCR(f.warped, denoise);
+        benchmark::DoNotOptimize(binary.data);
+    }
+    setPixels(state, f.warped);
+    state.SetLabel(RESOLUTIONS[state.range(0)].name);
+}
+BENCHMARK(BM_BinarizeForOCR)->ArgsProduct({ { 0, 1, 2 }, { 0, 1, 2 } })->Unit(benchmark::kMillisecond);
+
+// Args: resolution, ROIType (front or back card picked by field)
+static void BM_ExtractROI(benchmark::State& state) {
+    const ROIType type = static_cast<ROIType>(state.range(1));
+    const bool isBackSide = isBackSideROI(type);
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), isBackSide);
+    int64_t pixels = 0;
+    for (auto _ : state) {
+        Mat roi = VisionProcessor::extractROI(f.warped, type, isBackSide);
+        pixels = static_cast<int64_t>(roi.total());
+        benchmark::DoNotOptimize(roi.data);
+    }
+    state.SetItemsProcessed(state.iterations() * pixels);
+    state.SetLabel(RESOLUTIONS[state.range(0)].name);
+}
+BENCHMARK(BM_ExtractROI)
+    ->ArgsProduct({ { 0, 1, 2 }, benchmark::CreateDenseRange(0, ROI_TYPE_COUNT - 1, 1) })
+    ->Unit(benchmark::kMicrosecond);
+
+// ==================== MRZ Reader ====================
+
+static void BM_ReadMRZ(benchmark::State& state) {
+    const Fixture& f = fixture(static_cast<int>(state.range(0)), true);
+    static const MRZReader reader;
+    bool found = false;
+    for (auto _ : state) {
+        MRZReadResult r = reader.read(f.warped);
+        found = r.found;
+        benchmark::DoNotOptimize(r);
+    }
+    state.counters["found"] = found ? 1 : 0;
+    state.SetLabel(RESOLUTIONS[state.range(0)].name);
+}
+BENCHMARK(BM_ReadMRZ)->DenseRange(0, 2)->Unit(benchmark::kMicrosecond);
+
+// Args: 0 = level band, 1 = band tilted 2 degrees (residual warp error)
+static void BM_LocateMRZLines(benchmark::State& state) {
+    const Fixture& f = fixture(1, true);
+    Mat band = VisionProcessor::cropROI(f.warped, BackROI::MRZ).clone();
+    if (state.range(0) == 1) {
+        Mat tilt = getRotationMatrix2D(Point2f(band.cols * 0.5f, band.rows * 0.5f), -2.0, 1.0);
+        warpAffine(band, band, tilt, band.size(), INTER_LINEAR, BORDER_REPLICATE);
+    }
+    MRZLineLayout layout;
+    for (auto _ : state) {
+        layout = MRZLocator::locate(band);
+        benchmark::DoNotOptimize(layout);
+    }
+    state.counters["found"] = layout.found ? 1 : 0;
+    state.counters["skew"] = layout.skewDegrees;
+}
+BENCHMARK(BM_LocateMRZLines)->DenseRange(0, 1)->Unit(benchmark::kMicrosecond);
+
+// ==================== Validation ====================
+
+// Args: 0 = clean MRZ, 1 = MRZ with OCR confusions (O/0, Z/2)
+static void BM_ValidateWithScore(benchmark::State& state) {
+    const char* const* lines = MRZ_LINES[state.range(0)];
+    const string line1(lines[0]), line2(lines[1]), line3(lines[2]);
+    int score = 0;
+    for (auto _ : state) {
+        ValidationScore s = MRZValidator::validateWithScore(line1, line2, line3);
+        score = s.totalScore;
+        benchmark::DoNotOptimize(s);
+    }
+    state.counters["score"] = score;
+}
+BENCHMARK(BM_ValidateWithScore)->DenseRange(0, 1);
+
+// Args: as above. Field split and check digits only (no decoding, no allocation)
+static void BM_ParseMRZ(benchmark::State& state) {
+    const char* const* lines = MRZ_LINES[state.range(0)];
+    const string_view line1(lines[0]), line2(lines[1]), line3(lines[2]);
+    int score = 0;
+    for (auto _ : state) {
+        MRZFields f = MRZParser::parse(line1, line2, line3);
+        score = f.score;
+        benchmark::DoNotOptimize(f);
+    }
+    state.counters["score"] = score;
+}
+BENCHMARK(BM_ParseMRZ)->DenseRange(0, 1)->Unit(benchmark::kNanosecond);
+
+// Args: as above. One iteration = reset, then votes of the same read until accepted
+static void BM_ConsensusMRZ(benchmark::State& state) {
+    const char* const* lines = MRZ_LINES[state.range(0)];
+    const string line1(lines[0]), line2(lines[1]), line3(lines[2]);
+    MRZConsensus consensus;
+    int frames = 0;
+    for (auto _ : state) {
+        consensus.reset();
+        for (int i = 0; i < 10 && !consensus.result().accepted; ++i) {
+            consensus.add(line1, line2, line3, 0.8f);
+        }
+        frames = consensus.result().frames;
+        benchmark::DoNotOptimize(consensus.result());
+    }
+    state.counters["frames"] = frames;
+    state.counters["stability"] = consensus.result().stability;
+}
+BENCHMARK(BM_ConsensusMRZ)->DenseRange(0, 1)->Unit(benchmark::kMicrosecond);
+
+// ==================== Hold-Still Sequence ====================
+
+// Args: frame-hash memo off / on. One iteration = 30 frames of a card held
+// still at 720p (sensor noise plus sub-pixel hand tremor).
+static void BM_HoldStillSession(benchmark::State& state) {
+    static vector<Mat> sequence;
+    if (sequence.empty()) {
+        const Fixture& f = fixture(1, true);
+        RNG rng(0x401D);
+        for (int i = 0; i < 30; ++i) {
+            Mat noise(f.frame.size(), CV_16SC3), frame;
+            rng.fill(noise, RNG::NORMAL, Scalar::all(0), Scalar::all(2));
+            Mat shift = (Mat_<double>(2, 3) << 1, 0, rng.uniform(-0.5, 0.5), 0, 1, rng.uniform(-0.5, 0.5));
+            warpAffine(f.frame, frame, shift, f.frame.size(), INTER_LINEAR, BORDER_REPLICATE);
+            add(frame, noise, frame, noArray(), CV_8UC3);
+            sequence.push_back(frame);
+        }
+    }
+
+    SessionConfig config;
+    config.memoMaxDistance = state.range(0) ? 4 : -1;
+    config.governor.maxLevel = 0;   // Keep level-0 settings so runs compare like for like
+    float hitRate = 0.0f;
+    for (auto _ : state) {
+        ScanSession session(config);
+        for (const Mat& frame : sequence) {
+            ProcessedFrame r = session.processForOCR(frame);
+            benchmark::DoNotOptimize(r);
+        }
+        hitRate = session.ocrMemoStats().hitRate();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(sequence.size()));
+    state.counters["hitRate"] = hitRate;
+}
+BENCHMARK(BM_HoldStillSession)->DenseRange(0, 1)->Unit(benchmark::kMillisecond);
+
+// Args: none. Hash cost alone (paid on every frame, hit or miss)
+static void BM_FrameHash(benchmark::State& state) {
+    const Fixture& f = fixture(1, true);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(FrameHash::compute(f.frame));
+    }
+    setPixels(state, f.frame);
+}
+BENCHMARK(BM_FrameHash)->Unit(benchmark::kMicrosecond);
+
+int main(int argc, char** argv) {
+    const char* threads = getenv("IDVERIFY_BENCH_THREADS");
+    setNumThreads(threads != nullptr ? atoi(threads) : 1);
+    Metrics::instance().setEnabled(false);
+    Trace::setEnabled(false);
+
+    benchmark::AddCustomContext("opencv", CV_VERSION);
+    benchmark::AddCustomContext("opencv_threads", to_string(getNumThreads()));
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
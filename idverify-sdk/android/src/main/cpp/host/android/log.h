@@ -0,0 +1,45 @@
+#ifndef IDVERIFY_HOST_ANDROID_LOG_H
+#define IDVERIFY_HOST_ANDROID_LOG_H
+
+/**
+ * Host shim for <android/log.h>
+ *
+ * Only on the include path of the Linux host build. Messages at or above
+ * IDVERIFY_HOST_LOG_LEVEL (default: warnings) go to stderr so benchmarks
+ * are not dominated by debug logging.
+ */
+
+#include <cstdarg>
+#include <cstdio>
+
+typedef enum android_LogPriority {
+    ANDROID_LOG_UNKNOWN = 0,
+    ANDROID_LOG_DEFAULT,
+    ANDROID_LOG_VERBOSE,
+    ANDROID_LOG_DEBUG,
+    ANDROID_LOG_INFO,
+    ANDROID_LOG_WARN,
+    ANDROID_LOG_ERROR,
+    ANDROID_LOG_FATAL,
+    ANDROID_LOG_SILENT
+} android_LogPriority;
+
+#ifndef IDVERIFY_HOST_LOG_LEVEL
+#define IDVERIFY_HOST_LOG_LEVEL ANDROID_LOG_WARN
+#endif
+
+inline int __android_log_print(int prio, const char* tag, const char* fmt, ...) {
+    if (prio < IDVERIFY_HOST_LOG_LEVEL) {
+        return 0;
+    }
+    static const char LEVELS[] = "??VDIWEFS";
+    fprintf(stderr, "%c/%s: ", LEVELS[prio & 7], tag);
+    va_list args;
+    va_start(args, fmt);
+    int n = vfprintf(stderr, fmt, args);
+    va_end(args);
+    fputc('\n', stderr);
+    return n;
+}
+
+#endif // IDVERIFY_HOST_ANDROID_LOG_H
@@ -1,10 +1,26 @@
 #include <jni.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <android/bitmap.h>
 #include <android/log.h>
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
 #include "VisionProcessor.h"
+#include "ScanSession.h"
+#include "DeviceProfile.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include "GlareMap.h"
+#include "QualityKernel.h"
+#include "MRZReader.h"
+#include "MRZDecoder.h"
+#include "MRZLocator.h"
+#include "MRZParser.h"
 
 #define TAG "NativeLib"
 #define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, TAG, __VA_ARGS__)
@@ -14,6 +30,7 @@
 
 // Convert Android Bitmap to OpenCV Mat
 cv::Mat bitmapToMat(JNIEnv *env, jobject bitmap) {
+    idverify::StageTimer timer(idverify::MetricStage::INGEST);
     AndroidBitmapInfo info;
     void *pixels = 0;
 
@@ -40,53 +57,300 @@ cv::Mat bitmapToMat(JNIEnv *env, jobject bitmap) {
     return result;
 }
 
-// Convert OpenCV Mat to Android Bitmap
-jobject matToBitmap(JNIEnv *env, cv::Mat &src) {
-    if (src.empty()) {
-        LOGE("matToBitmap: Empty source Mat");
-        return nullptr;
+// Convert Android Bitmap straight into a BGR Mat while pixels are locked.
+// Skips the intermediate RGBA clone; dst is reused when its size already matches.
+bool bitmapToBGR(JNIEnv *env, jobject bitmap, cv::Mat &dst) {
+    idverify::StageTimer timer(idverify::MetricStage::INGEST);
+    AndroidBitmapInfo info;
+    void *pixels = 0;
+
+    if (AndroidBitmap_getInfo(env, bitmap, &info) < 0) {
+        LOGE("bitmapToBGR: Failed to get bitmap info");
+        return false;
+    }
+    
+    if (info.format != ANDROID_BITMAP_FORMAT_RGBA_8888) {
+        LOGE("bitmapToBGR: Unsupported format %d", info.format);
+        return false;
+    }
+    
+    if (AndroidBitmap_lockPixels(env, bitmap, &pixels) < 0) {
+        LOGE("bitmapToBGR: Failed to lock pixels");
+        return false;
+    }
+    
+    cv::Mat src(info.height, info.width, CV_8UC4, pixels, info.stride);
+    cv::cvtColor(src, dst, cv::COLOR_RGBA2BGR);
+    
+    AndroidBitmap_unlockPixels(env, bitmap);
+    return true;
+}
+
+// Convert Android Bitmap straight into a luma Mat while pixels are locked
+bool bitmapToGray(JNIEnv *env, jobject bitmap, cv::Mat &dst) {
+    idverify::StageTimer timer(idverify::MetricStage::INGEST);
+    AndroidBitmapInfo info;
+    void *pixels = 0;
+
+    if (AndroidBitmap_getInfo(env, bitmap, &info) < 0) {
+        LOGE("bitmapToGray: Failed to get bitmap info");
+        return false;
+    }
+    
+    if (info.format != ANDROID_BITMAP_FORMAT_RGBA_8888) {
+        LOGE("bitmapToGray: Unsupported format %d", info.format);
+        return false;
+    }
+    
+    if (AndroidBitmap_lockPixels(env, bitmap, &pixels) < 0) {
+        LOGE("bitmapToGray: Failed to lock pixels");
+        return false;
+    }
+    
+    cv::Mat src(info.height, info.width, CV_8UC4, pixels, info.stride);
+    cv::cvtColor(src, dst, cv::COLOR_RGBA2GRAY);
+    
+    AndroidBitmap_unlockPixels(env, bitmap);
+    return true;
+}
+
+// Locks Bitmap pixels for the lifetime of the object and exposes them as an
+// RGBA Mat view, for consumers that downscale before touching every pixel
+class LockedBitmap {
+public:
+    LockedBitmap(JNIEnv *env, jobject bitmap) : env_(env), bitmap_(bitmap) {
+        AndroidBitmapInfo info;
+        void *pixels = 0;
+        if (AndroidBitmap_getInfo(env, bitmap, &info) < 0 ||
+            info.format != ANDROID_BITMAP_FORMAT_RGBA_8888 ||
+            AndroidBitmap_lockPixels(env, bitmap, &pixels) < 0) {
+            LOGE("LockedBitmap: Failed to lock RGBA_8888 bitmap");
+            return;
+        }
+        rgba = cv::Mat(info.height, info.width, CV_8UC4, pixels, info.stride);
+    }
+    
+    ~LockedBitmap() {
+        if (!rgba.empty()) AndroidBitmap_unlockPixels(env_, bitmap_);
     }
     
-    jclass bitmapConfig = env->FindClass("android/graphics/Bitmap$Config");
-    jfieldID argb8888Field = env->GetStaticFieldID(bitmapConfig, "ARGB_8888", "Landroid/graphics/Bitmap$Config;");
-    jobject argb8888 = env->GetStaticObjectField(bitmapConfig, argb8888Field);
+    LockedBitmap(const LockedBitmap&) = delete;
+    LockedBitmap& operator=(const LockedBitmap&) = delete;
+    
+    cv::Mat rgba;  // Empty if locking failed
+    
+private:
+    JNIEnv *env_;
+    jobject bitmap_;
+};
+
+// Per-thread input buffers reused by the native entry points (analysis runs on one thread)
+static thread_local cv::Mat tInputBGR;
+static thread_local cv::Mat tInputGray;
+
+// ==================== JNI Class Cache ====================
+
+// Class/method IDs resolved once in JNI_OnLoad instead of on every result
+struct BitmapJNICache {
+    jclass bitmapClass = nullptr;        // Global ref to android.graphics.Bitmap
+    jmethodID createBitmap = nullptr;    // Bitmap.createBitmap(int, int, Config)
+    jobject configARGB8888 = nullptr;    // Global ref to Bitmap.Config.ARGB_8888
+    jobject configAlpha8 = nullptr;      // Global ref to Bitmap.Config.ALPHA_8
+    jclass stringClass = nullptr;        // Global ref to java.lang.String (MRZ line arrays)
+};
+
+static BitmapJNICache gBitmapCache;
+
+static jobject getBitmapConfig(JNIEnv *env, jclass configClass, const char *name) {
+    jfieldID field = env->GetStaticFieldID(configClass, name, "Landroid/graphics/Bitmap$Config;");
+    if (field == nullptr) return nullptr;
+    jobject local = env->GetStaticObjectField(configClass, field);
+    jobject global = env->NewGlobalRef(local);
+    env->DeleteLocalRef(local);
+    return global;
+}
+
+extern "C" JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM *vm, void * /* reserved */) {
+    JNIEnv *env = nullptr;
+    if (vm->GetEnv(reinterpret_cast<void **>(&env), JNI_VERSION_1_6) != JNI_OK) {
+        return JNI_ERR;
+    }
     
     jclass bitmapClass = env->FindClass("android/graphics/Bitmap");
-    jmethodID createBitmapMethod = env->GetStaticMethodID(bitmapClass, "createBitmap", "(IILandroid/graphics/Bitmap$Config;)Landroid/graphics/Bitmap;");
+    jclass configClass = env->FindClass("android/graphics/Bitmap$Config");
+    jclass stringClass = env->FindClass("java/lang/String");
+    if (bitmapClass == nullptr || configClass == nullptr || stringClass == nullptr) {
+        LOGE("JNI_OnLoad: Bitmap or String class not found");
+        return JNI_ERR;
+    }
     
-    jobject newBitmap = env->CallStaticObjectMethod(bitmapClass, createBitmapMethod, src.cols, src.rows, argb8888);
+    gBitmapCache.bitmapClass = static_cast<jclass>(env->NewGlobalRef(bitmapClass));
+    gBitmapCache.createBitmap = env->GetStaticMethodID(
+            bitmapClass, "createBitmap", "(IILandroid/graphics/Bitmap$Config;)Landroid/graphics/Bitmap;");
+    gBitmapCache.configARGB8888 = getBitmapConfig(env, configClass, "ARGB_8888");
+    gBitmapCache.configAlpha8 = getBitmapConfig(env, configClass, "ALPHA_8");
+    gBitmapCache.stringClass = static_cast<jclass>(env->NewGlobalRef(stringClass));
     
-    if (newBitmap == nullptr) {
-        LOGE("matToBitmap: Failed to create bitmap");
-        return nullptr;
+    env->DeleteLocalRef(bitmapClass);
+    env->DeleteLocalRef(configClass);
+    env->DeleteLocalRef(stringClass);
+    
+    if (gBitmapCache.createBitmap == nullptr || gBitmapCache.configARGB8888 == nullptr) {
+        LOGE("JNI_OnLoad: Failed to resolve Bitmap factory");
+        return JNI_ERR;
+    }
+    
+    return JNI_VERSION_1_6;
+}
+
+// ==================== Output Helpers ====================
+
+// Output pixel formats for caller-provided ByteBuffers
+enum class BufferFormat : int {
+    GRAY8 = 0,  // 1 byte per pixel, tightly packed rows
+    RGBA = 1    // 4 bytes per pixel, tightly packed rows
+};
+
+// Convert Mat of any supported type into a preallocated view without reallocating it.
+// dst must already have the target size and type (CV_8UC1 or CV_8UC4).
+static bool convertInto(const cv::Mat &src, cv::Mat &dst) {
+    if (src.rows != dst.rows || src.cols != dst.cols) {
+        LOGE("convertInto: Size mismatch src=%dx%d dst=%dx%d", src.cols, src.rows, dst.cols, dst.rows);
+        return false;
+    }
+    
+    if (dst.type() == CV_8UC4) {
+        if (src.type() == CV_8UC1) {
+            cv::cvtColor(src, dst, cv::COLOR_GRAY2RGBA);
+        } else if (src.type() == CV_8UC3) {
+            cv::cvtColor(src, dst, cv::COLOR_BGR2RGBA);
+        } else if (src.type() == CV_8UC4) {
+            src.copyTo(dst);
+        } else {
+            LOGE("convertInto: Unsupported Mat type %d", src.type());
+            return false;
+        }
+    } else if (dst.type() == CV_8UC1) {
+        if (src.type() == CV_8UC1) {
+            src.copyTo(dst);
+        } else if (src.type() == CV_8UC3) {
+            cv::cvtColor(src, dst, cv::COLOR_BGR2GRAY);
+        } else if (src.type() == CV_8UC4) {
+            cv::cvtColor(src, dst, cv::COLOR_RGBA2GRAY);
+        } else {
+            LOGE("convertInto: Unsupported Mat type %d", src.type());
+            return false;
+        }
+    } else {
+        return false;
+    }
+    
+    return true;
+}
+
+// Write Mat into an existing RGBA_8888 or ALPHA_8 Bitmap (no Java allocation).
+// Bitmap dimensions must match the Mat; callers keep and reuse the Bitmap across frames.
+bool writeMatToBitmap(JNIEnv *env, const cv::Mat &src, jobject bitmap) {
+    if (src.empty() || bitmap == nullptr) {
+        LOGE("writeMatToBitmap: Empty source or null bitmap");
+        return false;
     }
     
     AndroidBitmapInfo info;
     void *pixels = 0;
     
-    if (AndroidBitmap_getInfo(env, newBitmap, &info) < 0) {
-        LOGE("matToBitmap: Failed to get new bitmap info");
-        return nullptr;
+    if (AndroidBitmap_getInfo(env, bitmap, &info) < 0) {
+        LOGE("writeMatToBitmap: Failed to get bitmap info");
+        return false;
+    }
+    
+    int dstType;
+    if (info.format == ANDROID_BITMAP_FORMAT_RGBA_8888) {
+        dstType = CV_8UC4;
+    } else if (info.format == ANDROID_BITMAP_FORMAT_A_8) {
+        dstType = CV_8UC1;
+    } else {
+        LOGE("writeMatToBitmap: Unsupported format %d", info.format);
+        return false;
+    }
+    
+    if (AndroidBitmap_lockPixels(env, bitmap, &pixels) < 0) {
+        LOGE("writeMatToBitmap: Failed to lock pixels");
+        return false;
+    }
+    
+    cv::Mat dst(info.height, info.width, dstType, pixels, info.stride);
+    bool ok = convertInto(src, dst);
+    
+    AndroidBitmap_unlockPixels(env, bitmap);
+    return ok;
+}
+
+static bool isBufferFormat(jint format) {
+    return format == static_cast<jint>(BufferFormat::GRAY8) ||
+           format == static_cast<jint>(BufferFormat::RGBA);
+}
+
+// Write Mat into a direct ByteBuffer as tightly packed GRAY8 or RGBA rows.
+// @return Bytes written, or -1 if the format is unknown or the buffer is not direct or too small
+jint writeMatToBuffer(JNIEnv *env, const cv::Mat &src, jobject buffer, BufferFormat format) {
+    if (!isBufferFormat(static_cast<jint>(format))) {
+        LOGE("writeMatToBuffer: Unknown format %d", static_cast<int>(format));
+        return -1;
+    }
+    if (src.empty() || buffer == nullptr) {
+        LOGE("writeMatToBuffer: Empty source or null buffer");
+        return -1;
     }
     
-    if (AndroidBitmap_lockPixels(env, newBitmap, &pixels) < 0) {
-        LOGE("matToBitmap: Failed to lock new bitmap pixels");
+    void *address = env->GetDirectBufferAddress(buffer);
+    jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if (address == nullptr || capacity < 0) {
+        LOGE("writeMatToBuffer: Buffer is not direct");
+        return -1;
+    }
+    
+    int dstType = (format == BufferFormat::GRAY8) ? CV_8UC1 : CV_8UC4;
+    jlong required = static_cast<jlong>(src.rows) * src.cols * CV_ELEM_SIZE(dstType);
+    if (capacity < required) {
+        LOGE("writeMatToBuffer: Buffer too small (%lld < %lld)",
+             static_cast<long long>(capacity), static_cast<long long>(required));
+        return -1;
+    }
+    
+    cv::Mat dst(src.rows, src.cols, dstType, address);
+    if (!convertInto(src, dst)) {
+        return -1;
+    }
+    
+    return static_cast<jint>(required);
+}
+
+// Convert OpenCV Mat to a new Android Bitmap
+// Single-channel Mats become ALPHA_8 when alpha8 is set, ARGB_8888 otherwise
+jobject matToBitmap(JNIEnv *env, cv::Mat &src, bool alpha8 = false) {
+    if (src.empty()) {
+        LOGE("matToBitmap: Empty source Mat");
         return nullptr;
     }
     
-    cv::Mat dst(info.height, info.width, CV_8UC4, pixels);
+    jobject config = (alpha8 && src.type() == CV_8UC1 && gBitmapCache.configAlpha8 != nullptr)
+                     ? gBitmapCache.configAlpha8
+                     : gBitmapCache.configARGB8888;
     
-    if (src.type() == CV_8UC1) {
-        cv::cvtColor(src, dst, cv::COLOR_GRAY2RGBA);
-    } else if (src.type() == CV_8UC3) {
-        cv::cvtColor(src, dst, cv::COLOR_BGR2RGBA);
-    } else if (src.type() == CV_8UC4) {
-        src.copyTo(dst);
-    } else {
-        LOGE("matToBitmap: Unsupported Mat type %d", src.type());
+    jobject newBitmap = env->CallStaticObjectMethod(
+            gBitmapCache.bitmapClass, gBitmapCache.createBitmap, src.cols, src.rows, config);
+    
+    if (newBitmap == nullptr) {
+        LOGE("matToBitmap: Failed to create bitmap");
+        return nullptr;
+    }
+    
+    if (!writeMatToBitmap(env, src, newBitmap)) {
+        env->DeleteLocalRef(newBitmap);
+        return nullptr;
     }
     
-    AndroidBitmap_unlockPixels(env, newBitmap);
     return newBitmap;
 }
 
@@ -113,6 +377,8 @@ Java_com_idverify_sdk_core_NativeProcessor_processImageForOCR(
         JNIEnv* env,
         jobject /* this */,
         jobject bitmap) {
+    idverify::Trace::beginFrame();
+    idverify::TraceSpan span("jni.processImageForOCR");
     
     try {
         cv::Mat src = bitmapToMat(env, bitmap);
@@ -156,6 +422,7 @@ Java_com_idverify_sdk_core_NativeProcessor_extractMRZRegion(
         JNIEnv* env,
         jobject /* this */,
         jobject bitmap) {
+    idverify::TraceSpan span("jni.extractMRZRegion");
     
     try {
         cv::Mat src = bitmapToMat(env, bitmap);
@@ -187,10 +454,27 @@ Java_com_idverify_sdk_core_NativeProcessor_extractMRZRegion(
     }
 }
 
+// Longest MRZ text read from Java; modified UTF-8 takes up to 3 bytes per UTF-16 unit
+constexpr jsize MRZ_TEXT_CHARS = 2 * idverify::MRZ_LINE_LENGTH;
+using MRZTextBuffer = std::array<char, 3 * MRZ_TEXT_CHARS + 1>;
+
+/**
+ * Copy a short Java string into a stack buffer (no pinned or heap copy)
+ * Text past MRZ_TEXT_CHARS is dropped
+ * @return View into buffer (empty for null)
+ */
+static std::string_view copyMRZText(JNIEnv* env, jstring str, MRZTextBuffer& buffer) {
+    buffer.fill('\0');
+    if (str == nullptr) return std::string_view();
+    const jsize length = std::min(env->GetStringLength(str), MRZ_TEXT_CHARS);
+    env->GetStringUTFRegion(str, 0, length, buffer.data());
+    return std::string_view(buffer.data(), strlen(buffer.data()));
+}
+
 /**
  * Validate MRZ with detailed scoring (0-60 points)
  * Each valid checksum = 15 points
- * Includes OCR error correction
+ * Includes OCR error correction (skipped when the lines already pass all four checks)
  * @return Total score 0-60
  */
 extern "C" JNIEXPORT jint JNICALL
@@ -200,21 +484,19 @@ Java_com_idverify_sdk_core_NativeProcessor_validateMRZWithScore(
         jstring line1,
         jstring line2,
         jstring line3) {
+    idverify::TraceSpan span("jni.validateMRZWithScore");
     
-    const char *l1 = env->GetStringUTFChars(line1, 0);
-    const char *l2 = env->GetStringUTFChars(line2, 0);
-    const char *l3 = env->GetStringUTFChars(line3, 0);
-    
-    idverify::ValidationScore score = idverify::MRZValidator::validateWithScore(l1, l2, l3);
+    MRZTextBuffer b1, b2, b3;
+    const std::string_view l1 = copyMRZText(env, line1, b1);
+    const std::string_view l2 = copyMRZText(env, line2, b2);
+    const std::string_view l3 = copyMRZText(env, line3, b3);
     
-    env->ReleaseStringUTFChars(line1, l1);
-    env->ReleaseStringUTFChars(line2, l2);
-    env->ReleaseStringUTFChars(line3, l3);
-    
-    LOGD("validateMRZWithScore: total=%d (doc=%d, dob=%d, exp=%d, comp=%d)",
-         score.totalScore, score.docNumScore, score.dobScore,
-         score.expiryScore, score.compositeScore);
+    // Clean reads score 60 without decoding
+    idverify::MRZFields fields = idverify::MRZParser::parse(l1, l2, l3);
+    if (fields.valid) return fields.score;
     
+    idverify::ValidationScore score = idverify::MRZValidator::validateWithScore(
+            std::string(l1), std::string(l2), std::string(l3));
     return score.totalScore;
 }
 
@@ -227,6 +509,7 @@ Java_com_idverify_sdk_core_NativeProcessor_detectGlare(
         JNIEnv* env,
         jobject /* this */,
         jobject bitmap) {
+    idverify::TraceSpan span("jni.detectGlare");
     
     try {
         cv::Mat src = bitmapToMat(env, bitmap);
@@ -248,6 +531,41 @@ Java_com_idverify_sdk_core_NativeProcessor_detectGlare(
     }
 }
 
+/**
+ * Per-ROI glare of a warped card (background and hologram excluded)
+ * @param bitmap Warped 856x540 card image
+ * @param isBackSide True for back-side layout
+ * @param outRoiGlare Optional float[8] filled with 0-1 glare per ROIType (-1 = not on this side)
+ * @return Worst text-ROI glare 0-100 (lower is better)
+ */
+extern "C" JNIEXPORT jint JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_detectCardGlare(
+        JNIEnv* env,
+        jobject /* this */,
+        jobject bitmap,
+        jboolean isBackSide,
+        jfloatArray outRoiGlare) {
+    idverify::TraceSpan span("jni.detectCardGlare");
+    
+    try {
+        if (!bitmapToBGR(env, bitmap, tInputBGR)) {
+            return 100; // Max glare on error
+        }
+        
+        idverify::GlareReport report = idverify::GlareMap::compute(tInputBGR, isBackSide);
+        if (!report.valid) return 100;
+        
+        if (outRoiGlare != nullptr && env->GetArrayLength(outRoiGlare) >= idverify::ROI_TYPE_COUNT) {
+            env->SetFloatArrayRegion(outRoiGlare, 0, idverify::ROI_TYPE_COUNT, report.roiGlare.data());
+        }
+        
+        return static_cast<jint>(report.textGlare * 100);
+        
+    } catch (...) {
+        return 100;
+    }
+}
+
 /**
  * Validate TCKN with native implementation
  * @return true if valid
@@ -258,11 +576,8 @@ Java_com_idverify_sdk_core_NativeProcessor_validateTCKNNative(
         jobject /* this */,
         jstring tckn) {
     
-    const char *t = env->GetStringUTFChars(tckn, 0);
-    bool result = idverify::MRZValidator::validateTCKN(t);
-    env->ReleaseStringUTFChars(tckn, t);
-    
-    return result;
+    MRZTextBuffer buffer;
+    return idverify::MRZParser::validTCKN(copyMRZText(env, tckn, buffer)) ? JNI_TRUE : JNI_FALSE;
 }
 
 /**
@@ -274,6 +589,8 @@ Java_com_idverify_sdk_core_NativeProcessor_getCardConfidence(
         JNIEnv* env,
         jobject /* this */,
         jobject bitmap) {
+    idverify::Trace::beginFrame();
+    idverify::TraceSpan span("jni.getCardConfidence");
     
     try {
         AndroidBitmapInfo info;
@@ -323,6 +640,7 @@ Java_com_idverify_sdk_core_NativeProcessor_extractROI(
         jobject bitmap,
         jint roiType,
         jboolean isBackSide) {
+    idverify::TraceSpan span("jni.extractROI");
     
     try {
         cv::Mat src = bitmapToMat(env, bitmap);
@@ -368,6 +686,7 @@ Java_com_idverify_sdk_core_NativeProcessor_calculateBlurScore(
         JNIEnv* env,
         jobject /* this */,
         jobject bitmap) {
+    idverify::TraceSpan span("jni.calculateBlurScore");
     
     try {
         cv::Mat src = bitmapToMat(env, bitmap);
@@ -380,6 +699,40 @@ Java_com_idverify_sdk_core_NativeProcessor_calculateBlurScore(
     }
 }
 
+/**
+ * Blur, glare, exposure and contrast from one pass over the frame's luma
+ * @param bitmap Input image
+ * @param outMetrics float[7]: blurScore(0-100), glareRatio, meanLuma(0-255),
+ *                   underexposedRatio, contrast, localContrast, laplacianVariance
+ * @return true if metrics written
+ */
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_analyzeFrameQuality(
+        JNIEnv* env,
+        jobject /* this */,
+        jobject bitmap,
+        jfloatArray outMetrics) {
+    idverify::TraceSpan span("jni.analyzeFrameQuality");
+    
+    try {
+        if (outMetrics == nullptr || env->GetArrayLength(outMetrics) < 7) return JNI_FALSE;
+        if (!bitmapToGray(env, bitmap, tInputGray)) return JNI_FALSE;
+        
+        idverify::FrameQuality q = idverify::QualityKernel::analyze(tInputGray);
+        if (!q.valid) return JNI_FALSE;
+        
+        const jfloat metrics[7] = {
+            q.blurScore, q.glareRatio, q.meanLuma, q.underexposedRatio,
+            q.contrast, q.localContrast, q.laplacianVariance
+        };
+        env->SetFloatArrayRegion(outMetrics, 0, 7, metrics);
+        return JNI_TRUE;
+        
+    } catch (...) {
+        return JNI_FALSE;
+    }
+}
+
 /**
  * Calculate frame stability (difference from previous frame)
  * @param current Current frame bitmap
@@ -392,6 +745,7 @@ Java_com_idverify_sdk_core_NativeProcessor_calculateStability(
         jobject /* this */,
         jobject currentBitmap,
         jobject previousBitmap) {
+    idverify::TraceSpan span("jni.calculateStability");
     
     try {
         cv::Mat current = bitmapToMat(env, currentBitmap);
@@ -416,6 +770,7 @@ Java_com_idverify_sdk_core_NativeProcessor_warpToID1(
         JNIEnv* env,
         jobject /* this */,
         jobject bitmap) {
+    idverify::TraceSpan span("jni.warpToID1");
     
     try {
         cv::Mat src = bitmapToMat(env, bitmap);
@@ -442,3 +797,1300 @@ Java_com_idverify_sdk_core_NativeProcessor_warpToID1(
         return nullptr;
     }
 }
+
+// ==================== Preallocated Output Functions ====================
+// Write results into caller-owned Bitmaps / direct ByteBuffers that are reused
+// across frames, so the preview loop does not allocate a Bitmap per result.
+
+/**
+ * Process image for OCR and write binarized result into an existing Bitmap
+ * @param bitmap Raw camera frame (RGBA_8888)
+ * @param outBitmap Reused 856x540 (or 540x856) RGBA_8888 or ALPHA_8 Bitmap
+ * @return true if card detected and output written
+ */
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_processImageForOCRInto(
+        JNIEnv* env,
+        jobject /* this */,
+        jobject bitmap,
+        jobject outBitmap) {
+    idverify::Trace::beginFrame();
+    idverify::TraceSpan span("jni.processImageForOCRInto");
+    
+    try {
+        if (!bitmapToBGR(env, bitmap, tInputBGR)) {
+            return JNI_FALSE;
+        }
+        
+        idverify::ProcessedFrame result = idverify::VisionProcessor::processForOCR(tInputBGR);
+        
+        if (!result.cardDetected || result.binarized.empty()) {
+            return JNI_FALSE;
+        }
+        
+        return writeMatToBitmap(env, result.binarized, outBitmap) ? JNI_TRUE : JNI_FALSE;
+        
+    } catch (std::exception& e) {
+        LOGE("processImageForOCRInto error: %s", e.what());
+        return JNI_FALSE;
+    } catch (...) {
+        LOGE("processImageForOCRInto: Unknown error");
+        return JNI_FALSE;
+    }
+}
+
+/**
+ * Extract ROI from warped card into an existing Bitmap
+ * Binarized ROIs can be written to ALPHA_8 Bitmaps (1 byte/pixel)
+ * @param bitmap Warped 856x540 card image
+ * @param roiType ROI type (see ROIType)
+ * @param isBackSide True if processing back side
+ * @param outBitmap Reused RGBA_8888 or ALPHA_8 Bitmap sized to the ROI
+ * @return true if ROI written
+ */
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_extractROIInto(
+        JNIEnv* env,
+        jobject /* this */,
+        jobject bitmap,
+        jint roiType,
+        jboolean isBackSide,
+        jobject outBitmap) {
+    idverify::TraceSpan span("jni.extractROIInto");
+    
+    try {
+        if (!bitmapToBGR(env, bitmap, tInputBGR)) {
+            return JNI_FALSE;
+        }
+        
+        idverify::ROIType type = static_cast<idverify::ROIType>(roiType);
+        cv::Mat roi = idverify::VisionProcessor::extractROI(tInputBGR, type, isBackSide);
+        
+        if (roi.empty()) {
+            LOGE("extractROIInto: Failed to extract");
+            return JNI_FALSE;
+        }
+        
+        return writeMatToBitmap(env, roi, outBitmap) ? JNI_TRUE : JNI_FALSE;
+        
+    } catch (std::exception& e) {
+        LOGE("extractROIInto error: %s", e.what());
+        return JNI_FALSE;
+    } catch (...) {
+        LOGE("extractROIInto: Unknown error");
+        return JNI_FALSE;
+    }
+}
+
+/**
+ * Extract ROI from warped card into a direct ByteBuffer
+ * @param bitmap Warped 856x540 card image
+ * @param roiType ROI type (see ROIType)
+ * @param isBackSide True if processing back side
+ * @param outBuffer Reused direct ByteBuffer
+ * @param format 0=GRAY8, 1=RGBA (anything else fails before the buffer is touched)
+ * @return Packed size (width << 16 | height), or -1 on failure
+ */
+extern "C" JNIEXPORT jint JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_extractROIToBuffer(
+        JNIEnv* env,
+        jobject /* this */,
+        jobject bitmap,
+        jint roiType,
+        jboolean isBackSide,
+        jobject outBuffer,
+        jint format) {
+    idverify::TraceSpan span("jni.extractROIToBuffer");
+    
+    if (!isBufferFormat(format)) {
+        LOGE("extractROIToBuffer: Unknown format %d", static_cast<int>(format));
+        return -1;
+    }
+    
+    try {
+        if (!bitmapToBGR(env, bitmap, tInputBGR)) {
+            return -1;
+        }
+        
+        idverify::ROIType type = static_cast<idverify::ROIType>(roiType);
+        cv::Mat roi = idverify::VisionProcessor::extractROI(tInputBGR, type, isBackSide);
+        
+        if (roi.empty()) {
+            LOGE("extractROIToBuffer: Failed to extract");
+            return -1;
+        }
+        
+        if (writeMatToBuffer(env, roi, outBuffer, static_cast<BufferFormat>(format)) < 0) {
+            return -1;
+        }
+        
+        return (roi.cols << 16) | roi.rows;
+        
+    } catch (std::exception& e) {
+        LOGE("extractROIToBuffer error: %s", e.what());
+        return -1;
+    } catch (...) {
+        LOGE("extractROIToBuffer: Unknown error");
+        return -1;
+    }
+}
+
+/**
+ * Extract binarized MRZ region into a direct ByteBuffer as GRAY8
+ * @param bitmap Raw camera frame (RGBA_8888)
+ * @param outBuffer Reused direct ByteBuffer (>= 856 * 152 bytes)
+ * @return Packed size (width << 16 | height), or -1 on failure
+ */
+extern "C" JNIEXPORT jint JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_extractMRZRegionToBuffer(
+        JNIEnv* env,
+        jobject /* this */,
+        jobject bitmap,
+        jobject outBuffer) {
+    idverify::TraceSpan span("jni.extractMRZRegionToBuffer");
+    
+    try {
+        if (!bitmapToBGR(env, bitmap, tInputBGR)) {
+            return -1;
+        }
+        
+        idverify::ProcessedFrame result = idverify::VisionProcessor::processForOCR(tInputBGR);
+        
+        if (!result.cardDetected || result.mrzRegion.empty()) {
+            return -1;
+        }
+        
+        if (writeMatToBuffer(env, result.mrzRegion, outBuffer, BufferFormat::GRAY8) < 0) {
+            return -1;
+        }
+        
+        return (result.mrzRegion.cols << 16) | result.mrzRegion.rows;
+        
+    } catch (std::exception& e) {
+        LOGE("extractMRZRegionToBuffer error: %s", e.what());
+        return -1;
+    } catch (...) {
+        LOGE("extractMRZRegionToBuffer: Unknown error");
+        return -1;
+    }
+}
+
+// ==================== Device Profile ====================
+
+// Calibrated pipeline profile applied to new sessions
+// Calibration sweeps the process-wide OpenCV thread pool, so it never overlaps a
+// live session: both counters below are only touched under gProfileMutex
+static std::mutex gProfileMutex;
+static idverify::DeviceProfile gDeviceProfile = {};
+static int gLiveSessions = 0;
+static bool gCalibrating = false;
+
+static std::string jstringToString(JNIEnv* env, jstring str) {
+    if (str == nullptr) return std::string();
+    const char* chars = env->GetStringUTFChars(str, nullptr);
+    std::string result(chars != nullptr ? chars : "");
+    if (chars != nullptr) env->ReleaseStringUTFChars(str, chars);
+    return result;
+}
+
+/**
+ * Load a persisted device profile (call once at SDK startup)
+ * Sessions created afterwards start from the profiled settings
+ * @param profilePath Profile file in app-private storage
+ * @return false if missing or stale (run calibrateDevice)
+ */
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_loadDeviceProfile(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring profilePath) {
+    
+    idverify::DeviceProfile profile = idverify::DeviceCalibrator::load(jstringToString(env, profilePath));
+    if (!profile.valid) return JNI_FALSE;
+    
+    idverify::DeviceCalibrator::apply(profile);
+    std::lock_guard<std::mutex> lock(gProfileMutex);
+    gDeviceProfile = profile;
+    return JNI_TRUE;
+}
+
+/**
+ * Run the first-run calibration benchmark and persist the profile
+ * Call from a background thread; takes several seconds (~4 s on one desktop
+ * x86 core, 10-20 s on low-end ARM devices)
+ * Must not overlap a scan session: the thread sweep changes cv::setNumThreads
+ * for the whole process. Refused while any session is alive, and
+ * createSession fails until calibration returns
+ * @param profilePath Profile file in app-private storage
+ * @param budgetMs Per-frame latency budget
+ * @param outProfile float[5] (optional): detectionPyramidLevel, denoise tier,
+ *                   warpInterpolation, threads, estimatedFrameMs
+ * @return true if a profile was produced and saved (false if sessions are live)
+ */
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_calibrateDevice(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring profilePath,
+        jfloat budgetMs,
+        jfloatArray outProfile) {
+    idverify::TraceSpan span("jni.calibrateDevice");
+    
+    {
+        std::lock_guard<std::mutex> lock(gProfileMutex);
+        if (gCalibrating || gLiveSessions > 0) {
+            LOGE("calibrateDevice: Refused, %d live session(s)%s", gLiveSessions,
+                 gCalibrating ? ", already calibrating" : "");
+            return JNI_FALSE;
+        }
+        gCalibrating = true;
+    }
+    // Reopen session creation however calibration ends
+    struct CalibrationGuard {
+        ~CalibrationGuard() {
+            std::lock_guard<std::mutex> lock(gProfileMutex);
+            gCalibrating = false;
+        }
+    } guard;
+    
+    try {
+        idverify::DeviceProfile profile = idverify::DeviceCalibrator::calibrate(budgetMs);
+        if (!profile.valid) return JNI_FALSE;
+        
+        if (outProfile != nullptr && env->GetArrayLength(outProfile) >= 5) {
+            jfloat values[5] = {
+                static_cast<jfloat>(profile.settings.detectionPyramidLevel),
+                static_cast<jfloat>(static_cast<int>(profile.settings.denoise)),
+                static_cast<jfloat>(profile.settings.warpInterpolation),
+                static_cast<jfloat>(profile.threads),
+                profile.estimatedFrameMs
+            };
+            env->SetFloatArrayRegion(outProfile, 0, 5, values);
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(gProfileMutex);
+            gDeviceProfile = profile;
+        }
+        return idverify::DeviceCalibrator::save(profile, jstringToString(env, profilePath))
+               ? JNI_TRUE : JNI_FALSE;
+        
+    } catch (std::exception& e) {
+        LOGE("calibrateDevice error: %s", e.what());
+        return JNI_FALSE;
+    } catch (...) {
+        LOGE("calibrateDevice: Unknown error");
+        return JNI_FALSE;
+    }
+}
+
+// ==================== Scan Session Functions ====================
+// A session owns native per-scan state; Kotlin holds it as an opaque jlong handle.
+
+static idverify::ScanSession* toSession(jlong handle) {
+    return reinterpret_cast<idverify::ScanSession*>(handle);
+}
+
+/**
+ * Create native scan session
+ * @param mrzFusionFrames MRZ crops kept for fusion (N)
+ * @param mrzUpsample True to fuse MRZ on a 2x grid
+ * @return Session handle (0 on failure or while calibrateDevice runs)
+ */
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_createSession(
+        JNIEnv* env,
+        jobject /* this */,
+        jint mrzFusionFrames,
+        jboolean mrzUpsample) {
+    
+    try {
+        idverify::SessionConfig config;
+        config.mrzFusionFrames = mrzFusionFrames;
+        config.mrzUpsample = mrzUpsample;
+        std::lock_guard<std::mutex> lock(gProfileMutex);
+        if (gCalibrating) {
+            LOGE("createSession: Device calibration in progress");
+            return 0;
+        }
+        if (gDeviceProfile.valid) {
+            config.pipeline = gDeviceProfile.settings;
+            config.governor.budgetMs = gDeviceProfile.budgetMs;
+        }
+        jlong handle = reinterpret_cast<jlong>(new idverify::ScanSession(config));
+        ++gLiveSessions;
+        return handle;
+    } catch (...) {
+        LOGE("createSession: Failed");
+        return 0;
+    }
+}
+
+/**
+ * Release native scan session
+ * @param handle Session handle from createSession
+ */
+extern "C" JNIEXPORT void JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_releaseSession(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle) {
+    if (handle == 0) return;
+    delete toSession(handle);
+    std::lock_guard<std::mutex> lock(gProfileMutex);
+    --gLiveSessions;
+}
+
+/**
+ * Reset session history (card flipped, screen restarted)
+ */
+extern "C" JNIEXPORT void JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_resetSession(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle) {
+    idverify::ScanSession* session = toSession(handle);
+    if (session != nullptr) session->reset();
+}
+
+/**
+ * Add a warped card to the session (best-frame ring, MRZ fusion for back side)
+ * @param handle Session handle
+ * @param bitmap Warped 856x540 card image
+ * @param isBackSide True for back-side frames
+ * @param sourceScale Source pixels per warped pixel (card width in frame / 856)
+ * @return Session frame id (0 on failure)
+ */
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_sessionAddFrame(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle,
+        jobject bitmap,
+        jboolean isBackSide,
+        jfloat sourceScale) {
+    idverify::TraceSpan span("jni.sessionAddFrame");
+    
+    idverify::ScanSession* session = toSession(handle);
+    if (session == nullptr) return 0;
+    
+    try {
+        if (!bitmapToBGR(env, bitmap, tInputBGR)) return 0;
+        return static_cast<jlong>(session->addFrame(tInputBGR, isBackSide, sourceScale));
+    } catch (std::exception& e) {
+        LOGE("sessionAddFrame error: %s", e.what());
+        return 0;
+    } catch (...) {
+        LOGE("sessionAddFrame: Unknown error");
+        return 0;
+    }
+}
+
+/**
+ * Write the best buffered crop of a field into a reused Bitmap
+ * @param handle Session handle
+ * @param roiType ROI type (see ROIType)
+ * @param preprocess True to apply the ROI's OCR preprocessing (binarization)
+ * @param outBitmap RGBA_8888 or ALPHA_8 Bitmap sized to the ROI
+ * @return Quality score 0-100 of the chosen crop, or -1 if none
+ */
+extern "C" JNIEXPORT jint JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_sessionBestROIInto(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle,
+        jint roiType,
+        jboolean preprocess,
+        jobject outBitmap) {
+    idverify::TraceSpan span("jni.sessionBestROIInto");
+    
+    idverify::ScanSession* session = toSession(handle);
+    if (session == nullptr) return -1;
+    
+    try {
+        idverify::ROIType type = static_cast<idverify::ROIType>(roiType);
+        idverify::BestROI best = session->bestROI(type);
+        if (!best.found) return -1;
+        
+        cv::Mat out = preprocess
+                      ? idverify::VisionProcessor::preprocessROI(best.crop, type, idverify::isBackSideROI(type))
+                      : best.crop;
+        
+        if (!writeMatToBitmap(env, out, outBitmap)) return -1;
+        
+        return static_cast<jint>(best.quality.score * 100);
+        
+    } catch (std::exception& e) {
+        LOGE("sessionBestROIInto error: %s", e.what());
+        return -1;
+    } catch (...) {
+        LOGE("sessionBestROIInto: Unknown error");
+        return -1;
+    }
+}
+
+/**
+ * Estimate camera motion against the previous frame kept in the session
+ * Replaces the two-Bitmap calculateStability call
+ * @param handle Session handle
+ * @param bitmap Current camera frame (RGBA_8888)
+ * @param outMotion Optional float[4]: dx, dy (px/frame), rotation (deg/frame), stability 0-1
+ * @return Motion in full-frame pixels per frame, or -1 on the first frame / failure
+ */
+extern "C" JNIEXPORT jfloat JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_sessionUpdateStability(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle,
+        jobject bitmap,
+        jfloatArray outMotion) {
+    idverify::TraceSpan span("jni.sessionUpdateStability");
+    
+    idverify::ScanSession* session = toSession(handle);
+    if (session == nullptr) return -1.0f;
+    
+    try {
+        idverify::StabilityResult motion;
+        {
+            LockedBitmap locked(env, bitmap);
+            if (locked.rgba.empty()) return -1.0f;
+            motion = session->updateStability(locked.rgba);
+        }
+        
+        if (!motion.valid) return -1.0f;
+        
+        if (outMotion != nullptr && env->GetArrayLength(outMotion) >= 4) {
+            const jfloat values[4] = { motion.dx, motion.dy, motion.rotationDeg, motion.stability };
+            env->SetFloatArrayRegion(outMotion, 0, 4, values);
+        }
+        
+        return motion.motionPx;
+        
+    } catch (std::exception& e) {
+        LOGE("sessionUpdateStability error: %s", e.what());
+        return -1.0f;
+    } catch (...) {
+        LOGE("sessionUpdateStability: Unknown error");
+        return -1.0f;
+    }
+}
+
+/**
+ * Run a camera frame through the session's quality cascade
+ * Passing frames are added to the best-frame ring automatically
+ * @param handle Session handle
+ * @param bitmap Raw camera frame (RGBA_8888)
+ * @param isBackSide True when scanning the back side
+ * @return 5 if all stages passed, otherwise the index of the rejecting stage
+ *         (0=presence, 1=quality, 2=detection, 3=warp, 4=ROI);
+ *         6 if the latency governor skipped the frame;
+ *         7 if cancelled or past the frame deadline; -1 on error
+ */
+extern "C" JNIEXPORT jint JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_sessionProcessFrame(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle,
+        jobject bitmap,
+        jboolean isBackSide) {
+    idverify::Trace::beginFrame();
+    idverify::TraceSpan span("jni.sessionProcessFrame");
+    
+    idverify::ScanSession* session = toSession(handle);
+    if (session == nullptr) return -1;
+    
+    try {
+        if (!bitmapToBGR(env, bitmap, tInputBGR)) return -1;
+        
+        bool skipped = false;
+        idverify::CascadeResult result = session->processFrame(tInputBGR, isBackSide, &skipped);
+        return idverify::FrameDecision::resultCode(result, skipped);
+        
+    } catch (std::exception& e) {
+        LOGE("sessionProcessFrame error: %s", e.what());
+        return -1;
+    } catch (...) {
+        LOGE("sessionProcessFrame: Unknown error");
+        return -1;
+    }
+}
+
+/**
+ * Start recording session frames and cascade decisions (debug builds / opt-in only)
+ * The file holds raw card images: keep it in app-private storage and delete it
+ * after the problem session has been pulled
+ * @param handle Session handle
+ * @param path Output .idvr file (truncated)
+ * @param format 1=Y8 (luma), 2=RGBA8, 3=BGR8
+ * @param maxFrames Frames kept before recording stops (<= 0 = 300)
+ * @return false if the file cannot be created
+ */
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_sessionStartRecording(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle,
+        jstring path,
+        jint format,
+        jint maxFrames) {
+    
+    idverify::ScanSession* session = toSession(handle);
+    std::string file = jstringToString(env, path);
+    if (session == nullptr || file.empty()) return JNI_FALSE;
+    
+    bool ok = session->startRecording(file, static_cast<idverify::RecordFormat>(format),
+                                      maxFrames > 0 ? maxFrames : 300);
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Finish the session recording
+ * @param handle Session handle
+ * @return Frames written (-1 if not recording or the file could not be finalized)
+ */
+extern "C" JNIEXPORT jint JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_sessionStopRecording(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle) {
+    
+    idverify::ScanSession* session = toSession(handle);
+    if (session == nullptr) return -1;
+    return session->stopRecording();
+}
+
+/**
+ * Configure cascade stage order and thresholds
+ * @param handle Session handle
+ * @param order Stage indices in evaluation order (null keeps the default)
+ * @param thresholds float[10]: minMeanLuma, maxMeanLuma, maxFrameGlare, minLocalContrast,
+ *                   minBlurScore, maxMotionPx, minCardConfidence, maxTextGlare, minROIScore,
+ *                   (reserved)
+ * @return false if the order was invalid (default order used)
+ */
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_sessionConfigureCascade(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle,
+        jintArray order,
+        jfloatArray thresholds) {
+    
+    idverify::ScanSession* session = toSession(handle);
+    if (session == nullptr) return JNI_FALSE;
+    
+    idverify::CascadeConfig config;
+    
+    if (order != nullptr) {
+        jsize n = env->GetArrayLength(order);
+        std::vector<jint> stages(n);
+        env->GetIntArrayRegion(order, 0, n, stages.data());
+        config.order.clear();
+        for (jint s : stages) config.order.push_back(static_cast<idverify::CascadeStage>(s));
+    }
+    
+    if (thresholds != nullptr && env->GetArrayLength(thresholds) >= 9) {
+        jfloat t[9];
+        env->GetFloatArrayRegion(thresholds, 0, 9, t);
+        config.minMeanLuma = t[0];
+        config.maxMeanLuma = t[1];
+        config.maxFrameGlare = t[2];
+        config.minLocalContrast = t[3];
+        config.minBlurScore = t[4];
+        config.maxMotionPx = t[5];
+        config.minCardConfidence = t[6];
+        config.maxTextGlare = t[7];
+        config.minROIScore = t[8];
+    }
+    
+    return session->configureCascade(config) ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Read cascade counters
+ * @param handle Session handle
+ * @param outCounts long[12]: frames, passed, evaluated[0..4], rejected[0..4]
+ *                  (long[13] also returns frames stopped by cancel/deadline)
+ * @param outTimings float[6]: mean ms per evaluation for stages 0..4, mean ms per rejected frame
+ */
+extern "C" JNIEXPORT void JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_sessionGetCascadeStats(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle,
+        jlongArray outCounts,
+        jfloatArray outTimings) {
+    
+    idverify::ScanSession* session = toSession(handle);
+    if (session == nullptr) return;
+    
+    const idverify::CascadeStats& stats = session->cascadeStats();
+    const int n = idverify::CASCADE_STAGE_COUNT;
+    
+    if (outCounts != nullptr && env->GetArrayLength(outCounts) >= 2 + 2 * n) {
+        jlong counts[2 + 2 * n];
+        counts[0] = static_cast<jlong>(stats.frames);
+        counts[1] = static_cast<jlong>(stats.passed);
+        for (int i = 0; i < n; ++i) {
+            counts[2 + i] = static_cast<jlong>(stats.evaluated[i]);
+            counts[2 + n + i] = static_cast<jlong>(stats.rejected[i]);
+        }
+        env->SetLongArrayRegion(outCounts, 0, 2 + 2 * n, counts);
+        
+        if (env->GetArrayLength(outCounts) >= 3 + 2 * n) {
+            jlong cancelled = static_cast<jlong>(stats.cancelled);
+            env->SetLongArrayRegion(outCounts, 2 + 2 * n, 1, &cancelled);
+        }
+    }
+    
+    if (outTimings != nullptr && env->GetArrayLength(outTimings) >= n + 1) {
+        jfloat timings[n + 1];
+        for (int i = 0; i < n; ++i) {
+            timings[i] = stats.evaluated[i] > 0
+                         ? static_cast<jfloat>(stats.stageMs[i] / stats.evaluated[i]) : 0.0f;
+        }
+        timings[n] = static_cast<jfloat>(stats.averageRejectMs());
+        env->SetFloatArrayRegion(outTimings, 0, n + 1, timings);
+    }
+}
+
+/**
+ * Auto-capture step: quality cascade + capture state machine in one call
+ * Kotlin only needs to act when the "changed" bit is set
+ * @param handle Session handle
+ * @param bitmap Raw camera frame (RGBA_8888)
+ * @param isBackSide True when scanning the back side
+ * @param timestampNs Camera timestamp of the frame (ImageProxy.imageInfo.timestamp)
+ * @return state | hint << 4 | changed << 8, -1 on error
+ *         state: 0=searching, 1=aligning, 2=hold still, 3=captured
+ *         hint: 0=none, 1=find card, 2=move closer, 3=reduce glare, 4=hold steady, 5=focus
+ */
+extern "C" JNIEXPORT jint JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_sessionCaptureStep(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle,
+        jobject bitmap,
+        jboolean isBackSide,
+        jlong timestampNs) {
+    idverify::Trace::beginFrame();
+    idverify::TraceSpan span("jni.sessionCaptureStep");
+    
+    idverify::ScanSession* session = toSession(handle);
+    if (session == nullptr) return -1;
+    
+    try {
+        if (session->captureState() == idverify::CaptureState::CAPTURED) {
+            return static_cast<jint>(idverify::CaptureState::CAPTURED);
+        }
+        if (!bitmapToBGR(env, bitmap, tInputBGR)) return -1;
+        
+        idverify::CaptureEvent event = session->captureStep(tInputBGR, isBackSide,
+                                                                 static_cast<double>(timestampNs) / 1e6);
+        return static_cast<jint>(event.state) |
+               (static_cast<jint>(event.hint) << 4) |
+               (event.changed ? (1 << 8) : 0);
+        
+    } catch (std::exception& e) {
+        LOGE("sessionCaptureStep error: %s", e.what());
+        return -1;
+    } catch (...) {
+        LOGE("sessionCaptureStep: Unknown error");
+        return -1;
+    }
+}
+
+/**
+ * Write the captured card into a reused Bitmap
+ * @param handle Session handle
+ * @param outBitmap RGBA_8888 or ALPHA_8 Bitmap, 856x540
+ * @return Worst text-ROI score 0-100 of the captured frame, or -1 before capture
+ */
+extern "C" JNIEXPORT jint JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_sessionCapturedFrameInto(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle,
+        jobject outBitmap) {
+    
+    idverify::ScanSession* session = toSession(handle);
+    if (session == nullptr) return -1;
+    
+    try {
+        const idverify::BestFrame& captured = session->capturedFrame();
+        if (!captured.found) return -1;
+        if (!writeMatToBitmap(env, captured.card, outBitmap)) return -1;
+        return static_cast<jint>(captured.score * 100);
+        
+    } catch (std::exception& e) {
+        LOGE("sessionCapturedFrameInto error: %s", e.what());
+        return -1;
+    } catch (...) {
+        LOGE("sessionCapturedFrameInto: Unknown error");
+        return -1;
+    }
+}
+
+/**
+ * Configure auto-capture thresholds
+ * @param handle Session handle
+ * @param params float[9]: enterConfidence, exitConfidence, enterROIScore, exitROIScore,
+ *               enterMotionPx, exitMotionPx, lostFrames, dwellMs, minDwellFrames
+ */
+extern "C" JNIEXPORT void JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_sessionConfigureCapture(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle,
+        jfloatArray params) {
+    
+    idverify::ScanSession* session = toSession(handle);
+    if (session == nullptr || params == nullptr || env->GetArrayLength(params) < 9) return;
+    
+    jfloat p[9];
+    env->GetFloatArrayRegion(params, 0, 9, p);
+    
+    idverify::CaptureConfig config;
+    config.enterConfidence = p[0];
+    config.exitConfidence = p[1];
+    config.enterROIScore = p[2];
+    config.exitROIScore = p[3];
+    config.enterMotionPx = p[4];
+    config.exitMotionPx = p[5];
+    config.lostFrames = static_cast<int>(p[6]);
+    config.dwellMs = p[7];
+    config.minDwellFrames = static_cast<int>(p[8]);
+    session->configureCapture(config);
+}
+
+/**
+ * Stop the frame a session is processing and all later ones (callable from any thread)
+ * Use when the scanning screen is left; frames stay cancelled until
+ * sessionResume or resetSession, so a cancel between frames is not lost
+ * @param handle Session handle
+ */
+extern "C" JNIEXPORT void JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_sessionCancel(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle) {
+    idverify::ScanSession* session = toSession(handle);
+    if (session != nullptr) session->cancel();
+}
+
+/**
+ * Process frames again after sessionCancel (session history is kept)
+ * @param handle Session handle
+ */
+extern "C" JNIEXPORT void JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_sessionResume(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle) {
+    idverify::ScanSession* session = toSession(handle);
+    if (session != nullptr) session->resume();
+}
+
+/**
+ * Set the per-frame deadline of a session
+ * Frames still running after the deadline stop at the next check
+ * @param handle Session handle
+ * @param deadlineMs Deadline in milliseconds (0 = none)
+ */
+extern "C" JNIEXPORT void JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_sessionSetFrameDeadline(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle,
+        jfloat deadlineMs) {
+    idverify::ScanSession* session = toSession(handle);
+    if (session != nullptr) session->setFrameDeadline(deadlineMs);
+}
+
+/**
+ * Read the latency governor state of a session
+ * @param handle Session handle
+ * @param outState float[16+]: level, smoothedMs, p50, p95, p99,
+ *                 per-stage ms (5), detectionPyramidLevel, denoise tier,
+ *                 warpInterpolation, useTracking, frameSkip, skipped frames
+ * @return Current degradation level (-1 on failure)
+ */
+extern "C" JNIEXPORT jint JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_sessionGetGovernorState(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle,
+        jfloatArray outState) {
+    
+    idverify::ScanSession* session = toSession(handle);
+    if (session == nullptr) return -1;
+    
+    idverify::GovernorState state = session->governor().state();
+    const int n = idverify::CASCADE_STAGE_COUNT;
+    const int size = 5 + n + 6;
+    
+    if (outState != nullptr && env->GetArrayLength(outState) >= size) {
+        jfloat values[size];
+        values[0] = static_cast<jfloat>(state.level);
+        values[1] = state.smoothedMs;
+        values[2] = state.p50Ms;
+        values[3] = state.p95Ms;
+        values[4] = state.p99Ms;
+        for (int i = 0; i < n; ++i) {
+            values[5 + i] = state.stageMs[i];
+        }
+        values[5 + n] = static_cast<jfloat>(state.settings.detectionPyramidLevel);
+        values[6 + n] = static_cast<jfloat>(static_cast<int>(state.settings.denoise));
+        values[7 + n] = static_cast<jfloat>(state.settings.warpInterpolation);
+        values[8 + n] = state.settings.useTracking ? 1.0f : 0.0f;
+        values[9 + n] = static_cast<jfloat>(state.settings.frameSkip);
+        values[10 + n] = static_cast<jfloat>(state.skipped);
+        env->SetFloatArrayRegion(outState, 0, size, values);
+    }
+    
+    return state.level;
+}
+
+/**
+ * Set the per-frame latency budget of a session
+ * @param handle Session handle
+ * @param budgetMs Target frame latency in milliseconds
+ */
+extern "C" JNIEXPORT void JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_sessionSetLatencyBudget(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle,
+        jfloat budgetMs) {
+    
+    idverify::ScanSession* session = toSession(handle);
+    if (session == nullptr || budgetMs <= 0.0f) return;
+    session->governor().setBudgetMs(budgetMs);
+}
+
+/**
+ * Read frame-hash memo counters of a session
+ * @param handle Session handle
+ * @param outCounts long[4]: cascade lookups, cascade hits, OCR lookups, OCR hits
+ */
+extern "C" JNIEXPORT void JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_sessionGetMemoStats(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle,
+        jlongArray outCounts) {
+    
+    idverify::ScanSession* session = toSession(handle);
+    if (session == nullptr || outCounts == nullptr || env->GetArrayLength(outCounts) < 4) return;
+    
+    jlong counts[4] = {
+        static_cast<jlong>(session->cascadeMemoStats().lookups),
+        static_cast<jlong>(session->cascadeMemoStats().hits),
+        static_cast<jlong>(session->ocrMemoStats().lookups),
+        static_cast<jlong>(session->ocrMemoStats().hits)
+    };
+    env->SetLongArrayRegion(outCounts, 0, 4, counts);
+}
+
+/**
+ * Fuse buffered MRZ crops and write binarized result into a reused Bitmap
+ * @param handle Session handle
+ * @param outBitmap RGBA_8888 or ALPHA_8 Bitmap sized to the fused MRZ
+ *                  (856x151, or 1712x302 when upsampled)
+ * @return Number of frames fused (0 on failure)
+ */
+extern "C" JNIEXPORT jint JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_sessionFuseMRZInto(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle,
+        jobject outBitmap) {
+    idverify::TraceSpan span("jni.sessionFuseMRZInto");
+    
+    idverify::ScanSession* session = toSession(handle);
+    if (session == nullptr) return 0;
+    
+    try {
+        idverify::FusionResult fused = session->fuseMRZ();
+        if (!fused.valid || !writeMatToBitmap(env, fused.binarized, outBitmap)) {
+            return 0;
+        }
+        
+        LOGD("sessionFuseMRZInto: %d frames, response=%.3f", fused.framesUsed, fused.meanResponse);
+        return fused.framesUsed;
+        
+    } catch (std::exception& e) {
+        LOGE("sessionFuseMRZInto error: %s", e.what());
+        return 0;
+    } catch (...) {
+        LOGE("sessionFuseMRZInto: Unknown error");
+        return 0;
+    }
+}
+
+// ==================== MRZ Reader ====================
+// One reader shared by all sessions; loadMRZTemplates swaps it atomically.
+// There is none until templates are loaded: the built-in Hershey templates
+// are a host stand-in for OCR-B and are not served for real cards.
+
+static std::mutex gMRZReaderMutex;
+static std::shared_ptr<const idverify::MRZReader> gMRZReader;
+static bool gMRZReaderMissingLogged = false;    // Guarded by gMRZReaderMutex
+
+/**
+ * Shared reader, or null if loadMRZTemplates has not succeeded yet
+ * The missing reader is logged once, not on every frame that asks for it
+ */
+static std::shared_ptr<const idverify::MRZReader> mrzReader() {
+    std::lock_guard<std::mutex> lock(gMRZReaderMutex);
+    if (!gMRZReader && !gMRZReaderMissingLogged) {
+        LOGE("mrzReader: No MRZ templates loaded, native MRZ reading off until loadMRZTemplates succeeds");
+        gMRZReaderMissingLogged = true;
+    }
+    return gMRZReader;
+}
+
+/**
+ * Convert lines to a Java String[3]
+ */
+static jobjectArray linesToJava(JNIEnv* env, const std::array<std::string, idverify::MRZ_LINE_COUNT>& text) {
+    jobjectArray lines = env->NewObjectArray(idverify::MRZ_LINE_COUNT, gBitmapCache.stringClass, nullptr);
+    for (int i = 0; i < idverify::MRZ_LINE_COUNT; ++i) {
+        jstring line = env->NewStringUTF(text[i].c_str());
+        env->SetObjectArrayElement(lines, i, line);
+        env->DeleteLocalRef(line);
+    }
+    return lines;
+}
+
+/**
+ * Convert a read to String[3] and fill per-character confidences
+ * Lines are the checksum-consistent decoding when one exists (MRZDecoder), the raw read otherwise
+ * @return String[3], or null if no MRZ was found
+ */
+static jobjectArray mrzResultToJava(JNIEnv* env, const idverify::MRZReadResult& result,
+                                    jfloatArray outConfidence) {
+    if (!result.found) return nullptr;
+    
+    if (outConfidence != nullptr &&
+        env->GetArrayLength(outConfidence) >= idverify::MRZ_LINE_COUNT * idverify::MRZ_LINE_LENGTH) {
+        jfloat conf[idverify::MRZ_LINE_COUNT * idverify::MRZ_LINE_LENGTH];
+        for (int i = 0; i < idverify::MRZ_LINE_COUNT; ++i) {
+            for (int k = 0; k < idverify::MRZ_LINE_LENGTH; ++k) {
+                conf[i * idverify::MRZ_LINE_LENGTH + k] = result.chars[i][k].confidence;
+            }
+        }
+        env->SetFloatArrayRegion(outConfidence, 0, idverify::MRZ_LINE_COUNT * idverify::MRZ_LINE_LENGTH, conf);
+    }
+    
+    idverify::MRZDecodeResult decoded = idverify::MRZDecoder::decode(result);
+    return linesToJava(env, decoded.valid ? decoded.lines : result.lines);
+}
+
+/**
+ * Load learned OCR-B MRZ templates (file written by MRZReader::saveTemplates, e.g. idverify-bench train-mrz)
+ * Native MRZ reading (readMRZ, sessionReadFusedMRZ, sessionVoteNativeMRZ) stays off until this succeeds
+ * @param path Template file (e.g. copied from assets)
+ * @return false if the file is missing or incompatible (current templates kept)
+ */
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_loadMRZTemplates(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring path) {
+    
+    auto reader = std::make_shared<idverify::MRZReader>();
+    if (!reader->loadTemplates(jstringToString(env, path))) {
+        return JNI_FALSE;
+    }
+    std::lock_guard<std::mutex> lock(gMRZReaderMutex);
+    gMRZReader = reader;
+    return JNI_TRUE;
+}
+
+/**
+ * True once loadMRZTemplates has succeeded (native MRZ reading available)
+ */
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_isMRZReaderReady(
+        JNIEnv* env,
+        jobject /* this */) {
+    std::lock_guard<std::mutex> lock(gMRZReaderMutex);
+    return gMRZReader ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Decode recognized MRZ text to the cheapest reading that passes all four check digits
+ * Letters in dates and digits in names are repaired; look-alikes (O/0, S/5, ...) are swapped only as needed
+ * @param outEdits Optional int[1]: characters changed from the input
+ * @return String[3] decoded lines, or null if no checksum-consistent reading exists
+ */
+extern "C" JNIEXPORT jobjectArray JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_decodeMRZ(
+        JNIEnv* env,
+        jobject /* this */,
+        jstring line1,
+        jstring line2,
+        jstring line3,
+        jintArray outEdits) {
+    idverify::TraceSpan span("jni.decodeMRZ");
+    
+    idverify::MRZDecodeResult decoded = idverify::MRZDecoder::decode(
+            jstringToString(env, line1), jstringToString(env, line2), jstringToString(env, line3));
+    if (!decoded.valid) return nullptr;
+    
+    if (outEdits != nullptr && env->GetArrayLength(outEdits) >= 1) {
+        jint edits = decoded.edits;
+        env->SetIntArrayRegion(outEdits, 0, 1, &edits);
+    }
+    return linesToJava(env, decoded.lines);
+}
+
+/**
+ * Read the MRZ of a warped back side natively (no text recognizer round-trip)
+ * @param bitmap Warped 856x540 card (RGBA_8888)
+ * @param outConfidence Optional float[90]: per-character confidence 0-1, line by line
+ * @return String[3] TD1 lines, or null if no 3-line MRZ was found or no templates are loaded
+ */
+extern "C" JNIEXPORT jobjectArray JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_readMRZ(
+        JNIEnv* env,
+        jobject /* this */,
+        jobject bitmap,
+        jfloatArray outConfidence) {
+    idverify::TraceSpan span("jni.readMRZ");
+    
+    auto reader = mrzReader();
+    if (!reader) return nullptr;
+    
+    try {
+        if (!bitmapToBGR(env, bitmap, tInputBGR)) return nullptr;
+        
+        idverify::MRZReadResult result = reader->read(tInputBGR);
+        return mrzResultToJava(env, result, outConfidence);
+        
+    } catch (std::exception& e) {
+        LOGE("readMRZ error: %s", e.what());
+        return nullptr;
+    } catch (...) {
+        LOGE("readMRZ: Unknown error");
+        return nullptr;
+    }
+}
+
+/**
+ * Read the session's fused MRZ (multi-frame super-resolved band)
+ * @param handle Session handle
+ * @param outConfidence Optional float[90]: per-character confidence 0-1
+ * @return String[3] TD1 lines, or null if nothing fused, no MRZ found or no templates are loaded
+ */
+extern "C" JNIEXPORT jobjectArray JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_sessionReadFusedMRZ(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle,
+        jfloatArray outConfidence) {
+    idverify::TraceSpan span("jni.sessionReadFusedMRZ");
+    
+    idverify::ScanSession* session = toSession(handle);
+    if (session == nullptr) return nullptr;
+    
+    auto reader = mrzReader();
+    if (!reader) return nullptr;
+    
+    try {
+        idverify::FusionResult fused = session->fuseMRZ();
+        if (!fused.valid) return nullptr;
+        
+        idverify::MRZReadResult result = reader->readBand(fused.fused, fused.scale);
+        return mrzResultToJava(env, result, outConfidence);
+        
+    } catch (std::exception& e) {
+        LOGE("sessionReadFusedMRZ error: %s", e.what());
+        return nullptr;
+    } catch (...) {
+        LOGE("sessionReadFusedMRZ: Unknown error");
+        return nullptr;
+    }
+}
+
+/**
+ * Fill stability and frame count of a consensus vote
+ * @return String[3] voted lines once accepted, null before
+ */
+static jobjectArray consensusToJava(JNIEnv* env, const idverify::MRZConsensusResult& vote,
+                                    jfloatArray outStability) {
+    if (outStability != nullptr && env->GetArrayLength(outStability) >= 2) {
+        jfloat state[2] = { vote.stability, static_cast<jfloat>(vote.frames) };
+        env->SetFloatArrayRegion(outStability, 0, 2, state);
+    }
+    return vote.accepted ? linesToJava(env, vote.lines) : nullptr;
+}
+
+/**
+ * Vote one frame's recognized MRZ text into the session consensus
+ * @param handle Session handle
+ * @param confidence Recognizer confidence of the read (0-1)
+ * @param outStability Optional float[2]: {stability 0-1, frames voted}
+ * @return String[3] once the voted MRZ passes all four check digits, null before
+ */
+extern "C" JNIEXPORT jobjectArray JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_sessionVoteMRZ(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle,
+        jstring line1,
+        jstring line2,
+        jstring line3,
+        jfloat confidence,
+        jfloatArray outStability) {
+    idverify::TraceSpan span("jni.sessionVoteMRZ");
+    
+    idverify::ScanSession* session = toSession(handle);
+    if (session == nullptr) return nullptr;
+    
+    const idverify::MRZConsensusResult& vote = session->voteMRZ(
+            jstringToString(env, line1), jstringToString(env, line2), jstringToString(env, line3), confidence);
+    return consensusToJava(env, vote, outStability);
+}
+
+/**
+ * Read a warped back side natively and vote it into the session consensus
+ * @param handle Session handle
+ * @param bitmap Warped 856x540 card (RGBA_8888)
+ * @param outStability Optional float[2]: {stability 0-1, frames voted}
+ * @return String[3] once the voted MRZ passes all four check digits, null before
+ *         (and always null, without voting, while no templates are loaded)
+ */
+extern "C" JNIEXPORT jobjectArray JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_sessionVoteNativeMRZ(
+        JNIEnv* env,
+        jobject /* this */,
+        jlong handle,
+        jobject bitmap,
+        jfloatArray outStability) {
+    idverify::TraceSpan span("jni.sessionVoteNativeMRZ");
+    
+    idverify::ScanSession* session = toSession(handle);
+    if (session == nullptr) return nullptr;
+    
+    auto reader = mrzReader();
+    if (!reader) return nullptr;
+    
+    try {
+        if (!bitmapToBGR(env, bitmap, tInputBGR)) return nullptr;
+        
+        const idverify::MRZConsensusResult& vote = session->voteMRZ(reader->read(tInputBGR));
+        return consensusToJava(env, vote, outStability);
+        
+    } catch (std::exception& e) {
+        LOGE("sessionVoteNativeMRZ error: %s", e.what());
+        return nullptr;
+    } catch (...) {
+        LOGE("sessionVoteNativeMRZ: Unknown error");
+        return nullptr;
+    }
+}
+
+/**
+ * Locate, level and crop the three MRZ lines of a warped back side
+ * Crops share one text height, so each line can go to OCR on its own (and in parallel)
+ * @param bitmap Warped 856x540 card (RGBA_8888)
+ * @param outSkew Optional float[1]: estimated skew in degrees
+ * @return Bitmap[3] grayscale line crops (LINE_HEIGHT rows), or null on failure.
+ *         Lines are at the nominal MRZ_LINE1..3 positions if projection found fewer than three.
+ */
+extern "C" JNIEXPORT jobjectArray JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_extractMRZLines(
+        JNIEnv* env,
+        jobject /* this */,
+        jobject bitmap,
+        jfloatArray outSkew) {
+    idverify::TraceSpan span("jni.extractMRZLines");
+    
+    try {
+        if (!bitmapToBGR(env, bitmap, tInputBGR)) return nullptr;
+        
+        idverify::MRZLineLayout layout = idverify::MRZLocator::locateInCard(tInputBGR);
+        for (const cv::Mat& line : layout.lines) {
+            if (line.empty()) return nullptr;
+        }
+        
+        if (outSkew != nullptr && env->GetArrayLength(outSkew) >= 1) {
+            jfloat skew = layout.skewDegrees;
+            env->SetFloatArrayRegion(outSkew, 0, 1, &skew);
+        }
+        
+        jobjectArray lines = env->NewObjectArray(idverify::MRZ_LINE_COUNT, gBitmapCache.bitmapClass, nullptr);
+        for (int i = 0; i < idverify::MRZ_LINE_COUNT; ++i) {
+            jobject line = matToBitmap(env, layout.lines[i]);
+            if (line == nullptr) return nullptr;
+            env->SetObjectArrayElement(lines, i, line);
+            env->DeleteLocalRef(line);
+        }
+        return lines;
+        
+    } catch (std::exception& e) {
+        LOGE("extractMRZLines error: %s", e.what());
+        return nullptr;
+    } catch (...) {
+        LOGE("extractMRZLines: Unknown error");
+        return nullptr;
+    }
+}
+
+// ==================== Metrics ====================
+
+/**
+ * Snapshot of native stage histograms and counters
+ * Layout is documented in Metrics.h (magic "IDVM", little-endian)
+ * @return Snapshot bytes, or null on failure
+ */
+extern "C" JNIEXPORT jbyteArray JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_getMetricsSnapshot(
+        JNIEnv* env,
+        jobject /* this */) {
+    
+    static thread_local std::vector<uint8_t> tSnapshot;
+    idverify::Metrics::instance().snapshot(tSnapshot);
+    
+    jbyteArray out = env->NewByteArray(static_cast<jsize>(tSnapshot.size()));
+    if (out == nullptr) return nullptr;
+    env->SetByteArrayRegion(out, 0, static_cast<jsize>(tSnapshot.size()),
+                            reinterpret_cast<const jbyte*>(tSnapshot.data()));
+    return out;
+}
+
+/**
+ * Clear all native histograms and counters
+ */
+extern "C" JNIEXPORT void JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_resetMetrics(
+        JNIEnv* env,
+        jobject /* this */) {
+    idverify::Metrics::instance().reset();
+}
+
+/**
+ * Enable or disable stage timing and counters
+ */
+extern "C" JNIEXPORT void JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_setMetricsEnabled(
+        JNIEnv* env,
+        jobject /* this */,
+        jboolean enabled) {
+    idverify::Metrics::instance().setEnabled(enabled);
+}
+
+// ==================== Tracing ====================
+
+/**
+ * Enable or disable trace spans (ATrace sections on device)
+ */
+extern "C" JNIEXPORT void JNICALL
+Java_com_idverify_sdk_core_NativeProcessor_setTracingEnabled(
+        JNIEnv* env,
+        jobject /* this */,
+        jboolean enabled) {
+    idverify::Trace::setEnabled(enabled);
+}